@@ -22,6 +22,15 @@ include(src/o2/o2.pri)
 #include(src/wagnis/wagnis.pri)
 include(src/QGumboParser/QGumboParser.pri)
 
+# Lookup table of the emoji images for EmojiMatcher, regenerated whenever the images change
+EMOJI_IMAGES = $$files($$PWD/qml/js/emoji/*.svg)
+emojitable.input = EMOJI_IMAGES
+emojitable.output = $$OUT_PWD/emojitable.h
+emojitable.commands = sh $$PWD/tools/generate-emoji-table.sh ${QMAKE_FILE_OUT} $$PWD/qml/js/emoji
+emojitable.CONFIG += combine no_link target_predeps
+QMAKE_EXTRA_COMPILERS += emojitable
+INCLUDEPATH += $$OUT_PWD
+
 SOURCES += src/harbour-piepmatz.cpp \
     src/accountmodel.cpp \
     src/twitterapi.cpp \
@@ -43,7 +52,27 @@ SOURCES += src/harbour-piepmatz.cpp \
     src/tweetconversationhandler.cpp \
     src/savedsearchesmodel.cpp \
     src/imagemetadataresponsehandler.cpp \
-    src/contentextractor.cpp
+    src/contentextractor.cpp \
+    src/opengraphresponsehandler.cpp \
+    src/opengraphcache.cpp \
+    src/linkpreviewfetcher.cpp \
+    src/tweetconversationworker.cpp \
+    src/htmlcharsetdecoder.cpp \
+    src/articlecache.cpp \
+    src/articleextractionworker.cpp \
+    src/keywordmatcher.cpp \
+    src/conversationgraph.cpp \
+    src/conversationgraphwriter.cpp \
+    src/conversationprefetcher.cpp \
+    src/tweettextrenderer.cpp \
+    src/emojimatcher.cpp \
+    src/tweetlengthcounter.cpp \
+    src/relativetime.cpp \
+    src/mutefilter.cpp \
+    src/mergedtimelinemodel.cpp \
+    src/accountsession.cpp \
+    src/mentionscache.cpp \
+    src/notificationpoller.cpp
 
 OTHER_FILES += qml/harbour-piepmatz.qml \
     qml/pages/CoverPage.qml \
@@ -125,7 +154,27 @@ HEADERS += \
     src/tweetconversationhandler.h \
     src/savedsearchesmodel.h \
     src/imagemetadataresponsehandler.h \
-    src/contentextractor.h
+    src/contentextractor.h \
+    src/opengraphresponsehandler.h \
+    src/opengraphcache.h \
+    src/linkpreviewfetcher.h \
+    src/tweetconversationworker.h \
+    src/htmlcharsetdecoder.h \
+    src/articlecache.h \
+    src/articleextractionworker.h \
+    src/keywordmatcher.h \
+    src/conversationgraph.h \
+    src/conversationgraphwriter.h \
+    src/conversationprefetcher.h \
+    src/tweettextrenderer.h \
+    src/emojimatcher.h \
+    src/tweetlengthcounter.h \
+    src/relativetime.h \
+    src/mutefilter.h \
+    src/mergedtimelinemodel.h \
+    src/accountsession.h \
+    src/mentionscache.h \
+    src/notificationpoller.h
 
 DISTFILES += \
     qml/pages/*.qml \
@@ -33,6 +33,31 @@ ListItem {
     contentHeight: tweetElement.height
     contentWidth: parent.width
 
+    function prefetchConversation(priority) {
+        var relevantTweet = Functions.getRelevantTweet(tweetModel);
+        if (relevantTweet.in_reply_to_status_id_str) {
+            twitterApi.prefetchConversation(relevantTweet.id_str, priority);
+        }
+    }
+
+    Connections {
+        target: singleTweet
+        onPressAndHold: {
+            singleTweet.prefetchConversation(1);
+        }
+    }
+
+    Connections {
+        target: singleTweet.ListView.view
+        onMovementEnded: {
+            // The reply the user stopped scrolling at is the one most likely to be opened next
+            var viewportCenter = singleTweet.ListView.view.contentY + singleTweet.ListView.view.height / 2;
+            if (singleTweet.y <= viewportCenter && singleTweet.y + singleTweet.height > viewportCenter) {
+                singleTweet.prefetchConversation(0);
+            }
+        }
+    }
+
     Connections {
         target: twitterApi
         onDestroySuccessful: {
@@ -87,6 +112,8 @@ ListItem {
         id: tweetElement
         tweetModel: singleTweet.tweetModel
         isRetweetMention: singleTweet.isRetweetMention
+        listView: singleTweet.ListView.view
+        listIndex: ( typeof index !== "undefined" ) ? index : -1
     }
 
     onClicked: pageStack.push(Qt.resolvedUrl("../pages/TweetPage.qml"), {"tweetModel": singleTweet.tweetModel });
@@ -19,6 +19,7 @@
 import QtQuick 2.0
 import QtGraphicalEffects 1.0
 import Sailfish.Silica 1.0
+import harbour.piepmatz 1.0
 import "../pages"
 import "../js/functions.js" as Functions
 import "../js/twemoji.js" as Emoji
@@ -39,6 +40,9 @@ Item {
     property string referenceUrl;
     property variant referenceMetadata;
     property bool hasReference : false;
+    // Set by list delegates, used to retrieve link previews of the tweets on screen first
+    property variant listView;
+    property int listIndex : -1;
     property bool extendedMode : false;
     property bool withSeparator : true;
     property bool isRetweetMention : false;
@@ -67,6 +71,33 @@ Item {
         }
     }
 
+    function getLinkPreviewPriority() {
+        // Outside of lists the tweet is all there is to see
+        if (!listView || listIndex < 0) {
+            return 100;
+        }
+        var firstVisibleIndex = listView.indexAt(listView.contentX, listView.contentY);
+        if (firstVisibleIndex < 0) {
+            return 0;
+        }
+        // Tweets further away from the top of the viewport, e.g. created ahead while scrolling, come later
+        return Math.max(0, 100 - Math.abs(listIndex - firstVisibleIndex));
+    }
+
+    // Not done in the text binding, which would otherwise depend on the scroll position
+    onReferenceUrlChanged: {
+        if (referenceUrl !== "") {
+            twitterApi.getOpenGraph(referenceUrl, getLinkPreviewPriority());
+        }
+    }
+
+    Component.onDestruction: {
+        // Scrolled out of view before the link preview arrived, no need to retrieve it anymore
+        if (referenceUrl !== "" && !hasReference) {
+            twitterApi.cancelOpenGraph(referenceUrl);
+        }
+    }
+
     Column {
         id: tweetColumn
         width: parent.width - ( 2 * Theme.horizontalPageMargin )
@@ -374,6 +405,21 @@ Item {
                             linkColor: Theme.highlightColor
                         }
 
+                        Text {
+                            visible: referenceMetadata.url ? true : false
+                            width: parent.width
+                            id: openGraphReaderLink
+                            text: "<a href=\"reader\">" + qsTr("Open in reader mode") + "</a>"
+                            font.pixelSize: Theme.fontSizeExtraSmall
+                            color: Theme.highlightColor
+                            wrapMode: Text.Wrap
+                            textFormat: Text.StyledText
+                            onLinkActivated: {
+                                pageStack.push(Qt.resolvedUrl("../pages/TextPage.qml"), {"contentId": "article", "articleUrl": referenceMetadata.url});
+                            }
+                            linkColor: Theme.highlightColor
+                        }
+
                         Separator {
                             width: parent.width
                             color: Theme.primaryColor
@@ -486,14 +532,9 @@ Item {
                         }
                     }
 
-                    Timer {
-                        id: tweetDateUpdater
-                        interval: 60000
-                        running: true
-                        repeat: true
-                        onTriggered: {
-                            tweetDateText.text = Format.formatDate(Functions.getValidDate(tweetModel.retweeted_status ? tweetModel.retweeted_status.created_at : tweetModel.created_at), Formatter.DurationElapsed);
-                        }
+                    RelativeTime {
+                        id: tweetRelativeTime
+                        createdAt: tweetModel.retweeted_status ? tweetModel.retweeted_status.created_at : tweetModel.created_at
                     }
 
                     Row {
@@ -505,7 +546,7 @@ Item {
                             id: tweetDateText
                             font.pixelSize: infoTextFontSize
                             color: Theme.secondaryColor
-                            text:  Format.formatDate(Functions.getValidDate(tweetModel.retweeted_status ? tweetModel.retweeted_status.created_at : tweetModel.created_at), Formatter.DurationElapsed)
+                            text: Format.formatDate(tweetRelativeTime.time, Formatter.DurationElapsed)
                             elide: Text.ElideRight
                             maximumLineCount: 1
                         }
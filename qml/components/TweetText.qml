@@ -45,9 +45,15 @@ Column {
 
     function makeTheTextGreatAgain() {
         var relevantTweet = Functions.getRelevantTweet(tweetTextColumn.tweet);
-        var greatifiedText = relevantTweet.full_text;
-        greatifiedText = Emoji.emojify(Functions.enhanceText(greatifiedText, relevantTweet.entities, relevantTweet.extended_entities), componentFontSize);
-        return greatifiedText;
+        var greatifiedText;
+        if (typeof relevantTweet.rendered_text !== "undefined") {
+            // Already rendered when the tweet was received, only embedded tweets and link previews are left
+            Functions.followTweetReferences(relevantTweet.entities, true, true);
+            greatifiedText = relevantTweet.rendered_text;
+        } else {
+            greatifiedText = Functions.enhanceText(relevantTweet.full_text, relevantTweet.entities, relevantTweet.extended_entities);
+        }
+        return Emoji.emojify(greatifiedText, componentFontSize);
     }
 
     Text {
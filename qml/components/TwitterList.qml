@@ -28,6 +28,7 @@ ListItem {
     id: singleList
 
     property variant listModel;
+    property bool inMergedTimeline : mergedTimelineModel.containsList(listModel.id_str);
 
     contentHeight: listRow.height + listSeparator.height + 2 * Theme.paddingMedium
     contentWidth: parent.width
@@ -36,6 +37,26 @@ ListItem {
         pageStack.push(Qt.resolvedUrl("../pages/ListTimelinePage.qml"), {"listId": listModel.id_str, "listName": listModel.name});
     }
 
+    menu: ContextMenu {
+        MenuItem {
+            onClicked: {
+                if (singleList.inMergedTimeline) {
+                    mergedTimelineModel.removeList(listModel.id_str);
+                } else {
+                    mergedTimelineModel.addList(listModel.id_str);
+                }
+                singleList.inMergedTimeline = mergedTimelineModel.containsList(listModel.id_str);
+            }
+            text: singleList.inMergedTimeline ? qsTr("Remove from Merged Timeline") : qsTr("Add to Merged Timeline")
+        }
+        MenuItem {
+            onClicked: {
+                pageStack.push(Qt.resolvedUrl("../pages/MergedTimelinePage.qml"));
+            }
+            text: qsTr("Show Merged Timeline")
+        }
+    }
+
     Column {
         id: listColumn
         width: parent.width - ( 2 * Theme.horizontalPageMargin )
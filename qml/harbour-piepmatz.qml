@@ -29,6 +29,15 @@ ApplicationWindow
     property bool isWifi: accountModel.isWiFi();
     property string linkPreviewMode: accountModel.getLinkPreviewMode();
 
+    // Without WiFi, users who restricted link previews don't want anything downloaded in advance
+    function updateDataSaverMode() {
+        twitterApi.setDataSaverMode(!isWifi && linkPreviewMode !== "always");
+    }
+
+    onIsWifiChanged: updateDataSaverMode()
+    onLinkPreviewModeChanged: updateDataSaverMode()
+    Component.onCompleted: updateDataSaverMode()
+
     Component {
         id: aboutPage
         AboutPage {}
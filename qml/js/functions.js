@@ -110,9 +110,28 @@ function enhanceText(tweetText, entities, extendedEntities) {
     return enhanceTweetText(tweetText, entities, extendedEntities, true, true);
 }
 
+function followTweetReferences(entities, withReferenceUrl, followEmbeddedTweet) {
+    for (var i = 0; i < entities.urls.length; i++ ) {
+        var tweetId = getTweetId(entities.urls[i].expanded_url);
+        if (tweetId !== null && followEmbeddedTweet) {
+            // Tweet URLs become embedded tweets...
+            embeddedTweetId = tweetId;
+            twitterApi.showStatus(tweetId);
+        } else {
+            // TODO: Could fail in case of multiple references. Well, let's see what happens :D
+            if (withReferenceUrl && ( appWindow.linkPreviewMode === "always" || ( appWindow.linkPreviewMode === "wifiOnly" && appWindow.isWifi ) ) ) {
+                // The tweet element retrieves the preview, prioritized by its position in the list
+                referenceUrl = entities.urls[i].expanded_url;
+            }
+        }
+    }
+}
+
 function enhanceTweetText(tweetText, entities, extendedEntities, withReferenceUrl, followEmbeddedTweet) {
     var replacements = [];
 
+    followTweetReferences(entities, withReferenceUrl, followEmbeddedTweet);
+
     TwitterText.convertUnicodeIndices(tweetText, entities.hashtags);
     TwitterText.convertUnicodeIndices(tweetText, entities.symbols);
     TwitterText.convertUnicodeIndices(tweetText, entities.urls);
@@ -123,17 +142,10 @@ function enhanceTweetText(tweetText, entities, extendedEntities, withReferenceUr
         var tweetId = getTweetId(entities.urls[i].expanded_url);
         if (tweetId !== null && followEmbeddedTweet) {
             // Remove tweet URLs - will become embedded tweets...
-            embeddedTweetId = tweetId;
-            twitterApi.showStatus(tweetId);
             replacements.push(new Replacement(entities.urls[i].indices[0], entities.urls[i].indices[1], entities.urls[i].url, ""));
         } else {
             var url_replacement = "<a href=\"" + entities.urls[i].expanded_url + "\">" + entities.urls[i].display_url + "</a>";
             replacements.push(new Replacement(entities.urls[i].indices[0], entities.urls[i].indices[1], entities.urls[i].url, url_replacement));
-            // TODO: Could fail in case of multiple references. Well, let's see what happens :D
-            if (withReferenceUrl && ( appWindow.linkPreviewMode === "always" || ( appWindow.linkPreviewMode === "wifiOnly" && appWindow.isWifi ) ) ) {
-                referenceUrl = entities.urls[i].expanded_url;
-                twitterApi.getOpenGraph(entities.urls[i].expanded_url);
-            }
         }
     }
     // Remove media links - will become own QML entities
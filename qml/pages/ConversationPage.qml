@@ -18,9 +18,9 @@
 */
 import QtQuick 2.0
 import Sailfish.Silica 1.0
+import harbour.piepmatz 1.0
 import "../components"
 import "../js/functions.js" as Functions
-import "../js/twitter-text.js" as TwitterText
 import "../js/twemoji.js" as Emoji
 
 Page {
@@ -65,7 +65,7 @@ Page {
     property bool loaded : true;
 
     function getRemainingCharacters(text, configuration) {
-        return 10000 - TwitterText.getTweetLength(text);
+        return 10000 - tweetLengthCounter.getTweetLength(text);
     }
 
     AppNotification {
@@ -162,14 +162,9 @@ Page {
                             linkColor: Theme.highlightColor
                         }
 
-                        Timer {
-                            id: messageDateUpdater
-                            interval: 60000
-                            running: true
-                            repeat: true
-                            onTriggered: {
-                                messageDateText.text = Format.formatDate(new Date(parseInt(modelData.created_timestamp)), Formatter.DurationElapsed);
-                            }
+                        RelativeTime {
+                            id: messageRelativeTime
+                            timestamp: modelData.created_timestamp
                         }
 
                         Text {
@@ -181,7 +176,7 @@ Page {
                             }
 
                             id: messageDateText
-                            text: Format.formatDate(new Date(parseInt(modelData.created_timestamp)), Formatter.DurationElapsed);
+                            text: Format.formatDate(messageRelativeTime.time, Formatter.DurationElapsed);
                             font.pixelSize: Theme.fontSizeTiny
                             color: modelData.message_create.sender_id === conversationPage.myUserId ? Theme.highlightColor : Theme.primaryColor
                             horizontalAlignment: (modelData.message_create.sender_id === conversationPage.myUserId) ? Text.AlignRight : Text.AlignLeft
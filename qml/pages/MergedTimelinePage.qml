@@ -0,0 +1,131 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+import QtQuick 2.0
+import Sailfish.Silica 1.0
+import "../components"
+
+Page {
+    id: mergedTimelinePage
+    allowedOrientations: Orientation.All
+
+    focus: true
+    Keys.onLeftPressed: {
+        pageStack.pop();
+    }
+    Keys.onEscapePressed: {
+        pageStack.pop();
+    }
+    Keys.onDownPressed: {
+        mergedTimelineListView.flick(0, - parent.height);
+    }
+    Keys.onUpPressed: {
+        mergedTimelineListView.flick(0, parent.height);
+    }
+    Keys.onPressed: {
+        if (event.key === Qt.Key_T) {
+            mergedTimelineListView.scrollToTop();
+            event.accepted = true;
+        }
+        if (event.key === Qt.Key_B) {
+            mergedTimelineListView.scrollToBottom();
+            event.accepted = true;
+        }
+        if (event.key === Qt.Key_PageDown) {
+            mergedTimelineListView.flick(0, - parent.height * 2);
+            event.accepted = true;
+        }
+        if (event.key === Qt.Key_PageUp) {
+            mergedTimelineListView.flick(0, parent.height * 2);
+            event.accepted = true;
+        }
+    }
+
+    property bool loaded : false;
+
+    Component.onCompleted: {
+        mergedTimelineModel.update();
+    }
+
+    AppNotification {
+        id: mergedTimelineNotification
+    }
+
+    Connections {
+        target: mergedTimelineModel
+        onMergedTimelineStartUpdate: {
+            loaded = mergedTimelineListView.count > 0;
+        }
+        onMergedTimelineUpdated: {
+            loaded = true;
+        }
+        onMergedTimelineError: {
+            mergedTimelineNotification.show(errorMessage);
+        }
+    }
+
+    SilicaFlickable {
+        id: mergedTimelineContainer
+        width: parent.width
+        height: parent.height
+
+        PullDownMenu {
+            MenuItem {
+                text: qsTr("Refresh")
+                onClicked: {
+                    mergedTimelineModel.update();
+                }
+            }
+        }
+
+        LoadingIndicator {
+            id: mergedTimelineLoadingIndicator
+            visible: !loaded
+            Behavior on opacity { NumberAnimation {} }
+            opacity: loaded ? 0 : 1
+            height: parent.height
+            width: parent.width
+        }
+
+        Column {
+            anchors.fill: parent
+
+            PageHeader {
+                id: mergedTimelineHeader
+                title: qsTr("Merged Timeline")
+            }
+
+            SilicaListView {
+                id: mergedTimelineListView
+
+                anchors.left: parent.left
+                anchors.right: parent.right
+                height: parent.height - mergedTimelineHeader.height
+
+                clip: true
+
+                model: mergedTimelineModel
+                delegate: Tweet {
+                    tweetModel: display
+                }
+
+                VerticalScrollDecorator {}
+            }
+        }
+    }
+}
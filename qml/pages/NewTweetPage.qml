@@ -19,7 +19,6 @@
 import QtQuick 2.5
 import QtGraphicalEffects 1.0
 import Sailfish.Silica 1.0
-import "../js/twitter-text.js" as TwitterText
 import "../components"
 import "../js/functions.js" as Functions
 import "../js/twemoji.js" as Emoji
@@ -52,9 +51,10 @@ Page {
     property alias initialText: enterTweetTextArea.text;
 
     function parseText(text) {
-        var parsingResult = TwitterText.parseTweet(text);
-        newTweetPage.valid = parsingResult.valid;
-        newTweetPage.progress = parsingResult.permillage > 1000 ? 1 : ( parsingResult.permillage / 1000 );
+        tweetLengthCounter.updateText(text);
+        newTweetPage.valid = tweetLengthCounter.isValid();
+        var permillage = tweetLengthCounter.getPermillage();
+        newTweetPage.progress = permillage > 1000 ? 1 : ( permillage / 1000 );
     }
 
     function getWordBoundaries(text, cursorPosition) {
@@ -96,7 +96,7 @@ Page {
     }
 
     function getRemainingDescriptionCharacters(text) {
-        return 420 - TwitterText.getTweetLength(text);
+        return 420 - tweetLengthCounter.getTweetLength(text);
     }
 
     Timer {
@@ -120,6 +120,10 @@ Page {
     }
 
     Component.onCompleted: {
+        if (newTweetPage.configuration) {
+            tweetLengthCounter.setConfiguration(newTweetPage.configuration);
+            parseText(enterTweetTextArea.text);
+        }
         if (locationInformation.hasInformation()) {
             updateLocationInformationTimer.start();
             var currentPosition = locationInformation.getCurrentPosition();
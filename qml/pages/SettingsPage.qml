@@ -280,6 +280,53 @@ Page {
                 }
             }
 
+            ComboBox {
+                id: linkPreviewBudgetComboBox
+                property var byteBudgets: [0, 1048576, 5242880, 20971520]
+                label: qsTr("Link Preview Data")
+                currentIndex: Math.max(0, byteBudgets.indexOf(accountModel.getLinkPreviewByteBudget()))
+                description: qsTr("Limit the data used for link previews per timeline refresh")
+                visible: linkPreviewComboBox.currentIndex !== 2
+                menu: ContextMenu {
+                     MenuItem {
+                        text: qsTr("Unlimited")
+                     }
+                     MenuItem {
+                        text: qsTr("1 MB")
+                     }
+                     MenuItem {
+                        text: qsTr("5 MB")
+                     }
+                     MenuItem {
+                        text: qsTr("20 MB")
+                     }
+                    onActivated: {
+                        accountModel.setLinkPreviewByteBudget(linkPreviewBudgetComboBox.byteBudgets[index]);
+                    }
+                }
+            }
+
+            Timer {
+                id: muteRulesTimer
+                interval: 500
+                running: false
+                onTriggered: {
+                    twitterApi.setMuteRules(muteRulesTextArea.text.split("\n"));
+                }
+            }
+
+            TextArea {
+                id: muteRulesTextArea
+                width: parent.width
+                label: qsTr("Muted words, #hashtags, @users and /regular expressions/, one per line")
+                placeholderText: qsTr("Mute tweets")
+                text: twitterApi.getMuteRules().join("\n")
+                onTextChanged: {
+                    muteRulesTimer.stop();
+                    muteRulesTimer.start();
+                }
+            }
+
             SectionHeader {
                 text: qsTr("Location")
             }
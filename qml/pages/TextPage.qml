@@ -58,6 +58,7 @@ Page {
     }
 
     property string contentId;
+    property string articleUrl;
     property bool loading;
 
     Component.onCompleted: {
@@ -73,6 +74,12 @@ Page {
             twitterApi.helpPrivacy();
             return;
         }
+        if (textPage.contentId === "article") {
+            textHeader.title = qsTr("Reader Mode");
+            textPage.loading = true;
+            twitterApi.getArticle(textPage.articleUrl);
+            return;
+        }
         textNotification.show("Piepmatz doesn't know what you were asking for!");
     }
 
@@ -95,6 +102,24 @@ Page {
             textPage.loading = false;
             textNotification.show(errorMessage);
         }
+        onGetArticleSuccessful: {
+            if (textPage.contentId !== "article" || result.url !== textPage.articleUrl) {
+                return;
+            }
+            textPage.loading = false;
+            if (result.title) {
+                textHeader.title = result.title;
+            }
+            // The extracted content is already escaped HTML, a changed page is simply delivered again
+            textContent.text = result.content;
+        }
+        onGetArticleError: {
+            if (textPage.contentId !== "article") {
+                return;
+            }
+            textPage.loading = false;
+            textNotification.show(errorMessage);
+        }
     }
 
     Column {
@@ -126,6 +151,14 @@ Page {
             id: textNotification
         }
 
+        PullDownMenu {
+            visible: textPage.contentId === "article"
+            MenuItem {
+                text: qsTr("Open in Browser")
+                onClicked: Qt.openUrlExternally(textPage.articleUrl)
+            }
+        }
+
         Column {
             id: column
             width: textPage.width
@@ -143,7 +176,8 @@ Page {
                 color: Theme.primaryColor
                 linkColor: Theme.highlightColor
                 wrapMode: Text.Wrap
-                textFormat: Text.PlainText
+                textFormat: textPage.contentId === "article" ? Text.StyledText : Text.PlainText
+                onLinkActivated: Functions.handleLink(link)
             }
 
             VerticalScrollDecorator {}
@@ -11,9 +11,11 @@
 QMAKE_CFLAGS += -std=c99
 
 SOURCES += \
+    $$PWD/qgumboarena.cpp \
     $$PWD/qgumboattribute.cpp \
     $$PWD/qgumbodocument.cpp \
     $$PWD/qgumbonode.cpp \
+    $$PWD/qgumboselector.cpp \
     $$PWD/gumbo-parser/src/attribute.c \
     $$PWD/gumbo-parser/src/char_ref.c \
     $$PWD/gumbo-parser/src/error.c \
@@ -27,9 +29,11 @@ SOURCES += \
     $$PWD/gumbo-parser/src/vector.c
 
 HEADERS += \
+    $$PWD/qgumboarena.h \
     $$PWD/qgumboattribute.h \
     $$PWD/qgumbodocument.h \
     $$PWD/qgumbonode.h \
+    $$PWD/qgumboselector.h \
     $$PWD/gumbo-parser/src/attribute.h \
     $$PWD/gumbo-parser/src/char_ref.h \
     $$PWD/gumbo-parser/src/error.h \
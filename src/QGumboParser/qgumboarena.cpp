@@ -0,0 +1,74 @@
+#include <cstdlib>
+#include "qgumboarena.h"
+
+namespace {
+
+// Gumbo only stores pointers, integers and chars, two pointers are enough for all of them
+const size_t ALIGNMENT = 2 * sizeof(void*);
+const size_t MINIMUM_CHUNK_SIZE = 64 * 1024;
+// The parse tree is usually a few times larger than the HTML it was created from
+const size_t EXPECTED_SIZE_FACTOR = 4;
+
+inline size_t alignedSize(size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+} /* namespace */
+
+QGumboArena::QGumboArena(size_t expectedSize) :
+    nextChunkSize_(MINIMUM_CHUNK_SIZE)
+{
+    addChunk(expectedSize * EXPECTED_SIZE_FACTOR);
+}
+
+QGumboArena::~QGumboArena()
+{
+    while (current_) {
+        Chunk* previous = current_->previous;
+        std::free(current_);
+        current_ = previous;
+    }
+}
+
+void* QGumboArena::allocate(size_t size)
+{
+    size = alignedSize(size ? size : 1);
+    if (!current_ || current_->size - current_->used < size) {
+        // Behave like malloc() if we are out of memory, Gumbo itself is written in C
+        if (!addChunk(size))
+            return nullptr;
+    }
+
+    char* data = reinterpret_cast<char*>(current_) + alignedSize(sizeof(Chunk)) + current_->used;
+    current_->used += size;
+    return data;
+}
+
+void* QGumboArena::allocate(void* userdata, size_t size)
+{
+    return static_cast<QGumboArena*>(userdata)->allocate(size);
+}
+
+void QGumboArena::deallocate(void*, void*)
+{
+    // Released together with the arena
+}
+
+bool QGumboArena::addChunk(size_t minimumSize)
+{
+    size_t size = nextChunkSize_;
+    while (size < minimumSize)
+        size *= 2;
+
+    Chunk* chunk = static_cast<Chunk*>(std::malloc(alignedSize(sizeof(Chunk)) + size));
+    if (!chunk)
+        return false;
+
+    chunk->previous = current_;
+    chunk->size = size;
+    chunk->used = 0;
+    current_ = chunk;
+    nextChunkSize_ = size * 2;
+    return true;
+}
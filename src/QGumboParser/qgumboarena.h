@@ -0,0 +1,39 @@
+#ifndef QGUMBOARENA_H
+#define QGUMBOARENA_H
+
+#include <cstddef>
+
+/*
+ * Bump allocator for Gumbo. Everything Gumbo allocates while parsing one document is
+ * carved out of a few large chunks, single deallocations are ignored and the whole
+ * parse tree is released at once when the arena is destroyed.
+ */
+class QGumboArena
+{
+public:
+    explicit QGumboArena(size_t expectedSize);
+    ~QGumboArena();
+
+    void* allocate(size_t size);
+
+    // Callbacks for GumboOptions, userdata is the arena
+    static void* allocate(void* userdata, size_t size);
+    static void deallocate(void* userdata, void* ptr);
+
+private:
+    QGumboArena(const QGumboArena&) = delete;
+    QGumboArena& operator=(const QGumboArena&) = delete;
+
+    struct Chunk {
+        Chunk* previous;
+        size_t size;
+        size_t used;
+    };
+
+    bool addChunk(size_t minimumSize);
+
+    Chunk* current_ = nullptr;
+    size_t nextChunkSize_;
+};
+
+#endif // QGUMBOARENA_H
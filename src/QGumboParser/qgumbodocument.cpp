@@ -3,6 +3,7 @@
 #include <stdexcept>
 #include "qgumbodocument.h"
 #include "qgumbonode.h"
+#include "qgumboarena.h"
 
 QGumboDocument QGumboDocument::parse(const char *utf8data)
 {
@@ -23,34 +24,56 @@ QGumboDocument QGumboDocument::parse(QByteArray data)
 }
 
 QGumboDocument::QGumboDocument(QByteArray arr) :
-    options_(&kGumboDefaultOptions),
-    sourceData_(arr)
+    sourceData_(arr),
+    arena_(new QGumboArena(static_cast<size_t>(arr.length())))
 {
+    // All nodes live in the arena, so the whole tree is released at once instead of node by node
+    GumboOptions* options = new GumboOptions(kGumboDefaultOptions);
+    options->allocator = &QGumboArena::allocate;
+    options->deallocator = &QGumboArena::deallocate;
+    options->userdata = arena_;
+    options_ = options;
+
     gumboOutput_ = gumbo_parse_with_options(options_,
                                             sourceData_.constData(),
                                             sourceData_.length());
-    if (!gumboOutput_)
+    if (!gumboOutput_) {
+        delete arena_;
+        delete options_;
         throw std::runtime_error("the data can't be parsed");
+    }
 }
 
 QGumboDocument::~QGumboDocument()
 {
-    if (gumboOutput_)
+    if (gumboOutput_ && !arena_)
         gumbo_destroy_output(options_, gumboOutput_);
+    delete arena_;
     if (options_ != &kGumboDefaultOptions)
         delete options_;
+    delete textCache_;
 }
 
 QGumboDocument::QGumboDocument(QGumboDocument &&source) :
     gumboOutput_(source.gumboOutput_),
     options_(source.options_),
-    sourceData_(source.sourceData_)
+    sourceData_(source.sourceData_),
+    arena_(source.arena_),
+    textCache_(source.textCache_)
 {
     source.gumboOutput_ = nullptr;
     source.options_ = nullptr;
+    source.arena_ = nullptr;
+    source.textCache_ = nullptr;
 }
 
 QGumboNode QGumboDocument::rootNode() const
 {
-    return QGumboNode(gumboOutput_->root);
+    return QGumboNode(gumboOutput_->root, textCache_);
+}
+
+void QGumboDocument::enableInnerTextCache()
+{
+    if (!textCache_)
+        textCache_ = new QGumboTextCache();
 }
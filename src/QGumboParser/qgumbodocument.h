@@ -3,9 +3,10 @@
 
 #include <QByteArray>
 #include "gumbo-parser/src/gumbo.h"
+#include "qgumbonode.h"
 
 class QString;
-class QGumboNode;
+class QGumboArena;
 
 class QGumboDocument
 {
@@ -20,6 +21,9 @@ public:
 
     QGumboNode rootNode() const;
 
+    // Remembers innerText() of all nodes of this document, useful if the same nodes are queried over and over again
+    void enableInnerTextCache();
+
 private:
     QGumboDocument(QByteArray);
 
@@ -29,6 +33,8 @@ private:
     GumboOutput *gumboOutput_ = nullptr;
     const GumboOptions *options_ = nullptr;
     QByteArray sourceData_;
+    QGumboArena *arena_ = nullptr;
+    QGumboTextCache *textCache_ = nullptr;
 };
 
 #endif // QGUMBODOCUMENT_H
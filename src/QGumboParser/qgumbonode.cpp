@@ -1,11 +1,14 @@
+#include <cctype>
 #include <cstring>
 #include <sstream>
+#include <QByteArray>
 #include <QString>
 #include <QDebug>
 #include <QStringList>
 #include <QRegularExpression>
 #include "qgumbonode.h"
 #include "qgumboattribute.h"
+#include "qgumboselector.h"
 
 namespace {
 
@@ -13,8 +16,6 @@ const char* const ID_ATTRIBUTE 		= u8"id";
 const char* const CLASS_ATTRIBUTE 	= u8"class";
 const char* const STYLE_ATTRIBUTE 	= u8"style";
 
-const QRegularExpression REGEXP_UNLIKELY_CANDIDATES = QRegularExpression("/-ad-|ai2html|banner|breadcrumbs|combx|comment|community|cover-wrap|disqus|extra|foot|gdpr|header|legends|menu|related|remark|replies|rss|shoutbox|sidebar|skyscraper|social|sponsor|supplemental|ad-break|agegate|pagination|pager|popup|yom-remote/i");
-const QRegularExpression REGEXP_OK_MAYBE_ITS_A_CANDIDATE = QRegularExpression("/and|article|body|column|main|shadow/i");
 const QRegularExpression REGEXP_EXTRANEOUS = QRegularExpression("/print|archive|comment|discuss|e[\\-]?mail|share|reply|all|login|sign|single|utility/i");
 const QRegularExpression REGEXP_BYLINE = QRegularExpression("/byline|author|dateline|writtenby|p-author/i");
 const QRegularExpression REGEXP_REPLACE_FONTS = QRegularExpression("/<(\\/?)font[^>]*>/gi");
@@ -25,8 +26,24 @@ const QRegularExpression REGEXP_PREV_LINK = QRegularExpression("/(prev|earl|old|
 const QRegularExpression REGEXP_WHITESPACE = QRegularExpression("/^\\s*$/");
 const QRegularExpression REGEXP_HAS_CONTENT = QRegularExpression("/\\S$/");
 
-// Element tags to score by default.
-const QList<HtmlTag> DEFAULT_TAGS_TO_SCORE = QList<HtmlTag>() << HtmlTag::SECTION << HtmlTag::H2 << HtmlTag::H3 << HtmlTag::H4 << HtmlTag::H5 << HtmlTag::H6 << HtmlTag::P << HtmlTag::TD << HtmlTag::PRE;
+// Checks whether the whitespace separated list of classes contains the given class name, ignoring case
+bool containsClass(const char* classList, const char* className, int classNameLength)
+{
+    if (!classList || classNameLength <= 0)
+        return false;
+
+    const char* current = classList;
+    while (*current) {
+        while (*current && std::isspace(static_cast<unsigned char>(*current)))
+            ++current;
+        const char* start = current;
+        while (*current && !std::isspace(static_cast<unsigned char>(*current)))
+            ++current;
+        if (current - start == classNameLength && qstrnicmp(start, className, classNameLength) == 0)
+            return true;
+    }
+    return false;
+}
 
 template<typename TFunctor>
 bool iterateTree(GumboNode* node, TFunctor& functor)
@@ -45,6 +62,17 @@ bool iterateTree(GumboNode* node, TFunctor& functor)
     return false;
 }
 
+void appendTextContent(GumboNode* node, QByteArray& text)
+{
+    if (node->type == GUMBO_NODE_ELEMENT) {
+        GumboVector& vec = node->v.element.children;
+        for (uint i = 0, e = vec.length; i < e; ++i)
+            appendTextContent(static_cast<GumboNode*>(vec.data[i]), text);
+    } else if (node->type == GUMBO_NODE_TEXT || node->type == GUMBO_NODE_WHITESPACE || node->type == GUMBO_NODE_CDATA) {
+        text.append(node->v.text.text);
+    }
+}
+
 template<typename TFunctor>
 bool iterateChildren(GumboNode* node, TFunctor& functor)
 {
@@ -68,8 +96,9 @@ QGumboNode::QGumboNode()
 {
 }
 
-QGumboNode::QGumboNode(GumboNode* node) :
-    ptr_(node)
+QGumboNode::QGumboNode(GumboNode* node, QGumboTextCache* textCache) :
+    ptr_(node),
+    textCache_(textCache)
 {
     if (!ptr_)
         throw std::runtime_error("can't create Node from nullptr");
@@ -124,15 +153,14 @@ QGumboNodes QGumboNode::getElementById(const QString& nodeId) const
         throw std::invalid_argument("id can't be empty string");
 
     QGumboNodes nodes;
+    QGumboTextCache* textCache = textCache_;
+    const QByteArray utf8NodeId = nodeId.toUtf8();
 
-    auto functor = [&nodes, &nodeId] (GumboNode* node) {
+    auto functor = [&nodes, &utf8NodeId, textCache] (GumboNode* node) {
         GumboAttribute* attr = gumbo_get_attribute(&node->v.element.attributes, ID_ATTRIBUTE);
-        if (attr) {
-            const QString value = QString::fromUtf8(attr->value);
-            if (value.compare(nodeId, Qt::CaseInsensitive) == 0) {
-                nodes.emplace_back(QGumboNode(node));
-                return true;
-            }
+        if (attr && qstricmp(attr->value, utf8NodeId.constData()) == 0) {
+            nodes.emplace_back(QGumboNode(node, textCache));
+            return true;
         }
         return false;
     };
@@ -148,10 +176,11 @@ QGumboNodes QGumboNode::getElementsByTagName(HtmlTag tag) const
 
     GumboTag tag_ = static_cast<GumboTag>(tag);
     QGumboNodes nodes;
+    QGumboTextCache* textCache = textCache_;
 
-    auto functor = [&nodes, tag_](GumboNode* node) {
+    auto functor = [&nodes, tag_, textCache](GumboNode* node) {
         if (node->v.element.tag == tag_) {
-            nodes.emplace_back(QGumboNode(node));
+            nodes.emplace_back(QGumboNode(node, textCache));
         }
         return false;
     };
@@ -169,20 +198,13 @@ QGumboNodes QGumboNode::getElementsByClassName(const QString& name) const
         throw std::invalid_argument("class name can't be empty string");
 
     QGumboNodes nodes;
+    QGumboTextCache* textCache = textCache_;
+    const QByteArray utf8Name = name.toUtf8();
 
-    auto functor = [&nodes, &name] (GumboNode* node) {
+    auto functor = [&nodes, &utf8Name, textCache] (GumboNode* node) {
         GumboAttribute* attr = gumbo_get_attribute(&node->v.element.attributes, CLASS_ATTRIBUTE);
-        if (attr) {
-            const QString value = QString::fromUtf8(attr->value);
-            const QVector<QStringRef> parts =
-                    value.splitRef(QChar(' '), QString::SkipEmptyParts, Qt::CaseInsensitive);
-
-            for (const QStringRef& part: parts) {
-                if (part.compare(name, Qt::CaseInsensitive) == 0) {
-                    nodes.emplace_back(QGumboNode(node));
-                    break;
-                }
-            }
+        if (attr && containsClass(attr->value, utf8Name.constData(), utf8Name.length())) {
+            nodes.emplace_back(QGumboNode(node, textCache));
         }
         return false;
     };
@@ -192,57 +214,23 @@ QGumboNodes QGumboNode::getElementsByClassName(const QString& name) const
     return nodes;
 }
 
-QGumboNodes QGumboNode::getAllElementsForExtractor() const
+QGumboNodes QGumboNode::querySelectorAll(const QString& selector) const
+{
+    return querySelectorAll(QGumboSelector::compile(selector));
+}
+
+QGumboNodes QGumboNode::querySelectorAll(const QGumboSelector& selector) const
 {
     Q_ASSERT(ptr_);
 
     QGumboNodes nodes;
+    QGumboTextCache* textCache = textCache_;
+    GumboNode* scope = ptr_;
 
-    auto functor = [&nodes](GumboNode* node) {
-        QGumboNode myNode(node);
-
-        qDebug() << "Current Tag: " << node->v.element.tag;
-        QString nodeIdentifier = myNode.getAttribute(CLASS_ATTRIBUTE) + " " + myNode.id();
-        qDebug() << "Current Node Identifier: " << nodeIdentifier;
-
-
-        // Remove all invisible nodes...
-        if (!myNode.isProbablyVisible()) {
-            qDebug() << "Not visible";
-            return false;
+    auto functor = [&nodes, &selector, scope, textCache] (GumboNode* node) {
+        if (node != scope && selector.matches(node)) {
+            nodes.emplace_back(QGumboNode(node, textCache));
         }
-
-        if (!myNode.getByLine(nodeIdentifier).isEmpty()) {
-            qDebug() << "Byline identified";
-            return false;
-        }
-
-        if (REGEXP_UNLIKELY_CANDIDATES.match(nodeIdentifier).hasMatch() &&
-                !REGEXP_OK_MAYBE_ITS_A_CANDIDATE.match(nodeIdentifier).hasMatch() &&
-                !myNode.hasAncestorTag(HtmlTag::TABLE) &&
-                myNode.tag() != HtmlTag::BODY &&
-                myNode.tag() != HtmlTag::A) {
-            qDebug() << "Unlikely candidate";
-            return false;
-        }
-
-        // Remove DIV, SECTION and HEADER nodes without content
-        if ((myNode.tag() == HtmlTag::DIV || myNode.tag() == HtmlTag::SECTION || myNode.tag() == HtmlTag::HEADER ||
-                myNode.tag() == HtmlTag::H1 || myNode.tag() == HtmlTag::H2 || myNode.tag() == HtmlTag::H3 ||
-                myNode.tag() == HtmlTag::H4 || myNode.tag() == HtmlTag::H5 || myNode.tag() == HtmlTag::H6)
-                && !myNode.containsContent()) {
-            qDebug() << "DIV, SECTION or HEADER without content";
-            return false;
-        }
-
-        if (DEFAULT_TAGS_TO_SCORE.contains(myNode.tag())) {
-            qDebug() << "SUCCESS";
-            qDebug() << myNode.innerText();
-            nodes.emplace_back(myNode);
-            return true;
-        }
-
-        qDebug() << "Nothing matched, BAD!";
         return false;
     };
 
@@ -256,9 +244,10 @@ QGumboNodes QGumboNode::childNodes() const
     Q_ASSERT(ptr_);
 
     QGumboNodes nodes;
+    QGumboTextCache* textCache = textCache_;
 
-    auto functor = [&nodes] (GumboNode* node) {
-        nodes.emplace_back(QGumboNode(node));
+    auto functor = [&nodes, textCache] (GumboNode* node) {
+        nodes.emplace_back(QGumboNode(node, textCache));
         return false;
     };
 
@@ -272,10 +261,11 @@ QGumboNodes QGumboNode::children() const
     Q_ASSERT(ptr_);
 
     QGumboNodes nodes;
+    QGumboTextCache* textCache = textCache_;
 
-    auto functor = [&nodes] (GumboNode* node) {
+    auto functor = [&nodes, textCache] (GumboNode* node) {
         if (node->type == GUMBO_NODE_ELEMENT) {
-            nodes.emplace_back(QGumboNode(node));
+            nodes.emplace_back(QGumboNode(node, textCache));
         }
         return false;
     };
@@ -300,7 +290,7 @@ QGumboNodes QGumboNode::ancestors(const int &maxDepth) const
         currentDepth++;
         currentNode = currentNode->parent;
         if (currentNode->type == GUMBO_NODE_ELEMENT) {
-            nodes.emplace_back(QGumboNode(currentNode));
+            nodes.emplace_back(QGumboNode(currentNode, textCache_));
         }
         if (currentDepth == maxDepth) {
             break;
@@ -314,7 +304,7 @@ QGumboNode QGumboNode::parent() const
 {
     Q_ASSERT(ptr_);
 
-    QGumboNode myParent(ptr_->parent);
+    QGumboNode myParent(ptr_->parent, textCache_);
 
     return myParent;
 }
@@ -341,15 +331,30 @@ QString QGumboNode::innerText(const bool &normalize) const
     Q_ASSERT(ptr_);
 
     QString text;
+    bool cached = false;
 
-    auto functor = [&text] (GumboNode* node) {
-        if (node->type == GUMBO_NODE_TEXT) {
-            text += QString::fromUtf8(node->v.text.text);
+    if (textCache_) {
+        QGumboTextCache::const_iterator cachedText = textCache_->constFind(ptr_);
+        if (cachedText != textCache_->constEnd()) {
+            text = cachedText.value();
+            cached = true;
         }
-        return false;
-    };
+    }
 
-    iterateChildren(ptr_, functor);
+    if (!cached) {
+        auto functor = [&text] (GumboNode* node) {
+            if (node->type == GUMBO_NODE_TEXT) {
+                text += QString::fromUtf8(node->v.text.text);
+            }
+            return false;
+        };
+
+        iterateChildren(ptr_, functor);
+
+        if (textCache_) {
+            textCache_->insert(ptr_, text);
+        }
+    }
 
     if (normalize) {
         text = text.trimmed().replace(REGEXP_NORMALIZE, " ");
@@ -358,14 +363,58 @@ QString QGumboNode::innerText(const bool &normalize) const
     return text;
 }
 
-QString QGumboNode::hash() const
+QString QGumboNode::textContent() const
 {
-    QCryptographicHash myHash(QCryptographicHash::Md5);
-    myHash.addData(this->id().toUtf8());
-    myHash.addData(this->tagName().toUtf8());
-    myHash.addData(this->getAttribute(CLASS_ATTRIBUTE).toUtf8());
-    myHash.addData(this->innerText().toUtf8());
-    return QString(myHash.result().toHex());
+    Q_ASSERT(ptr_);
+
+    // Collected as UTF-8 first, so that there is only one conversion for the whole subtree
+    QByteArray text;
+    appendTextContent(ptr_, text);
+    return QString::fromUtf8(text);
+}
+
+int QGumboNode::innerTextLength(int *commaCount) const
+{
+    Q_ASSERT(ptr_);
+
+    // Same text as innerText(true), but measured directly on Gumbo's UTF-8 buffers:
+    // leading and trailing whitespace is ignored, inner whitespace runs count as one character.
+    int length = 0;
+    int commas = 0;
+    bool pendingSpace = false;
+
+    auto functor = [&length, &commas, &pendingSpace] (GumboNode* node) {
+        if (node->type == GUMBO_NODE_TEXT) {
+            for (const char *current = node->v.text.text; *current; ++current) {
+                const unsigned char character = static_cast<unsigned char>(*current);
+                if (std::isspace(character)) {
+                    pendingSpace = (length > 0);
+                    continue;
+                }
+                if ((character & 0xC0) == 0x80) {
+                    // UTF-8 continuation byte, already counted with its lead byte
+                    continue;
+                }
+                if (pendingSpace) {
+                    length++;
+                    pendingSpace = false;
+                }
+                // Code points outside the BMP need two UTF-16 code units in a QString
+                length += (character >= 0xF0) ? 2 : 1;
+                if (character == ',') {
+                    commas++;
+                }
+            }
+        }
+        return false;
+    };
+
+    iterateChildren(ptr_, functor);
+
+    if (commaCount) {
+        *commaCount = commas;
+    }
+    return length;
 }
 
 QString QGumboNode::outerHtml() const
@@ -409,6 +458,12 @@ QString QGumboNode::tagName() const
     return QString::fromUtf8(gumbo_normalized_tagname(tag));
 }
 
+QLatin1String QGumboNode::tagNameView() const
+{
+    Q_ASSERT(ptr_);
+    return QLatin1String(gumbo_normalized_tagname(ptr_->v.element.tag));
+}
+
 QString QGumboNode::nodeName() const
 {
     return tagName();
@@ -423,6 +478,25 @@ QString QGumboNode::id() const
     return QString();
 }
 
+QLatin1String QGumboNode::idView() const
+{
+    return attributeView(ID_ATTRIBUTE);
+}
+
+QLatin1String QGumboNode::classView() const
+{
+    return attributeView(CLASS_ATTRIBUTE);
+}
+
+bool QGumboNode::hasClass(const char* className) const
+{
+    if (!className || !*className)
+        throw std::invalid_argument("class name can't be empty string");
+
+    GumboAttribute* attr = gumbo_get_attribute(&ptr_->v.element.attributes, CLASS_ATTRIBUTE);
+    return attr && containsClass(attr->value, className, static_cast<int>(qstrlen(className)));
+}
+
 QStringList QGumboNode::classList() const
 {
     GumboAttribute* attr = gumbo_get_attribute(&ptr_->v.element.attributes, CLASS_ATTRIBUTE);
@@ -484,6 +558,18 @@ QString QGumboNode::getAttribute(const QString& attrName) const
     return QString();
 }
 
+QLatin1String QGumboNode::attributeView(const char* attrName) const
+{
+    if (!attrName || !*attrName)
+        throw std::invalid_argument("attribute name can't be empty string");
+
+    GumboAttribute* attr = gumbo_get_attribute(&ptr_->v.element.attributes, attrName);
+    if (attr)
+        return QLatin1String(attr->value);
+
+    return QLatin1String();
+}
+
 QString QGumboNode::getByLine(QString matchString) const
 {
     QString byLine;
@@ -522,19 +608,26 @@ void QGumboNode::forEach(std::function<void(const QGumboNode&)> func) const
 {
     Q_ASSERT(ptr_);
 
-    auto functor = [&func](GumboNode* node) {
-        func(QGumboNode(node));
+    QGumboTextCache* textCache = textCache_;
+    auto functor = [&func, textCache](GumboNode* node) {
+        func(QGumboNode(node, textCache));
         return false;
     };
 
     iterateTree(ptr_, functor);
 }
 
-bool QGumboNode::operator ==(const QGumboNode &other)
+bool QGumboNode::operator ==(const QGumboNode &other) const
 {
     return this->ptr_ == other.ptr_;
 }
 
+uint qHash(const QGumboNode &node, uint seed)
+{
+    // Nodes are identified by the underlying Gumbo node, no need to look at the content
+    return qHash(node.ptr_, seed);
+}
+
 QGumboNode::operator bool() const
 {
     return ptr_;
@@ -7,16 +7,19 @@
 #include "HtmlTag.h"
 #include <QVariantList>
 #include <QVariantMap>
-#include <QCryptographicHash>
+#include <QHash>
+#include <QLatin1String>
 
 class QString;
 class QGumboNode;
 class QGumboAttribute;
 class QGumboDocument;
+class QGumboSelector;
 class QStringList;
 
 typedef std::vector<QGumboNode> 		QGumboNodes;
 typedef std::vector<QGumboAttribute> 	QGumboAttributes;
+typedef QHash<const GumboNode*, QString> QGumboTextCache;
 
 class QGumboNode
 {
@@ -27,15 +30,23 @@ public:
 
     HtmlTag tag() const;
     QString tagName() const;
+    QLatin1String tagNameView() const;
     QString nodeName() const;
 
     QString id() const;
     QStringList classList() const;
 
+    // Views on Gumbo's own UTF-8 buffers, valid as long as the document lives. Meant for comparisons without copying.
+    QLatin1String idView() const;
+    QLatin1String classView() const;
+    QLatin1String attributeView(const char* attrName) const;
+    bool hasClass(const char* className) const;
+
     QGumboNodes getElementById(const QString&) const;
     QGumboNodes getElementsByTagName(HtmlTag) const;
     QGumboNodes getElementsByClassName(const QString&) const;
-    QGumboNodes getAllElementsForExtractor() const;
+    QGumboNodes querySelectorAll(const QString& selector) const;
+    QGumboNodes querySelectorAll(const QGumboSelector& selector) const;
     QGumboNodes childNodes() const;
     QGumboNodes children() const;
     QGumboNodes ancestors(const int &maxDepth = 0) const;
@@ -52,7 +63,8 @@ public:
     QVariantMap getStyles() const;
 
     QString innerText(const bool &normalize = false) const;
-    QString hash() const;
+    int innerTextLength(int *commaCount = nullptr) const;
+    QString textContent() const;
     QString outerHtml() const;
     QString getAttribute(const QString&) const;
     QString getByLine(QString matchString) const;
@@ -62,17 +74,23 @@ public:
     void forEach(std::function<void(const QGumboNode&)>) const;
 
     explicit operator bool() const;
-    bool operator ==(const QGumboNode &other);
+    bool operator ==(const QGumboNode &other) const;
+
+    friend uint qHash(const QGumboNode &node, uint seed);
 
 private:
     QGumboNode();
-    QGumboNode(GumboNode* node);
+    QGumboNode(GumboNode* node, QGumboTextCache* textCache = nullptr);
 
     friend class QGumboDocument;
+    friend class QGumboSelector;
 private:
     GumboNode* ptr_;
+    QGumboTextCache* textCache_ = nullptr;
     QVariantMap additionalAttributes_;
 
 };
 
+uint qHash(const QGumboNode &node, uint seed = 0);
+
 #endif // QGUMBONODE_H
@@ -0,0 +1,225 @@
+#include <cctype>
+#include <stdexcept>
+#include <QString>
+#include "qgumboselector.h"
+#include "qgumbonode.h"
+
+namespace {
+
+bool isIdentifierCharacter(char character)
+{
+    const unsigned char value = static_cast<unsigned char>(character);
+    return std::isalnum(value) || character == '-' || character == '_' || value >= 0x80;
+}
+
+bool skipWhitespace(const char*& current)
+{
+    const char* start = current;
+    while (*current && std::isspace(static_cast<unsigned char>(*current)))
+        ++current;
+    return current != start;
+}
+
+QByteArray readIdentifier(const char*& current)
+{
+    const char* start = current;
+    while (isIdentifierCharacter(*current))
+        ++current;
+    if (current == start)
+        throw std::invalid_argument("selector: identifier expected");
+    return QByteArray(start, current - start);
+}
+
+QByteArray readValue(const char*& current)
+{
+    const char quote = *current;
+    if (quote != '"' && quote != '\'')
+        return readIdentifier(current);
+
+    const char* start = ++current;
+    while (*current && *current != quote)
+        ++current;
+    if (!*current)
+        throw std::invalid_argument("selector: unterminated string");
+    return QByteArray(start, current++ - start);
+}
+
+} /* namespace */
+
+QGumboSelector QGumboSelector::compile(const QString& selector)
+{
+    QGumboSelector compiled;
+    const QByteArray utf8Selector = selector.toUtf8();
+    const char* current = utf8Selector.constData();
+
+    QVector<int> complex;
+    Combinator combinator = Combinator::None;
+    skipWhitespace(current);
+    while (true) {
+        const int compoundIndex = compiled.parseCompound(current, true);
+        compiled.compounds_[compoundIndex].combinator = combinator;
+        complex.append(compoundIndex);
+
+        const bool hadWhitespace = skipWhitespace(current);
+        if (*current == '\0' || *current == ',') {
+            compiled.selectors_.append(complex);
+            complex.clear();
+            if (*current == '\0')
+                break;
+            ++current;
+            skipWhitespace(current);
+            combinator = Combinator::None;
+        } else if (*current == '>') {
+            ++current;
+            skipWhitespace(current);
+            combinator = Combinator::Child;
+        } else if (hadWhitespace) {
+            combinator = Combinator::Descendant;
+        } else {
+            throw std::invalid_argument("selector: unexpected character");
+        }
+    }
+
+    return compiled;
+}
+
+int QGumboSelector::parseCompound(const char*& current, bool allowNegation)
+{
+    Compound compound;
+    bool empty = true;
+
+    if (*current == '*') {
+        ++current;
+        empty = false;
+    } else if (isIdentifierCharacter(*current)) {
+        compound.tagName = readIdentifier(current).toLower();
+        compound.tag = gumbo_tag_enum(compound.tagName.constData());
+        compound.anyTag = false;
+        empty = false;
+    }
+
+    while (true) {
+        if (*current == '#') {
+            ++current;
+            compound.ids.append(readIdentifier(current));
+        } else if (*current == '.') {
+            ++current;
+            compound.classes.append(readIdentifier(current));
+        } else if (*current == '[') {
+            ++current;
+            skipWhitespace(current);
+            AttributeCondition condition;
+            condition.name = readIdentifier(current).toLower();
+            condition.hasValue = false;
+            skipWhitespace(current);
+            if (*current == '=') {
+                ++current;
+                skipWhitespace(current);
+                condition.value = readValue(current);
+                condition.hasValue = true;
+                skipWhitespace(current);
+            }
+            if (*current != ']')
+                throw std::invalid_argument("selector: ']' expected");
+            ++current;
+            compound.attributes.append(condition);
+        } else if (qstrncmp(current, ":not(", 5) == 0) {
+            if (!allowNegation)
+                throw std::invalid_argument("selector: nested :not() is not supported");
+            current += 5;
+            skipWhitespace(current);
+            while (true) {
+                compound.negations.append(parseCompound(current, false));
+                skipWhitespace(current);
+                if (*current != ',')
+                    break;
+                ++current;
+                skipWhitespace(current);
+            }
+            if (*current != ')')
+                throw std::invalid_argument("selector: ')' expected");
+            ++current;
+        } else {
+            break;
+        }
+        empty = false;
+    }
+
+    if (empty)
+        throw std::invalid_argument("selector: selector expected");
+
+    compounds_.append(compound);
+    return compounds_.size() - 1;
+}
+
+bool QGumboSelector::matches(GumboNode* node) const
+{
+    for (const QVector<int>& selector : selectors_) {
+        if (matchesComplex(selector, selector.size() - 1, node))
+            return true;
+    }
+    return false;
+}
+
+bool QGumboSelector::matchesComplex(const QVector<int>& selector, int position, GumboNode* node) const
+{
+    // Evaluated from right to left, the rightmost compound is the most selective one in practice
+    const Compound& compound = compounds_.at(selector.at(position));
+    if (!matchesCompound(compound, node))
+        return false;
+    if (position == 0)
+        return true;
+
+    GumboNode* ancestor = node->parent;
+    if (compound.combinator == Combinator::Child)
+        return ancestor && ancestor->type == GUMBO_NODE_ELEMENT && matchesComplex(selector, position - 1, ancestor);
+
+    while (ancestor && ancestor->type == GUMBO_NODE_ELEMENT) {
+        if (matchesComplex(selector, position - 1, ancestor))
+            return true;
+        ancestor = ancestor->parent;
+    }
+    return false;
+}
+
+bool QGumboSelector::matchesCompound(const Compound& compound, GumboNode* node) const
+{
+    if (node->type != GUMBO_NODE_ELEMENT)
+        return false;
+
+    if (!compound.anyTag) {
+        if (node->v.element.tag != compound.tag)
+            return false;
+        if (compound.tag == GUMBO_TAG_UNKNOWN) {
+            GumboStringPiece originalTag = node->v.element.original_tag;
+            gumbo_tag_from_original_text(&originalTag);
+            if (static_cast<int>(originalTag.length) != compound.tagName.length() ||
+                    qstrnicmp(originalTag.data, compound.tagName.constData(), compound.tagName.length()) != 0)
+                return false;
+        }
+    }
+
+    const QGumboNode element(node);
+    for (const QByteArray& id : compound.ids) {
+        const QLatin1String nodeId = element.idView();
+        if (!nodeId.data() || qstricmp(nodeId.data(), id.constData()) != 0)
+            return false;
+    }
+    for (const QByteArray& className : compound.classes) {
+        if (!element.hasClass(className.constData()))
+            return false;
+    }
+    for (const AttributeCondition& condition : compound.attributes) {
+        const QLatin1String value = element.attributeView(condition.name.constData());
+        if (!value.data())
+            return false;
+        if (condition.hasValue && value != QLatin1String(condition.value.constData(), condition.value.length()))
+            return false;
+    }
+    for (int negation : compound.negations) {
+        if (matchesCompound(compounds_.at(negation), node))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef QGUMBOSELECTOR_H
+#define QGUMBOSELECTOR_H
+
+#include <QByteArray>
+#include <QVector>
+#include "gumbo-parser/src/gumbo.h"
+
+class QString;
+class QGumboNode;
+
+/*
+ * A CSS selector, compiled once and then matched against any number of nodes.
+ * Supported are type (tag and *), .class, #id, [attribute] and [attribute=value]
+ * selectors, :not() with a list of compound selectors, the descendant and child (>)
+ * combinators and comma separated selector groups.
+ */
+class QGumboSelector
+{
+public:
+    static QGumboSelector compile(const QString& selector);
+
+private:
+    QGumboSelector() = default;
+
+    enum class Combinator {
+        None,
+        Descendant,
+        Child
+    };
+
+    struct AttributeCondition {
+        QByteArray name;
+        QByteArray value;
+        bool hasValue;
+    };
+
+    struct Compound {
+        // Relation to the compound selector on the left
+        Combinator combinator = Combinator::None;
+        bool anyTag = true;
+        GumboTag tag = GUMBO_TAG_UNKNOWN;
+        QByteArray tagName;
+        QVector<QByteArray> ids;
+        QVector<QByteArray> classes;
+        QVector<AttributeCondition> attributes;
+        // Indexes of compounds in compounds_ which must not match
+        QVector<int> negations;
+    };
+
+    int parseCompound(const char*& current, bool allowNegation);
+
+    bool matches(GumboNode* node) const;
+    bool matchesComplex(const QVector<int>& selector, int position, GumboNode* node) const;
+    bool matchesCompound(const Compound& compound, GumboNode* node) const;
+
+    QVector<Compound> compounds_;
+    // Each selector of the group as indexes into compounds_, from left to right
+    QVector<QVector<int>> selectors_;
+
+    friend class QGumboNode;
+};
+
+#endif // QGUMBOSELECTOR_H
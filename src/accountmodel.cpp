@@ -17,13 +17,12 @@
     along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "accountmodel.h"
-#include "o1twitterglobals.h"
 #include "o0globals.h"
-#include "o0settingsstore.h"
 #include "o0requestparameter.h"
+#include "emojimatcher.h"
 
+#include <QElapsedTimer>
 #include <QFile>
-#include <QUuid>
 #include <QDir>
 #include <QStandardPaths>
 #include <QNetworkConfiguration>
@@ -37,16 +36,20 @@ const char SETTINGS_SECRET_IDENTITY_NAME[] = "settings/secretIdentityName";
 const char SETTINGS_DISPLAY_IMAGE_DESCRIPTIONS[] = "settings/displayImageDescriptions";
 const char SETTINGS_FONT_SIZE[] = "settings/fontSize";
 const char SETTINGS_LINK_PREVIEW_MODE[] = "settings/linkPreviewMode";
+const char SETTINGS_LINK_PREVIEW_BYTE_BUDGET[] = "settings/linkPreviewByteBudget";
+// Switching to an account which was active before shouldn't take longer
+const qint64 ACCOUNT_SWITCH_TARGET_MS = 50;
 
 AccountModel::AccountModel()
     : networkConfigurationManager(new QNetworkConfigurationManager(this))
-    , o1(new O1Twitter(this))
     , manager(new QNetworkAccessManager(this))
-    , locationInformation(new LocationInformation(this))
+    , activeSession(nullptr)
+    , twitterApi(nullptr)
+    , locationInformation(nullptr)
     //, wagnis(new Wagnis(manager, "harbour-piepmatz", "1.4", this))
-    , settings("harbour-piepmatz", "settings")
+    , accountSettings("harbour-piepmatz", "accounts")
 {
-    obtainEncryptionKey();
+    encryptionKey = AccountSession::obtainEncryptionKey();
     initializeEnvironment();
 }
 
@@ -59,21 +62,19 @@ QVariant AccountModel::data(const QModelIndex &index, int role) const {
 
 void AccountModel::initializeEnvironment()
 {
-    O0SettingsStore *settings = new O0SettingsStore(encryptionKey);
-    o1->setStore(settings);
-    o1->setClientId(TWITTER_CLIENT_ID);
-    o1->setClientSecret(TWITTER_CLIENT_SECRET);
-    connect(o1, &O1Twitter::pinRequestError, this, &AccountModel::handlePinRequestError);
-    connect(o1, &O1Twitter::pinRequestSuccessful, this, &AccountModel::handlePinRequestSuccessful);
-    connect(o1, &O1Twitter::linkingFailed, this, &AccountModel::handleLinkingFailed);
-    connect(o1, &O1Twitter::linkingSucceeded, this, &AccountModel::handleLinkingSucceeded);
-
-    readOtherAccounts();
-    requestor = new O1Requestor(manager, o1, this);
-    this->initializeSecretIdentity();
+    migrateAccounts();
+    QString activeAccount = accountSettings.value(ACCOUNTS_ACTIVE_ACCOUNT).toString();
+    AccountSession *session;
+    if (!activeAccount.isEmpty() && QDir(AccountSession::getAccountsConfigDirectory() + "/" + activeAccount).exists()) {
+        session = getSession(activeAccount);
+    } else {
+        session = new AccountSession(QString(), encryptionKey, manager, this);
+    }
 
-    //twitterApi = new TwitterApi(requestor, manager, wagnis, this);
-    twitterApi = new TwitterApi(requestor, manager, secretIdentityRequestor, this);
+    //twitterApi = new TwitterApi(session->getRequestor(), session->getSettings(), manager, wagnis, this);
+    twitterApi = new TwitterApi(session->getRequestor(), session->getSettings(), manager, secretIdentityRequestor, this);
+    locationInformation = new LocationInformation(session->getSettings(), this);
+    activateSession(session);
 
     connect(twitterApi, &TwitterApi::verifyCredentialsError, this, &AccountModel::handleVerifyCredentialsError);
     connect(twitterApi, &TwitterApi::verifyCredentialsSuccessful, this, &AccountModel::handleVerifyCredentialsSuccessful);
@@ -84,7 +85,7 @@ void AccountModel::initializeEnvironment()
 void AccountModel::obtainPinUrl()
 {
     if (networkConfigurationManager->isOnline()) {
-        o1->obtainPinUrl();
+        activeSession->getAuthenticator()->obtainPinUrl();
     } else {
         emit pinRequestError("I'm sorry, your device is offline!");
     }
@@ -94,7 +95,7 @@ void AccountModel::enterPin(const QString &pin)
 {
     qDebug() << "PIN entered: " + pin;
     if (networkConfigurationManager->isOnline()) {
-        o1->verifyPin(pin);
+        activeSession->getAuthenticator()->verifyPin(pin);
     } else {
         emit linkingFailed("I'm sorry, your device is offline!");
     }
@@ -102,7 +103,7 @@ void AccountModel::enterPin(const QString &pin)
 
 bool AccountModel::isLinked()
 {
-    return o1->linked();
+    return activeSession->isLinked();
 }
 
 void AccountModel::verifyCredentials()
@@ -112,7 +113,7 @@ void AccountModel::verifyCredentials()
 
 void AccountModel::unlink()
 {
-    o1->unlink();
+    activeSession->getAuthenticator()->unlink();
 }
 
 QVariantMap AccountModel::getCurrentAccount()
@@ -129,125 +130,137 @@ QVariantList AccountModel::getOtherAccounts()
 void AccountModel::registerNewAccount()
 {
     qDebug() << "AccountModel::registerNewAccount";
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz.conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz-" + this->availableAccounts.value(0).value("screen_name").toString() + ".conf");
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings.conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings-" + this->availableAccounts.value(0).value("screen_name").toString() + ".conf");
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache.db", QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache-" + this->availableAccounts.value(0).value("screen_name").toString() + ".db");
+    // A new account starts with the default settings
+    if (activeSession->getScreenName().isEmpty()) {
+        activeSession->remove();
+        activateSession(activeSession);
+    } else {
+        activateSession(new AccountSession(QString(), encryptionKey, manager, this));
+    }
     emit accountSwitched();
-    this->initializeEnvironment();
 }
 
 void AccountModel::removeCurrentAccount()
 {
     qDebug() << "AccountModel::removeCurrentAccount";
-    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz.conf");
-    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings.conf");
-    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache.db");
+    AccountSession *removedSession = activeSession;
+    removedSession->remove();
     if (!this->otherAccounts.isEmpty()) {
         // We also move to another account...
-        QString newAccountName = this->otherAccounts.value(0).toString();
-        QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz-" + newAccountName + ".conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz.conf");
-        QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings-" + newAccountName + ".conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings.conf");
-        QFile::rename(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache-" + newAccountName + ".db", QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache.db");
+        activateSession(getSession(this->otherAccounts.value(0).toString()));
+    } else if (!removedSession->getScreenName().isEmpty()) {
+        activateSession(new AccountSession(QString(), encryptionKey, manager, this));
+    }
+    if (!removedSession->getScreenName().isEmpty()) {
+        sessions.remove(removedSession->getScreenName());
+        removedSession->deleteLater();
     }
     emit accountSwitched();
-    this->initializeEnvironment();
 }
 
 void AccountModel::switchAccount(const QString &newAccountName)
 {
     qDebug() << "AccountModel::switchAccount" << newAccountName;
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz.conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz-" + this->availableAccounts.value(0).value("screen_name").toString() + ".conf");
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings.conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings-" + this->availableAccounts.value(0).value("screen_name").toString() + ".conf");
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache.db", QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache-" + this->availableAccounts.value(0).value("screen_name").toString() + ".db");
-
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz-" + newAccountName + ".conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz.conf");
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings-" + newAccountName + ".conf", QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/settings.conf");
-    QFile::rename(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache-" + newAccountName + ".db", QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz/cache.db");
+    if (newAccountName == activeSession->getScreenName()) {
+        return;
+    }
+    QElapsedTimer switchTimer;
+    switchTimer.start();
+    // Both sessions stay as they are, the new one only becomes the active one
+    activateSession(getSession(newAccountName));
     emit accountSwitched();
-    this->initializeEnvironment();
-
+    const qint64 switchTime = switchTimer.elapsed();
+    qDebug() << "Switched to account" << newAccountName << "in" << switchTime << "ms";
+    if (switchTime > ACCOUNT_SWITCH_TARGET_MS) {
+        qWarning() << "AccountModel::switchAccount: Switching took longer than" << ACCOUNT_SWITCH_TARGET_MS << "ms";
+    }
 }
 
 QString AccountModel::getImagePath()
 {
-    return settings.value(SETTINGS_IMAGE_PATH, QString()).toString();
+    return activeSession->getSettings()->value(SETTINGS_IMAGE_PATH, QString()).toString();
 }
 
 void AccountModel::setImagePath(const QString &imagePath)
 {
-    settings.setValue(SETTINGS_IMAGE_PATH, imagePath);
+    activeSession->getSettings()->setValue(SETTINGS_IMAGE_PATH, imagePath);
     emit imageStyleChanged();
 }
 
 bool AccountModel::getUseEmoji()
 {
-    return settings.value(SETTINGS_USE_EMOJI, true).toBool();
+    return activeSession->getSettings()->value(SETTINGS_USE_EMOJI, true).toBool();
 }
 
 void AccountModel::setUseEmoji(const bool &useEmoji)
 {
-    settings.setValue(SETTINGS_USE_EMOJI, useEmoji);
+    activeSession->getSettings()->setValue(SETTINGS_USE_EMOJI, useEmoji);
+}
+
+QString AccountModel::emojify(const QString &text, const int &emojiSize)
+{
+    return EmojiMatcher::getInstance().emojify(text, emojiSize, getUseEmoji());
 }
 
 bool AccountModel::getUseLoadingAnimations()
 {
-    return settings.value(SETTINGS_USE_LOADING_ANIMATIONS, true).toBool();
+    return activeSession->getSettings()->value(SETTINGS_USE_LOADING_ANIMATIONS, true).toBool();
 }
 
 void AccountModel::setUseLoadingAnimations(const bool &useAnimations)
 {
-    settings.setValue(SETTINGS_USE_LOADING_ANIMATIONS, useAnimations);
+    activeSession->getSettings()->setValue(SETTINGS_USE_LOADING_ANIMATIONS, useAnimations);
 }
 
 bool AccountModel::getUseSwipeNavigation()
 {
-    return settings.value(SETTINGS_USE_SWIPE_NAVIGATION, true).toBool();
+    return activeSession->getSettings()->value(SETTINGS_USE_SWIPE_NAVIGATION, true).toBool();
 }
 
 void AccountModel::setUseSwipeNavigation(const bool &useSwipeNavigation)
 {
-    settings.setValue(SETTINGS_USE_SWIPE_NAVIGATION, useSwipeNavigation);
+    activeSession->getSettings()->setValue(SETTINGS_USE_SWIPE_NAVIGATION, useSwipeNavigation);
     emit swipeNavigationChanged();
 }
 
 bool AccountModel::getDisplayImageDescriptions()
 {
-    return settings.value(SETTINGS_DISPLAY_IMAGE_DESCRIPTIONS, true).toBool();
+    return activeSession->getSettings()->value(SETTINGS_DISPLAY_IMAGE_DESCRIPTIONS, true).toBool();
 }
 
 void AccountModel::setDisplayImageDescriptions(const bool &displayImageDescriptions)
 {
-    settings.setValue(SETTINGS_DISPLAY_IMAGE_DESCRIPTIONS, displayImageDescriptions);
+    activeSession->getSettings()->setValue(SETTINGS_DISPLAY_IMAGE_DESCRIPTIONS, displayImageDescriptions);
 }
 
 bool AccountModel::getUseSecretIdentity()
 {
-    return settings.value(SETTINGS_USE_SECRET_IDENTITY, false).toBool();
+    return activeSession->getSettings()->value(SETTINGS_USE_SECRET_IDENTITY, false).toBool();
 }
 
 void AccountModel::setUseSecretIdentity(const bool &useSecretIdentity)
 {
-    settings.setValue(SETTINGS_USE_SECRET_IDENTITY, useSecretIdentity);
+    activeSession->getSettings()->setValue(SETTINGS_USE_SECRET_IDENTITY, useSecretIdentity);
 }
 
 QString AccountModel::getSecretIdentityName()
 {
-    return settings.value(SETTINGS_SECRET_IDENTITY_NAME, "").toString();
+    return activeSession->getSettings()->value(SETTINGS_SECRET_IDENTITY_NAME, "").toString();
 }
 
 void AccountModel::setSecretIdentityName(const QString &secretIdentityName)
 {
-    settings.setValue(SETTINGS_SECRET_IDENTITY_NAME, secretIdentityName);
+    activeSession->getSettings()->setValue(SETTINGS_SECRET_IDENTITY_NAME, secretIdentityName);
 }
 
 QString AccountModel::getFontSize()
 {
-    return settings.value(SETTINGS_FONT_SIZE, "piepmatz").toString();
+    return activeSession->getSettings()->value(SETTINGS_FONT_SIZE, "piepmatz").toString();
 }
 
 void AccountModel::setFontSize(const QString &fontSize)
 {
-    settings.setValue(SETTINGS_FONT_SIZE, fontSize);
+    activeSession->getSettings()->setValue(SETTINGS_FONT_SIZE, fontSize);
     emit fontSizeChanged(fontSize);
 }
 
@@ -268,15 +281,26 @@ bool AccountModel::isWiFi()
 
 QString AccountModel::getLinkPreviewMode()
 {
-    return settings.value(SETTINGS_LINK_PREVIEW_MODE, "always").toString();
+    return activeSession->getSettings()->value(SETTINGS_LINK_PREVIEW_MODE, "always").toString();
 }
 
 void AccountModel::setLinkPreviewMode(const QString &linkPreviewMode)
 {
-    settings.setValue(SETTINGS_LINK_PREVIEW_MODE, linkPreviewMode);
+    activeSession->getSettings()->setValue(SETTINGS_LINK_PREVIEW_MODE, linkPreviewMode);
     emit linkPreviewModeChanged(linkPreviewMode);
 }
 
+qint64 AccountModel::getLinkPreviewByteBudget()
+{
+    return activeSession->getSettings()->value(SETTINGS_LINK_PREVIEW_BYTE_BUDGET, 0).toLongLong();
+}
+
+void AccountModel::setLinkPreviewByteBudget(const qint64 &byteBudget)
+{
+    activeSession->getSettings()->setValue(SETTINGS_LINK_PREVIEW_BYTE_BUDGET, byteBudget);
+    twitterApi->setLinkPreviewByteBudget(byteBudget);
+}
+
 bool AccountModel::hasSecretIdentity()
 {
     return this->secretIdentity;
@@ -287,6 +311,21 @@ TwitterApi *AccountModel::getTwitterApi()
     return this->twitterApi;
 }
 
+AccountSession *AccountModel::getActiveSession()
+{
+    return this->activeSession;
+}
+
+AccountSession *AccountModel::getSession(const QString &screenName)
+{
+    AccountSession *session = sessions.value(screenName);
+    if (session == nullptr) {
+        session = new AccountSession(screenName, encryptionKey, manager, this);
+        sessions.insert(screenName, session);
+    }
+    return session;
+}
+
 LocationInformation *AccountModel::getLocationInformation()
 {
     return this->locationInformation;
@@ -322,6 +361,20 @@ void AccountModel::handleLinkingSucceeded()
 
 void AccountModel::handleVerifyCredentialsSuccessful(const QVariantMap &result)
 {
+    QString screenName = result.value("screen_name").toString();
+    if (activeSession->getScreenName().isEmpty() && !screenName.isEmpty()) {
+        // Logged in (again) with an account, from now on it has its own directories
+        AccountSession *previousSession = sessions.take(screenName);
+        if (previousSession != nullptr) {
+            previousSession->deleteLater();
+        }
+        activeSession->adopt(screenName);
+        sessions.insert(screenName, activeSession);
+        // Directories and settings of the session have changed
+        activateSession(activeSession);
+    }
+    activeSession->setAccount(result);
+
     beginResetModel();
     availableAccounts.clear();
     availableAccounts.append(result);
@@ -340,72 +393,105 @@ void AccountModel::handleNetworkConfigurationChanged(const QNetworkConfiguration
     emit connectionTypeChanged(this->isWiFi());
 }
 
-void AccountModel::obtainEncryptionKey()
+void AccountModel::migrateAccounts()
 {
-    // We try to use the unique device ID as encryption key. If we can't determine this ID, a default key is used...
-    // Unique device ID determination copied from the QtSystems module of the Qt Toolkit
-    if (encryptionKey.isEmpty()) {
-        QFile file(QStringLiteral("/sys/devices/virtual/dmi/id/product_uuid"));
-        if (file.open(QIODevice::ReadOnly)) {
-            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
-            if (id.length() == 36) {
-                encryptionKey = id;
-            }
-            file.close();
+    // Accounts used to be switched by renaming their files, the inactive ones had the screen name in their file names
+    QString configPath = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz";
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz";
+    QDir configDirectory(configPath);
+    QStringList nameFilter("harbour-piepmatz-*.conf");
+    QStringList accountFiles = configDirectory.entryList(nameFilter);
+    QStringListIterator accountFilesIterator(accountFiles);
+    while (accountFilesIterator.hasNext()) {
+        QString accountFileName = accountFilesIterator.next();
+        QRegExp accountFileMatcher("harbour\\-piepmatz\\-([\\w]+)\\.conf");
+        if (accountFileMatcher.exactMatch(accountFileName)) {
+            QString screenName = accountFileMatcher.cap(1);
+            qDebug() << "Moving account to its own directory: " + screenName;
+            QString accountConfigPath = AccountSession::getAccountsConfigDirectory() + "/" + screenName;
+            QString accountDataPath = AccountSession::getAccountsDataDirectory() + "/" + screenName;
+            QDir().mkpath(accountConfigPath);
+            QDir().mkpath(accountDataPath);
+            QFile::rename(configPath + "/" + accountFileName, accountConfigPath + "/harbour-piepmatz.conf");
+            QFile::rename(configPath + "/settings-" + screenName + ".conf", accountConfigPath + "/settings.conf");
+            QFile::rename(dataPath + "/cache-" + screenName + ".db", accountDataPath + "/cache.db");
         }
     }
-    if (encryptionKey.isEmpty()) {
-        QFile file(QStringLiteral("/etc/machine-id"));
-        if (file.open(QIODevice::ReadOnly)) {
-            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
-            if (id.length() == 32) {
-                encryptionKey = id.insert(8,'-').insert(13,'-').insert(18,'-').insert(23,'-');
+
+    // The settings of the active account were kept in the common settings file, each account has its own now
+    QString activeAccount = accountSettings.value(ACCOUNTS_ACTIVE_ACCOUNT).toString();
+    QString activeAccountConfigPath = AccountSession::getAccountsConfigDirectory() + "/" + activeAccount;
+    if (!activeAccount.isEmpty() && QDir(activeAccountConfigPath).exists()) {
+        QSettings commonSettings(configPath + "/settings.conf", QSettings::IniFormat);
+        const QStringList keys = commonSettings.allKeys();
+        if (!keys.isEmpty()) {
+            qDebug() << "Moving settings to the directory of the active account: " + activeAccount;
+            QSettings activeAccountSettings(activeAccountConfigPath + "/settings.conf", QSettings::IniFormat);
+            for (const QString &key : keys) {
+                activeAccountSettings.setValue(key, commonSettings.value(key));
             }
-            file.close();
+            activeAccountSettings.sync();
+            commonSettings.clear();
         }
     }
-    if (encryptionKey.isEmpty()) {
-        QFile file(QStringLiteral("/etc/unique-id"));
-        if (file.open(QIODevice::ReadOnly)) {
-            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
-            if (id.length() == 32) {
-                encryptionKey = id.insert(8,'-').insert(13,'-').insert(18,'-').insert(23,'-');
-            }
-            file.close();
+}
+
+void AccountModel::activateSession(AccountSession *session)
+{
+    qDebug() << "AccountModel::activateSession" << session->getScreenName();
+    AccountSession *previousSession = this->activeSession;
+    if (previousSession != nullptr) {
+        disconnect(previousSession->getAuthenticator(), nullptr, this, nullptr);
+        previousSession->deactivate();
+        // Sessions which are not verified yet can't be switched back to
+        if (previousSession != session && previousSession->getScreenName().isEmpty()) {
+            previousSession->deleteLater();
         }
     }
-    if (encryptionKey.isEmpty()) {
-        QFile file(QStringLiteral("/var/lib/dbus/machine-id"));
-        if (file.open(QIODevice::ReadOnly)) {
-            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
-            if (id.length() == 32) {
-                encryptionKey = id.insert(8,'-').insert(13,'-').insert(18,'-').insert(23,'-');
-            }
-            file.close();
-        }
+    this->activeSession = session;
+    O1Twitter *o1 = session->getAuthenticator();
+    connect(o1, &O1Twitter::pinRequestError, this, &AccountModel::handlePinRequestError);
+    connect(o1, &O1Twitter::pinRequestSuccessful, this, &AccountModel::handlePinRequestSuccessful);
+    connect(o1, &O1Twitter::linkingFailed, this, &AccountModel::handleLinkingFailed);
+    connect(o1, &O1Twitter::linkingSucceeded, this, &AccountModel::handleLinkingSucceeded);
+
+    if (session->getScreenName().isEmpty()) {
+        accountSettings.remove(ACCOUNTS_ACTIVE_ACCOUNT);
+    } else {
+        accountSettings.setValue(ACCOUNTS_ACTIVE_ACCOUNT, session->getScreenName());
     }
-    QUuid uid(encryptionKey); //make sure this can be made into a valid QUUid
-    if (uid.isNull()) {
-         encryptionKey = QString(TWITTER_STORE_DEFAULT_ENCRYPTION_KEY);
+    readOtherAccounts();
+    // The secret identity is one of the other accounts and comes from the settings of the new account
+    initializeSecretIdentity();
+    twitterApi->setSecretIdentityRequestor(secretIdentityRequestor);
+    twitterApi->setDataDirectory(session->getDataDirectory());
+    twitterApi->setSettings(session->getSettings());
+    twitterApi->setLinkPreviewByteBudget(getLinkPreviewByteBudget());
+    twitterApi->setRequestor(session->getRequestor());
+    locationInformation->setSettings(session->getSettings());
+    session->activate(twitterApi);
+
+    beginResetModel();
+    availableAccounts.clear();
+    if (!session->getAccount().isEmpty()) {
+        availableAccounts.append(session->getAccount());
     }
-    qDebug() << "Using encryption key: " + encryptionKey;
+    endResetModel();
+    emit activeSessionChanged();
 }
 
 void AccountModel::readOtherAccounts()
 {
     qDebug() << "AccountModel::readOtherAccounts";
     this->otherAccounts.clear();
-    QString configPath = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz";
-    QDir configDirectory(configPath);
-    QStringList nameFilter("*.conf");
-    QStringList accountFiles = configDirectory.entryList(nameFilter);
-    QStringListIterator accountFilesIterator(accountFiles);
-    while (accountFilesIterator.hasNext()) {
-        QString accountFileName = accountFilesIterator.next();
-        QRegExp accountFileMatcher("harbour\\-piepmatz\\-([\\w]+)\\.conf");
-        if (accountFileMatcher.indexIn(accountFileName) != -1) {
-            qDebug() << "Found other account: " + accountFileMatcher.cap(1);
-            this->otherAccounts.append(accountFileMatcher.cap(1));
+    QDir accountsDirectory(AccountSession::getAccountsConfigDirectory());
+    QStringList accountDirectories = accountsDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    QStringListIterator accountDirectoriesIterator(accountDirectories);
+    while (accountDirectoriesIterator.hasNext()) {
+        QString screenName = accountDirectoriesIterator.next();
+        if (screenName != activeSession->getScreenName()) {
+            qDebug() << "Found other account: " + screenName;
+            this->otherAccounts.append(screenName);
         }
     }
 }
@@ -418,18 +504,10 @@ void AccountModel::initializeSecretIdentity()
     if (this->getUseSecretIdentity()) {
         QString secretIdentity = this->getSecretIdentityName();
         qDebug() << "Using secret identity " << secretIdentity;
-        QString accountFileName = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz/harbour-piepmatz-" + secretIdentity + ".conf";
-        qDebug() << "Using file name " << accountFileName;
-        QSettings *secretIdentitySettings = new QSettings(accountFileName, QSettings::IniFormat, this);
-        O0SettingsStore *secretIdentitySettingsStore = new O0SettingsStore(secretIdentitySettings, encryptionKey, this);
-        O1Twitter *o1SecretIdentity = new O1Twitter(this);
-        o1SecretIdentity->setStore(secretIdentitySettingsStore);
-        o1SecretIdentity->setClientId(TWITTER_CLIENT_ID);
-        o1SecretIdentity->setClientSecret(TWITTER_CLIENT_SECRET);
-        if (o1SecretIdentity->linked()) {
+        if (!secretIdentity.isEmpty() && this->otherAccounts.contains(secretIdentity) && getSession(secretIdentity)->isLinked()) {
             qDebug() << "Secret identity successfully initialized!";
-            secretIdentityRequestor = new O1Requestor(manager, o1SecretIdentity, this);
-            secretIdentity = true;
+            secretIdentityRequestor = getSession(secretIdentity)->getRequestor();
+            this->secretIdentity = true;
         } else {
             qDebug() << "ERROR initializing secret identity!";
         }
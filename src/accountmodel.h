@@ -26,8 +26,10 @@
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QSettings>
+#include <QMap>
 #include "o1twitter.h"
 #include "o1requestor.h"
+#include "accountsession.h"
 #include "twitterapi.h"
 #include "locationinformation.h"
 //#include "wagnis/wagnis.h"
@@ -55,6 +57,7 @@ public:
     Q_INVOKABLE void setImagePath(const QString &imagePath);
     Q_INVOKABLE bool getUseEmoji();
     Q_INVOKABLE void setUseEmoji(const bool &useEmoji);
+    Q_INVOKABLE QString emojify(const QString &text, const int &emojiSize);
     Q_INVOKABLE bool getUseLoadingAnimations();
     Q_INVOKABLE void setUseLoadingAnimations(const bool &useAnimations);
     Q_INVOKABLE bool getUseSwipeNavigation();
@@ -70,10 +73,16 @@ public:
     Q_INVOKABLE bool isWiFi();
     Q_INVOKABLE QString getLinkPreviewMode();
     Q_INVOKABLE void setLinkPreviewMode(const QString &linkPreviewMode);
+    // Bytes which link previews may download per timeline refresh, 0 means no limit
+    Q_INVOKABLE qint64 getLinkPreviewByteBudget();
+    Q_INVOKABLE void setLinkPreviewByteBudget(const qint64 &byteBudget);
     Q_INVOKABLE bool hasSecretIdentity();
 
     TwitterApi *getTwitterApi();
     LocationInformation *getLocationInformation();
+    AccountSession *getActiveSession();
+    // Sessions of inactive accounts stay available, e.g. for polling them in the background
+    AccountSession *getSession(const QString &screenName);
     //Wagnis *getWagnis();
 
 signals:
@@ -86,6 +95,8 @@ signals:
     void imageStyleChanged();
     void swipeNavigationChanged();
     void accountSwitched();
+    // Another session became active or the active one was adopted, its models replace the previous ones
+    void activeSessionChanged();
     void fontSizeChanged(const QString &fontSize);
     void connectionTypeChanged(const bool &isWifi);
     void linkPreviewModeChanged(const QString &linkPreviewMode);
@@ -103,19 +114,20 @@ private:
     QList<QVariantMap> availableAccounts;
     QNetworkConfigurationManager * const networkConfigurationManager;
     QString encryptionKey;
-    O1Twitter * const o1;
     QNetworkAccessManager * const manager;
-    O1Requestor *requestor;
+    QMap<QString, AccountSession *> sessions;
+    AccountSession *activeSession;
     TwitterApi *twitterApi;
-    LocationInformation * const locationInformation;
+    LocationInformation *locationInformation;
     //Wagnis * const wagnis;
-    QSettings settings;
+    QSettings accountSettings;
     QVariantList otherAccounts;
     bool secretIdentity;
     O1Requestor *secretIdentityRequestor = nullptr;
 
-    void obtainEncryptionKey();
     void initializeEnvironment();
+    void migrateAccounts();
+    void activateSession(AccountSession *session);
     void readOtherAccounts();
     void initializeSecretIdentity();
 
@@ -0,0 +1,314 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "accountsession.h"
+#include "o1twitterglobals.h"
+#include "o0settingsstore.h"
+#include "timelinemodel.h"
+#include "mentionsmodel.h"
+#include "mergedtimelinemodel.h"
+#include "ownlistsmodel.h"
+#include "membershiplistsmodel.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QUuid>
+
+namespace {
+
+const char CREDENTIALS_FILE_NAME[] = "/harbour-piepmatz.conf";
+const char SETTINGS_FILE_NAME[] = "/settings.conf";
+
+QString getBaseConfigDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/harbour-piepmatz";
+}
+
+QString getBaseDataDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz";
+}
+
+}
+
+AccountSession::AccountSession(const QString &screenName, const QString &encryptionKey, QNetworkAccessManager *manager, QObject *parent)
+    : QObject(parent)
+    , screenName(screenName)
+    , encryptionKey(encryptionKey)
+    , authenticator(new O1Twitter(this))
+    , timelineModel(nullptr)
+    , mentionsModel(nullptr)
+    , mergedTimelineModel(nullptr)
+    , ownListsModel(nullptr)
+    , membershipListsModel(nullptr)
+{
+    qDebug() << "AccountSession::AccountSession" << screenName;
+    QDir().mkpath(getConfigDirectory());
+    QDir().mkpath(getDataDirectory());
+    setStore(new QSettings(getConfigDirectory() + CREDENTIALS_FILE_NAME, QSettings::IniFormat));
+    settings = new QSettings(getConfigDirectory() + SETTINGS_FILE_NAME, QSettings::IniFormat, this);
+    authenticator->setClientId(TWITTER_CLIENT_ID);
+    authenticator->setClientSecret(TWITTER_CLIENT_SECRET);
+    requestor = new O1Requestor(manager, authenticator, this);
+}
+
+QString AccountSession::getScreenName() const
+{
+    return this->screenName;
+}
+
+QString AccountSession::getConfigDirectory() const
+{
+    return screenName.isEmpty() ? getBaseConfigDirectory() : getAccountsConfigDirectory() + "/" + screenName;
+}
+
+QString AccountSession::getDataDirectory() const
+{
+    return screenName.isEmpty() ? getBaseDataDirectory() : getAccountsDataDirectory() + "/" + screenName;
+}
+
+O1Twitter *AccountSession::getAuthenticator() const
+{
+    return this->authenticator;
+}
+
+O1Requestor *AccountSession::getRequestor() const
+{
+    return this->requestor;
+}
+
+bool AccountSession::isLinked() const
+{
+    return authenticator->linked();
+}
+
+QSettings *AccountSession::getSettings() const
+{
+    return this->settings;
+}
+
+TimelineModel *AccountSession::getTimelineModel() const
+{
+    return this->timelineModel;
+}
+
+MentionsModel *AccountSession::getMentionsModel() const
+{
+    return this->mentionsModel;
+}
+
+MergedTimelineModel *AccountSession::getMergedTimelineModel() const
+{
+    return this->mergedTimelineModel;
+}
+
+OwnListsModel *AccountSession::getOwnListsModel() const
+{
+    return this->ownListsModel;
+}
+
+MembershipListsModel *AccountSession::getMembershipListsModel() const
+{
+    return this->membershipListsModel;
+}
+
+void AccountSession::activate(TwitterApi *twitterApi)
+{
+    qDebug() << "AccountSession::activate" << screenName;
+    if (timelineModel == nullptr) {
+        timelineModel = new TimelineModel(twitterApi, this);
+        timelineModel->setParent(this);
+        mentionsModel = new MentionsModel(twitterApi, this);
+        mentionsModel->setParent(this);
+        mergedTimelineModel = new MergedTimelineModel(twitterApi, this);
+        mergedTimelineModel->setParent(this);
+        ownListsModel = new OwnListsModel(twitterApi);
+        ownListsModel->setParent(this);
+        membershipListsModel = new MembershipListsModel(twitterApi);
+        membershipListsModel->setParent(this);
+    }
+    timelineModel->setActive(true);
+    mentionsModel->setActive(true);
+    mergedTimelineModel->setActive(true);
+    ownListsModel->setActive(true);
+    membershipListsModel->setActive(true);
+}
+
+void AccountSession::deactivate()
+{
+    qDebug() << "AccountSession::deactivate" << screenName;
+    if (timelineModel == nullptr) {
+        return;
+    }
+    timelineModel->setActive(false);
+    mentionsModel->setActive(false);
+    mergedTimelineModel->setActive(false);
+    ownListsModel->setActive(false);
+    membershipListsModel->setActive(false);
+}
+
+QVariantMap AccountSession::getAccount() const
+{
+    return this->account;
+}
+
+void AccountSession::setAccount(const QVariantMap &account)
+{
+    this->account = account;
+}
+
+void AccountSession::adopt(const QString &screenName)
+{
+    qDebug() << "AccountSession::adopt" << screenName;
+    if (!this->screenName.isEmpty()) {
+        return;
+    }
+    this->screenName = screenName;
+    QDir().mkpath(getConfigDirectory());
+    QDir().mkpath(getDataDirectory());
+    QSettings *accountCredentials = new QSettings(getConfigDirectory() + CREDENTIALS_FILE_NAME, QSettings::IniFormat);
+    accountCredentials->clear();
+    const QStringList keys = credentials->allKeys();
+    for (const QString &key : keys) {
+        accountCredentials->setValue(key, credentials->value(key));
+    }
+    accountCredentials->sync();
+    credentials->clear();
+    credentials->sync();
+    setStore(accountCredentials);
+
+    // Settings which the account already has from an earlier login are kept
+    QSettings *accountSettings = new QSettings(getConfigDirectory() + SETTINGS_FILE_NAME, QSettings::IniFormat, this);
+    const QStringList settingsKeys = settings->allKeys();
+    for (const QString &key : settingsKeys) {
+        if (!accountSettings->contains(key)) {
+            accountSettings->setValue(key, settings->value(key));
+        }
+    }
+    accountSettings->sync();
+    settings->clear();
+    settings->sync();
+    // The models and the TwitterApi still use the previous settings until the session is activated again
+    settings->deleteLater();
+    settings = accountSettings;
+    deleteModels();
+}
+
+void AccountSession::remove()
+{
+    qDebug() << "AccountSession::remove" << screenName;
+    credentials->clear();
+    credentials->sync();
+    settings->clear();
+    settings->sync();
+    if (!screenName.isEmpty()) {
+        QDir(getConfigDirectory()).removeRecursively();
+        QDir(getDataDirectory()).removeRecursively();
+    }
+}
+
+QString AccountSession::obtainEncryptionKey()
+{
+    QString encryptionKey;
+    // We try to use the unique device ID as encryption key. If we can't determine this ID, a default key is used...
+    // Unique device ID determination copied from the QtSystems module of the Qt Toolkit
+    if (encryptionKey.isEmpty()) {
+        QFile file(QStringLiteral("/sys/devices/virtual/dmi/id/product_uuid"));
+        if (file.open(QIODevice::ReadOnly)) {
+            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
+            if (id.length() == 36) {
+                encryptionKey = id;
+            }
+            file.close();
+        }
+    }
+    if (encryptionKey.isEmpty()) {
+        QFile file(QStringLiteral("/etc/machine-id"));
+        if (file.open(QIODevice::ReadOnly)) {
+            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
+            if (id.length() == 32) {
+                encryptionKey = id.insert(8,'-').insert(13,'-').insert(18,'-').insert(23,'-');
+            }
+            file.close();
+        }
+    }
+    if (encryptionKey.isEmpty()) {
+        QFile file(QStringLiteral("/etc/unique-id"));
+        if (file.open(QIODevice::ReadOnly)) {
+            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
+            if (id.length() == 32) {
+                encryptionKey = id.insert(8,'-').insert(13,'-').insert(18,'-').insert(23,'-');
+            }
+            file.close();
+        }
+    }
+    if (encryptionKey.isEmpty()) {
+        QFile file(QStringLiteral("/var/lib/dbus/machine-id"));
+        if (file.open(QIODevice::ReadOnly)) {
+            QString id = QString::fromLocal8Bit(file.readAll().simplified().data());
+            if (id.length() == 32) {
+                encryptionKey = id.insert(8,'-').insert(13,'-').insert(18,'-').insert(23,'-');
+            }
+            file.close();
+        }
+    }
+    QUuid uid(encryptionKey); //make sure this can be made into a valid QUUid
+    if (uid.isNull()) {
+         encryptionKey = QString(TWITTER_STORE_DEFAULT_ENCRYPTION_KEY);
+    }
+    qDebug() << "Using encryption key: " + encryptionKey;
+    return encryptionKey;
+}
+
+QString AccountSession::getAccountsConfigDirectory()
+{
+    return getBaseConfigDirectory() + "/accounts";
+}
+
+QString AccountSession::getAccountsDataDirectory()
+{
+    return getBaseDataDirectory() + "/accounts";
+}
+
+void AccountSession::setStore(QSettings *credentials)
+{
+    // The store takes ownership of the settings and the authenticator of the store
+    this->credentials = credentials;
+    authenticator->setStore(new O0SettingsStore(credentials, encryptionKey));
+}
+
+void AccountSession::deleteModels()
+{
+    if (timelineModel == nullptr) {
+        return;
+    }
+    deactivate();
+    // They may still be shown until the models of the next activation replace them
+    timelineModel->deleteLater();
+    mentionsModel->deleteLater();
+    mergedTimelineModel->deleteLater();
+    ownListsModel->deleteLater();
+    membershipListsModel->deleteLater();
+    timelineModel = nullptr;
+    mentionsModel = nullptr;
+    mergedTimelineModel = nullptr;
+    ownListsModel = nullptr;
+    membershipListsModel = nullptr;
+}
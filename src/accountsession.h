@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ACCOUNTSESSION_H
+#define ACCOUNTSESSION_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QSettings>
+#include <QVariantMap>
+#include "o1twitter.h"
+#include "o1requestor.h"
+
+// Key in accounts.conf with the screen name of the account which is active in the app
+const char ACCOUNTS_ACTIVE_ACCOUNT[] = "activeAccount";
+
+class TwitterApi;
+class TimelineModel;
+class MentionsModel;
+class MergedTimelineModel;
+class OwnListsModel;
+class MembershipListsModel;
+
+/*
+ * Everything which belongs to one account and stays in memory while the app runs: the
+ * credentials, the settings, the authenticator, the requestor and the models of its
+ * timelines, mentions and lists. Each account has its own directories for configuration
+ * and data, named after its screen name. A session without a screen name is an account
+ * which is not verified yet, its credentials and settings are kept in the main configuration
+ * directory until it is adopted under its screen name.
+ *
+ * All sessions share one TwitterApi, which only ever requests data for the active session.
+ * The models are created when a session is activated for the first time and keep their
+ * content while another account is active, but only the models of the active session are
+ * connected to the TwitterApi.
+ */
+class AccountSession : public QObject
+{
+    Q_OBJECT
+public:
+    AccountSession(const QString &screenName, const QString &encryptionKey, QNetworkAccessManager *manager, QObject *parent = nullptr);
+
+    QString getScreenName() const;
+    QString getConfigDirectory() const;
+    QString getDataDirectory() const;
+    O1Twitter *getAuthenticator() const;
+    O1Requestor *getRequestor() const;
+    bool isLinked() const;
+    // Settings of the account, settings.conf in its configuration directory
+    QSettings *getSettings() const;
+
+    TimelineModel *getTimelineModel() const;
+    MentionsModel *getMentionsModel() const;
+    MergedTimelineModel *getMergedTimelineModel() const;
+    OwnListsModel *getOwnListsModel() const;
+    MembershipListsModel *getMembershipListsModel() const;
+    // Connects the models to the TwitterApi, they are created on the first activation
+    void activate(TwitterApi *twitterApi);
+    void deactivate();
+
+    // Last verified user object of the account
+    QVariantMap getAccount() const;
+    void setAccount(const QVariantMap &account);
+
+    // Moves the credentials and settings of an unverified session to the directory of its screen name,
+    // the models are created again on the next activation
+    void adopt(const QString &screenName);
+    // Removes the credentials, the settings and the directories of the account
+    void remove();
+
+    // Unique device ID if available, used to encrypt the credentials
+    static QString obtainEncryptionKey();
+    static QString getAccountsConfigDirectory();
+    static QString getAccountsDataDirectory();
+
+private:
+    QString screenName;
+    QString encryptionKey;
+    QSettings *credentials;
+    QSettings *settings;
+    O1Twitter *authenticator;
+    O1Requestor *requestor;
+    QVariantMap account;
+    TimelineModel *timelineModel;
+    MentionsModel *mentionsModel;
+    MergedTimelineModel *mergedTimelineModel;
+    OwnListsModel *ownListsModel;
+    MembershipListsModel *membershipListsModel;
+
+    void setStore(QSettings *credentials);
+    void deleteModels();
+};
+
+#endif // ACCOUNTSESSION_H
@@ -0,0 +1,136 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "articlecache.h"
+#include "opengraphcache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+
+const char ARTICLE_DATABASE_CONNECTION[] = "articles";
+// Articles are served from the cache right away, but checked with the server again after an hour
+const qint64 ARTICLE_REVALIDATION_SECONDS = 60 * 60;
+const qint64 ARTICLE_TTL_SECONDS = 30 * 24 * 60 * 60;
+
+ArticleCache::ArticleCache(QObject *parent) : QObject(parent)
+{
+    initializeDatabase();
+}
+
+ArticleCache::~ArticleCache()
+{
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(ARTICLE_DATABASE_CONNECTION);
+}
+
+bool ArticleCache::lookup(const QString &address, QVariantMap &article)
+{
+    if (!database.isOpen()) {
+        return false;
+    }
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("select title, byline, excerpt, site_name, content, etag, last_modified, fetched_at from articles where url = (:url)");
+    databaseQuery.bindValue(":url", OpenGraphCache::getCanonicalUrl(address));
+    if (!databaseQuery.exec() || !databaseQuery.next()) {
+        return false;
+    }
+    article.insert("url", address);
+    article.insert("title", databaseQuery.value(0).toString());
+    article.insert("byline", databaseQuery.value(1).toString());
+    article.insert("excerpt", databaseQuery.value(2).toString());
+    article.insert("siteName", databaseQuery.value(3).toString());
+    article.insert("content", databaseQuery.value(4).toString());
+    article.insert("etag", databaseQuery.value(5).toByteArray());
+    article.insert("lastModified", databaseQuery.value(6).toByteArray());
+    article.insert("fetchedAt", databaseQuery.value(7).toLongLong());
+    return true;
+}
+
+bool ArticleCache::needsRevalidation(const QVariantMap &article) const
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000 - article.value("fetchedAt").toLongLong() > ARTICLE_REVALIDATION_SECONDS;
+}
+
+void ArticleCache::insert(const QString &address, const QVariantMap &article, const QByteArray &etag, const QByteArray &lastModified)
+{
+    if (!database.isOpen()) {
+        return;
+    }
+    QString canonicalUrl = OpenGraphCache::getCanonicalUrl(address);
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("insert or replace into articles values((:url),(:title),(:byline),(:excerpt),(:site_name),(:content),(:etag),(:last_modified),(:fetched_at))");
+    databaseQuery.bindValue(":url", canonicalUrl);
+    databaseQuery.bindValue(":title", article.value("title").toString());
+    databaseQuery.bindValue(":byline", article.value("byline").toString());
+    databaseQuery.bindValue(":excerpt", article.value("excerpt").toString());
+    databaseQuery.bindValue(":site_name", article.value("siteName").toString());
+    databaseQuery.bindValue(":content", article.value("content").toString());
+    databaseQuery.bindValue(":etag", etag);
+    databaseQuery.bindValue(":last_modified", lastModified);
+    databaseQuery.bindValue(":fetched_at", QDateTime::currentMSecsSinceEpoch() / 1000);
+    if (!databaseQuery.exec()) {
+        qDebug() << "Error storing article " + canonicalUrl << databaseQuery.lastError().text();
+    }
+}
+
+void ArticleCache::touch(const QString &address)
+{
+    if (!database.isOpen()) {
+        return;
+    }
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("update articles set fetched_at = (:fetched_at) where url = (:url)");
+    databaseQuery.bindValue(":fetched_at", QDateTime::currentMSecsSinceEpoch() / 1000);
+    databaseQuery.bindValue(":url", OpenGraphCache::getCanonicalUrl(address));
+    if (!databaseQuery.exec()) {
+        qDebug() << "Error updating article " + address << databaseQuery.lastError().text();
+    }
+}
+
+void ArticleCache::initializeDatabase()
+{
+    qDebug() << "ArticleCache::initializeDatabase";
+    QString databaseDirectory = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz";
+    QDir().mkpath(databaseDirectory);
+    QString databaseFilePath = databaseDirectory + "/cache.db";
+    database = QSqlDatabase::addDatabase("QSQLITE", ARTICLE_DATABASE_CONNECTION);
+    database.setDatabaseName(databaseFilePath);
+    if (!database.open()) {
+        qDebug() << "Error opening SQLite database " + databaseFilePath + ", articles are not cached";
+        return;
+    }
+
+    QSqlQuery databaseQuery(database);
+    if (!database.tables().contains("articles")) {
+        if (databaseQuery.exec("create table articles (url text primary key, title text, byline text, excerpt text, site_name text, content text, etag text, last_modified text, fetched_at integer)")) {
+            qDebug() << "Articles table successfully created!";
+        } else {
+            qDebug() << "Error creating articles table!" << databaseQuery.lastError().text();
+        }
+    }
+    databaseQuery.prepare("delete from articles where fetched_at < (:expiry)");
+    databaseQuery.bindValue(":expiry", QDateTime::currentMSecsSinceEpoch() / 1000 - ARTICLE_TTL_SECONDS);
+    if (!databaseQuery.exec()) {
+        qDebug() << "Error removing expired articles!" << databaseQuery.lastError().text();
+    }
+}
@@ -0,0 +1,49 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ARTICLECACHE_H
+#define ARTICLECACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+#include <QSqlDatabase>
+
+// Keeps extracted reader mode articles in the cache database together with the validators of the page they came from
+class ArticleCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ArticleCache(QObject *parent = nullptr);
+    ~ArticleCache();
+
+    // The article contains the extracted fields as well as etag, lastModified and fetchedAt
+    bool lookup(const QString &address, QVariantMap &article);
+    bool needsRevalidation(const QVariantMap &article) const;
+    void insert(const QString &address, const QVariantMap &article, const QByteArray &etag, const QByteArray &lastModified);
+    // The page didn't change, the stored article counts as fresh again
+    void touch(const QString &address);
+
+private:
+    QSqlDatabase database;
+
+    void initializeDatabase();
+};
+
+#endif // ARTICLECACHE_H
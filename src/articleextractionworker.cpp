@@ -0,0 +1,60 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "articleextractionworker.h"
+#include "contentextractor.h"
+#include "htmlcharsetdecoder.h"
+
+#include "QGumboParser/qgumbodocument.h"
+#include "QGumboParser/qgumbonode.h"
+
+#include <QDebug>
+#include <stdexcept>
+
+ArticleExtractionWorker::ArticleExtractionWorker(const QString &address, const QByteArray &htmlDocument, const QString &contentType, const QByteArray &etag, const QByteArray &lastModified, const bool &revalidation, QObject *parent) : QThread(parent)
+{
+    this->address = address;
+    this->htmlDocument = htmlDocument;
+    this->contentType = contentType;
+    this->etag = etag;
+    this->lastModified = lastModified;
+    this->revalidation = revalidation;
+}
+
+void ArticleExtractionWorker::extractArticle()
+{
+    qDebug() << "ArticleExtractionWorker::extractArticle" << this->address;
+
+    QVariantMap article;
+    try {
+        HtmlCharsetDecoder charsetDecoder(this->contentType);
+        QByteArray utf8Document = charsetDecoder.decode(this->htmlDocument);
+        utf8Document.append(charsetDecoder.finish());
+        this->htmlDocument.clear();
+        QGumboDocument parsedResult = QGumboDocument::parse(utf8Document);
+        parsedResult.enableInnerTextCache();
+        QGumboNode root = parsedResult.rootNode();
+
+        ContentExtractor contentExtractor(nullptr, &root);
+        article = contentExtractor.parse();
+    } catch (const std::exception &exception) {
+        qWarning() << "Unable to extract article from" << this->address << exception.what();
+    }
+
+    emit articleExtracted(this->address, article, this->etag, this->lastModified, this->revalidation);
+}
@@ -0,0 +1,51 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ARTICLEEXTRACTIONWORKER_H
+#define ARTICLEEXTRACTIONWORKER_H
+
+#include <QThread>
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+// Runs the ContentExtractor on a downloaded page in the background
+class ArticleExtractionWorker : public QThread
+{
+    Q_OBJECT
+    void run() Q_DECL_OVERRIDE {
+        extractArticle();
+    }
+public:
+    ArticleExtractionWorker(const QString &address, const QByteArray &htmlDocument, const QString &contentType, const QByteArray &etag, const QByteArray &lastModified, const bool &revalidation, QObject *parent = 0);
+
+signals:
+    void articleExtracted(const QString &address, const QVariantMap &article, const QByteArray &etag, const QByteArray &lastModified, const bool &revalidation);
+
+private:
+    void extractArticle();
+
+    QString address;
+    QByteArray htmlDocument;
+    QString contentType;
+    QByteArray etag;
+    QByteArray lastModified;
+    bool revalidation;
+};
+
+#endif // ARTICLEEXTRACTIONWORKER_H
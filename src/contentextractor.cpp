@@ -18,10 +18,12 @@
 */
 
 #include "contentextractor.h"
+#include "keywordmatcher.h"
 
 #include <QRegularExpression>
 #include <QDebug>
-#include <QtMath>
+#include <QHash>
+#include <cctype>
 
 const char FLAG_STRIP_UNLIKELYS = 0x1;
 const char FLAG_WEIGHT_CLASSES =  0x2;
@@ -41,8 +43,64 @@ const int DEFAULT_N_TOP_CANDIDATES = 5;
 // The default number of chars an article must have in order to return a result
 const int DEFAULT_CHAR_THRESHOLD = 500;
 
-const QRegularExpression REGEXP_POSITIVE = QRegularExpression("/article|body|content|entry|hentry|h-entry|main|page|pagination|post|text|blog|story/i");
-const QRegularExpression REGEXP_NEGATIVE = QRegularExpression("/hidden|^hid$| hid$| hid |^hid |banner|combx|comment|com-|contact|foot|footer|footnote|gdpr|masthead|media|meta|outbrain|promo|related|scroll|share|shoutbox|sidebar|skyscraper|sponsor|shopping|tags|tool|widget/i");
+// Keywords in class names and IDs, all of them are looked up in a single pass over each identifier
+const uint KEYWORD_POSITIVE = 0x1;
+const uint KEYWORD_NEGATIVE = 0x2;
+const uint KEYWORD_UNLIKELY_CANDIDATE = 0x4;
+const uint KEYWORD_MAYBE_A_CANDIDATE = 0x8;
+
+const char * const UNLIKELY_CANDIDATE_KEYWORDS[] = { "-ad-", "ai2html", "banner", "breadcrumbs", "combx", "comment", "community", "cover-wrap", "disqus", "extra", "foot", "gdpr", "header", "legends", "menu", "related", "remark", "replies", "rss", "shoutbox", "sidebar", "skyscraper", "social", "sponsor", "supplemental", "ad-break", "agegate", "pagination", "pager", "popup", "yom-remote" };
+const char * const MAYBE_A_CANDIDATE_KEYWORDS[] = { "and", "article", "body", "column", "main", "shadow" };
+const char * const POSITIVE_KEYWORDS[] = { "article", "body", "content", "entry", "hentry", "h-entry", "main", "page", "pagination", "post", "text", "blog", "story" };
+// " hid " only matches the whole word hid
+const char * const NEGATIVE_KEYWORDS[] = { "hidden", " hid ", "banner", "combx", "comment", "com-", "contact", "foot", "footer", "footnote", "gdpr", "masthead", "media", "meta", "outbrain", "promo", "related", "scroll", "share", "shoutbox", "sidebar", "skyscraper", "sponsor", "shopping", "tags", "tool", "widget" };
+
+template<size_t N>
+void addKeywords(KeywordMatcher &keywordMatcher, const char * const (&keywords)[N], const uint &category)
+{
+    for (const char *keyword : keywords) {
+        keywordMatcher.addKeyword(keyword, category);
+    }
+}
+
+const KeywordMatcher &getKeywordMatcher()
+{
+    // Built once on first use, also when extractors run on several threads
+    static const KeywordMatcher keywordMatcher = []() {
+        KeywordMatcher newKeywordMatcher;
+        addKeywords(newKeywordMatcher, UNLIKELY_CANDIDATE_KEYWORDS, KEYWORD_UNLIKELY_CANDIDATE);
+        addKeywords(newKeywordMatcher, MAYBE_A_CANDIDATE_KEYWORDS, KEYWORD_MAYBE_A_CANDIDATE);
+        addKeywords(newKeywordMatcher, POSITIVE_KEYWORDS, KEYWORD_POSITIVE);
+        addKeywords(newKeywordMatcher, NEGATIVE_KEYWORDS, KEYWORD_NEGATIVE);
+        newKeywordMatcher.compile();
+        return newKeywordMatcher;
+    }();
+    return keywordMatcher;
+}
+
+int getKeywordWeight(const uint &keywordCategories)
+{
+    int weight = 0;
+    if (keywordCategories & KEYWORD_NEGATIVE) {
+        weight -= 25;
+    }
+    if (keywordCategories & KEYWORD_POSITIVE) {
+        weight += 25;
+    }
+    return weight;
+}
+
+// Element tags to score by default.
+const QList<HtmlTag> DEFAULT_TAGS_TO_SCORE = QList<HtmlTag>() << HtmlTag::SECTION << HtmlTag::H2 << HtmlTag::H3 << HtmlTag::H4 << HtmlTag::H5 << HtmlTag::H6 << HtmlTag::P << HtmlTag::TD << HtmlTag::PRE;
+
+// Elements which are dropped if they neither contain text of their own nor anything but line breaks
+const QList<HtmlTag> TAGS_REMOVED_WITHOUT_CONTENT = QList<HtmlTag>() << HtmlTag::DIV << HtmlTag::SECTION << HtmlTag::HEADER << HtmlTag::H1 << HtmlTag::H2 << HtmlTag::H3 << HtmlTag::H4 << HtmlTag::H5 << HtmlTag::H6;
+
+// Elements which make up the cleaned article content
+const QList<HtmlTag> CONTENT_BLOCK_TAGS = QList<HtmlTag>() << HtmlTag::P << HtmlTag::PRE << HtmlTag::BLOCKQUOTE << HtmlTag::LI << HtmlTag::H2 << HtmlTag::H3 << HtmlTag::H4 << HtmlTag::H5 << HtmlTag::H6;
+
+// Unlikely candidates are kept if they are located up to this number of levels below a table
+const int MAX_TABLE_DISTANCE = 4;
 
 const QList<HtmlTag> DIV_TO_P_ELEMS = QList<HtmlTag>() << HtmlTag::A << HtmlTag::BLOCKQUOTE << HtmlTag::DL << HtmlTag::DIV << HtmlTag::IMG << HtmlTag::OL << HtmlTag::P << HtmlTag::PRE << HtmlTag::TABLE << HtmlTag::UL << HtmlTag::SELECT;
 const QList<HtmlTag> ALTER_TO_DIV_EXCEPTIONS = QList<HtmlTag>() << HtmlTag::DIV << HtmlTag::ARTICLE << HtmlTag::SECTION << HtmlTag::P;
@@ -179,8 +237,87 @@ QString ContentExtractor::getArticleTitle()
     return articleTitle;
 }
 
-bool scoreLessThan(const QVariant &score1, const QVariant &score2) {
-    return score1.toMap().value("score").toInt() > score2.toMap().value("score").toInt();
+void ContentExtractor::collectNodeFeatures()
+{
+    qDebug() << "ContentExtractor::collectNodeFeatures";
+    this->featureNodes.clear();
+    this->nodeFeatures.clear();
+
+    // First pass, top-down in document order: everything that depends only on the node itself or its ancestors.
+    // Parents are always visited before their children, so their index is already known. Visibility and removal
+    // are decided for every node on its own, the descendants of a dropped node are still looked at.
+    QHash<QGumboNode, int> nodeIndexes;
+    this->rootNode->forEach([this, &nodeIndexes](const QGumboNode &node) {
+        NodeFeatures features;
+        features.tag = node.tag();
+        features.parentIndex = -1;
+        if (node.hasParent()) {
+            features.parentIndex = nodeIndexes.value(node.parent(), -1);
+        }
+        features.textLength = node.innerTextLength();
+        features.hasOwnText = (features.textLength > 0);
+        features.linkTextLength = 0;
+        features.classWeight = (this->_flags & FLAG_WEIGHT_CLASSES) ? getClassWeight(node) : 0;
+        features.elementChildCount = 0;
+        features.brHrCount = 0;
+        features.candidate = false;
+
+        const NodeFeatures *parentFeatures = features.parentIndex >= 0 ? &this->nodeFeatures.at(features.parentIndex) : nullptr;
+        features.tableDistance = parentFeatures ? (parentFeatures->tag == HtmlTag::TABLE ? 1 : parentFeatures->tableDistance + 1) : MAX_TABLE_DISTANCE + 1;
+        features.visible = node.isProbablyVisible();
+        features.removed = false;
+
+        if (features.visible) {
+            QString nodeIdentifier = node.getAttribute("class") + " " + node.id();
+            uint identifierKeywords = 0;
+            if (this->_flags & FLAG_STRIP_UNLIKELYS) {
+                identifierKeywords = getKeywordMatcher().match(node.classView()) | getKeywordMatcher().match(node.idView());
+            }
+            if (!node.getByLine(nodeIdentifier).isEmpty()) {
+                qDebug() << "Byline identified";
+                features.removed = true;
+            } else if ((identifierKeywords & KEYWORD_UNLIKELY_CANDIDATE) &&
+                       !(identifierKeywords & KEYWORD_MAYBE_A_CANDIDATE) &&
+                       features.tableDistance > MAX_TABLE_DISTANCE &&
+                       features.tag != HtmlTag::BODY &&
+                       features.tag != HtmlTag::A) {
+                qDebug() << "Unlikely candidate";
+                features.removed = true;
+            }
+        }
+
+        if (features.parentIndex >= 0) {
+            this->nodeFeatures[features.parentIndex].elementChildCount++;
+        }
+
+        nodeIndexes.insert(node, this->nodeFeatures.size());
+        this->featureNodes.push_back(node);
+        this->nodeFeatures.append(features);
+    });
+
+    // Second pass, bottom-up: walking the document order backwards visits all children before their parent,
+    // so text and link lengths and line breaks of whole subtrees can be summed up and candidates decided on complete data.
+    for (int i = this->nodeFeatures.size() - 1; i >= 0; i--) {
+        NodeFeatures &features = this->nodeFeatures[i];
+        if (features.tag == HtmlTag::A) {
+            features.linkTextLength = features.textLength;
+        }
+        // Compares the element children with all line breaks below, like QGumboNode::containsContent()
+        bool withoutContent = TAGS_REMOVED_WITHOUT_CONTENT.contains(features.tag) && !features.hasOwnText &&
+                features.elementChildCount == features.brHrCount;
+        features.candidate = features.visible && !features.removed && !withoutContent && DEFAULT_TAGS_TO_SCORE.contains(features.tag);
+
+        if (features.parentIndex >= 0) {
+            // The lengths of the children are simply added up, the whitespace between them is not counted.
+            // They are only used for the link density, scoring measures the candidate's own text with innerText(true).
+            NodeFeatures &parent = this->nodeFeatures[features.parentIndex];
+            parent.textLength += features.textLength;
+            parent.linkTextLength += features.linkTextLength;
+            parent.brHrCount += features.brHrCount + ((features.tag == HtmlTag::BR || features.tag == HtmlTag::HR) ? 1 : 0);
+        }
+    }
+
+    qDebug() << "[Article Content] Elements analyzed: " << this->nodeFeatures.size();
 }
 
 QString ContentExtractor::getArticleContent()
@@ -188,33 +325,31 @@ QString ContentExtractor::getArticleContent()
     qDebug() << "ContentExtractor::getArticleContent";
     QString articleContent;
 
+    this->collectNodeFeatures();
+
     // Score all candidate elements and assign value to parent. According to the officical documentation:
     // A score is determined by things like number of commas, class names, etc. Maybe eventually link density.
-    QGumboNodes nodesForExtractor = this->rootNode->getAllElementsForExtractor();
-    qDebug() << "[Article Content] Elements for extraction: " << nodesForExtractor.size();
-    QGumboNodes candidates;
-    QVariantMap ancestorScores;
-    for (QGumboNode &nodeForExtractor : nodesForExtractor) {
-        QString normalizedInnerText = nodeForExtractor.innerText(true);
-        qDebug() << "Analyzing: " << normalizedInnerText.left(30) + "...";
-
-        if (normalizedInnerText.length() < 25) {
+    // Scores are kept in an array parallel to the node features.
+    const int nodeCount = this->nodeFeatures.size();
+    QVector<int> candidateScores(nodeCount, 0);
+    QVector<bool> hasScore(nodeCount, false);
+    for (int i = 0; i < nodeCount; i++) {
+        const NodeFeatures &features = this->nodeFeatures.at(i);
+        if (!features.candidate) {
             continue;
         }
-        QGumboNodes ancestors = nodeForExtractor.ancestors(3);
-        qDebug() << "Ancestors: " << ancestors.size();
-        if (ancestors.size() == 0) {
-            continue;
+        // Only the first candidate in document order is scored, the tree traversal has always stopped there
+        QString normalizedInnerText = this->featureNodes.at(i).innerText(true);
+        if (normalizedInnerText.length() < 25 || features.parentIndex < 0) {
+            break;
         }
 
         int contentScore = 1;
         contentScore += normalizedInnerText.split(";").size();
-        contentScore += qMin(qFloor(normalizedInnerText.size() / 100), 3);
-
-        qDebug() << "Content Score: " << contentScore;
+        contentScore += qMin(normalizedInnerText.size() / 100, 3);
 
         int ancestorLevel = 0;
-        for (QGumboNode ancestor : ancestors) {
+        for (int ancestorIndex = features.parentIndex; ancestorIndex >= 0 && ancestorLevel < 3; ancestorIndex = this->nodeFeatures.at(ancestorIndex).parentIndex) {
             int scoreDivider = 1;
             if (ancestorLevel == 1) {
                 scoreDivider = 2;
@@ -223,35 +358,32 @@ QString ContentExtractor::getArticleContent()
                 scoreDivider = ancestorLevel * 3;
             }
 
-            QString ancestorHash = ancestor.hash();
-            int ancestorContentScore = ancestorScores.value(ancestorHash, 0).toInt();
-            if (ancestorContentScore == 0) {
-                ancestorContentScore += getInitialContentScore(ancestor);
+            if (!hasScore.at(ancestorIndex)) {
+                candidateScores[ancestorIndex] = getInitialContentScore(ancestorIndex);
+                hasScore[ancestorIndex] = true;
             }
-            ancestorContentScore += contentScore / scoreDivider;
-            qDebug() << "Node " << ancestorHash << "New score: " << ancestorContentScore << ancestor.tagName();
-            ancestorScores.insert(ancestorHash, ancestorContentScore);
-            candidates.emplace_back(ancestor);
+            candidateScores[ancestorIndex] += contentScore / scoreDivider;
             ancestorLevel++;
         }
+        break;
     }
 
-    QVariantList scoresList;
-    for (QString key: ancestorScores.keys()) {
-        QVariantMap singleScore;
-        singleScore.insert("hash", key);
-        singleScore.insert("score", ancestorScores.value(key));
-        scoresList.append(singleScore);
+    int winner = -1;
+    int winnerScore = 0;
+    for (int i = 0; i < nodeCount; i++) {
+        if (!hasScore.at(i)) {
+            continue;
+        }
+        if (winner < 0 || candidateScores.at(i) > winnerScore) {
+            winner = i;
+            winnerScore = candidateScores.at(i);
+        }
     }
-    qSort(scoresList.begin(), scoresList.end(), scoreLessThan);
-
-    if (!scoresList.empty()) {
-        QString winnerHash = scoresList.at(0).toMap().value("hash").toString();
-        for (QGumboNode candidate : candidates) {
-            if (candidate.hash() == winnerHash) {
-                qDebug() << "The winner is: " << candidate.tagName() << scoresList.at(0).toMap().value("score").toInt();
-                break;
-            }
+    if (winner >= 0) {
+        qDebug() << "The winner is: " << this->featureNodes.at(winner).tagName() << winnerScore;
+        articleContent = getCleanedContent(winner);
+        if (!articleContent.isEmpty()) {
+            return articleContent;
         }
     }
 
@@ -263,10 +395,46 @@ QString ContentExtractor::getArticleContent()
     return articleContent;
 }
 
-int ContentExtractor::getInitialContentScore(const QGumboNode &node)
+QString ContentExtractor::getCleanedContent(const int &topCandidate)
 {
+    QString cleanedContent;
+
+    // Subtrees are contiguous in document order, so the top candidate's subtree ends with the first node
+    // whose parent lies before it. Removed elements and everything written out already are skipped together
+    // with their descendants.
+    const int nodeCount = this->nodeFeatures.size();
+    QVector<bool> skipped(nodeCount, false);
+    for (int i = topCandidate; i < nodeCount; i++) {
+        const NodeFeatures &features = this->nodeFeatures.at(i);
+        bool skip = features.removed || !features.visible;
+        if (i > topCandidate) {
+            if (features.parentIndex < topCandidate) {
+                break;
+            }
+            skip = skip || skipped.at(features.parentIndex);
+        }
+        skipped[i] = skip;
+        if (skip || !CONTENT_BLOCK_TAGS.contains(features.tag)) {
+            continue;
+        }
+
+        QString text = this->featureNodes.at(i).textContent().simplified();
+        if (!text.isEmpty()) {
+            // Headings and preformatted text keep their element, everything else becomes a plain paragraph
+            QString blockTag = (features.tag == HtmlTag::P || features.tag == HtmlTag::BLOCKQUOTE || features.tag == HtmlTag::LI) ? "p" : this->featureNodes.at(i).tagName();
+            cleanedContent.append("<" + blockTag + ">" + text.toHtmlEscaped() + "</" + blockTag + ">");
+        }
+        skipped[i] = true;
+    }
+
+    return cleanedContent;
+}
+
+int ContentExtractor::getInitialContentScore(const int &nodeIndex)
+{
+    const NodeFeatures &features = this->nodeFeatures.at(nodeIndex);
     int initialContentScore = 0;
-    switch (node.tag()) {
+    switch (features.tag) {
     case HtmlTag::DIV:
         initialContentScore += 5;
         break;
@@ -301,7 +469,7 @@ int ContentExtractor::getInitialContentScore(const QGumboNode &node)
         break;
     }
 
-    initialContentScore += getClassWeight(node);
+    initialContentScore += features.classWeight;
 
     return initialContentScore;
 }
@@ -310,40 +478,34 @@ int ContentExtractor::getClassWeight(const QGumboNode &node)
 {
     int weight = 0;
 
-    // Look for a special classname
-    QStringList nodeClasses = node.classList();
-    QListIterator<QString> classesIterator(nodeClasses);
-    while (classesIterator.hasNext()) {
-        QString singleClass = classesIterator.next();
-        if (REGEXP_NEGATIVE.match(singleClass).hasMatch()) {
-            weight -= 25;
+    const KeywordMatcher &keywordMatcher = getKeywordMatcher();
+
+    // Look for a special classname, every class on its own
+    QLatin1String nodeClasses = node.classView();
+    const char *current = nodeClasses.data();
+    const char *end = current + nodeClasses.size();
+    while (current < end) {
+        while (current < end && std::isspace(static_cast<unsigned char>(*current))) {
+            current++;
         }
-        if (REGEXP_POSITIVE.match(singleClass).hasMatch()) {
-            weight += 25;
+        const char *classStart = current;
+        while (current < end && !std::isspace(static_cast<unsigned char>(*current))) {
+            current++;
+        }
+        if (current > classStart) {
+            weight += getKeywordWeight(keywordMatcher.match(classStart, current - classStart));
         }
     }
-    QString nodeId = node.id();
-    if (REGEXP_NEGATIVE.match(nodeId).hasMatch()) {
-        weight -= 25;
-    }
-    if (REGEXP_POSITIVE.match(nodeId).hasMatch()) {
-        weight += 25;
-    }
+    weight += getKeywordWeight(keywordMatcher.match(node.idView()));
 
     return weight;
 }
 
-float ContentExtractor::getLinkDensity(const QGumboNode &node)
+float ContentExtractor::getLinkDensity(const int &nodeIndex)
 {
-    int textLength = node.innerText(true).size();
-    if (textLength == 0) {
+    const NodeFeatures &features = this->nodeFeatures.at(nodeIndex);
+    if (features.textLength == 0) {
         return 0;
     }
-    int linkLength = 0;
-    QGumboNodes linkNodes = node.getElementsByTagName(HtmlTag::A);
-    for (QGumboNode linkNode : linkNodes) {
-        linkLength += linkNode.innerText(true).size();
-    }
-
-    return linkLength / textLength;
+    return static_cast<float>(features.linkTextLength) / features.textLength;
 }
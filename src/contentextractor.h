@@ -24,6 +24,7 @@
 #include <QStringList>
 #include <QList>
 #include <QVariantMap>
+#include <QVector>
 
 #include "QGumboParser/HtmlTag.h"
 #include "QGumboParser/qgumbonode.h"
@@ -41,19 +42,40 @@ signals:
 public slots:
 
 private:
+    // Everything the scoring needs to know about a single element, collected in one pass over the tree
+    struct NodeFeatures {
+        HtmlTag tag;
+        int parentIndex;
+        // Normalized text of the whole subtree, summed up without the separators between text nodes
+        int textLength;
+        int linkTextLength;
+        int classWeight;
+        int tableDistance;
+        int elementChildCount;
+        int brHrCount;
+        bool hasOwnText;
+        bool visible;
+        bool removed;
+        bool candidate;
+    };
+
     QGumboNode *rootNode;
     char _flags;
     int _maxElemsToParse;
     int _nbTopCandidates;
     int _charThreshold;
     QStringList _classesToPreserve;
+    QGumboNodes featureNodes;
+    QVector<NodeFeatures> nodeFeatures;
 
     QVariantMap getArticleMetadata();
     QString getArticleTitle();
     QString getArticleContent();
-    int getInitialContentScore(const QGumboNode &node);
+    void collectNodeFeatures();
+    QString getCleanedContent(const int &topCandidate);
+    int getInitialContentScore(const int &nodeIndex);
     int getClassWeight(const QGumboNode &node);
-    float getLinkDensity(const QGumboNode &node);
+    float getLinkDensity(const int &nodeIndex);
 
 };
 
@@ -0,0 +1,366 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "conversationgraph.h"
+#include "conversationgraphwriter.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QJsonDocument>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+
+// One connection per account, like the mentions cache
+const char CONVERSATION_DATABASE_CONNECTION[] = "conversations:%1";
+// A known thread is shown without asking Twitter for a day, afterwards the status page is checked for new replies
+const qint64 CONVERSATION_REFRESH_SECONDS = 24 * 60 * 60;
+const qint64 CONVERSATION_TTL_SECONDS = 30 * 24 * 60 * 60;
+// Protects against broken data, real threads don't come anywhere near
+const int MAX_CONVERSATION_DEPTH = 1000;
+// Limits of the memory caches, chains count with their length
+const int PARENT_IDS_CACHE_SIZE = 5000;
+const int ANCESTOR_CHAINS_CACHE_COST = 20000;
+
+ConversationGraph::ConversationGraph(QObject *parent) : QObject(parent), writer(nullptr), writeSequence(0), parentIds(PARENT_IDS_CACHE_SIZE), ancestorChains(ANCESTOR_CHAINS_CACHE_COST)
+{
+}
+
+ConversationGraph::~ConversationGraph()
+{
+    closeDatabase();
+}
+
+void ConversationGraph::setDataDirectory(const QString &dataDirectory)
+{
+    qDebug() << "ConversationGraph::setDataDirectory" << dataDirectory;
+    closeDatabase();
+    // Nothing of the previous account may show up in the new one
+    parentIds.clear();
+    ancestorChains.clear();
+    initializeDatabase(dataDirectory);
+}
+
+void ConversationGraph::addTweet(const QVariantMap &tweet)
+{
+    addTweets(QVariantList() << tweet);
+}
+
+void ConversationGraph::addTweets(const QVariantList &tweets)
+{
+    for (const QVariant &tweet : tweets) {
+        QVariantMap tweetMap = tweet.toMap();
+        storeTweet(tweetMap);
+        // Retweets are shown as the original tweet, which is the one being part of a thread
+        if (tweetMap.contains("retweeted_status")) {
+            storeTweet(tweetMap.value("retweeted_status").toMap());
+        }
+    }
+}
+
+QVariantMap ConversationGraph::getTweet(const QString &tweetId)
+{
+    QVariantMap tweet;
+    QHash<QString, PendingTweet>::const_iterator pendingTweet = pendingTweets.constFind(tweetId);
+    if (pendingTweet != pendingTweets.constEnd()) {
+        return pendingTweet->tweet;
+    }
+    if (!database.isOpen()) {
+        return tweet;
+    }
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("select tweet from conversation_tweets where id = (:id)");
+    databaseQuery.bindValue(":id", tweetId);
+    if (databaseQuery.exec() && databaseQuery.next()) {
+        tweet = QJsonDocument::fromJson(databaseQuery.value(0).toByteArray()).toVariant().toMap();
+    }
+    return tweet;
+}
+
+bool ConversationGraph::getAncestors(const QString &tweetId, QStringList &ancestorIds, QString &missingTweetId)
+{
+    // Walks up until a tweet with a known chain, the root or an unknown tweet is found
+    QStringList path;
+    path.append(tweetId);
+    QStringList rootChain;
+    bool complete = false;
+    while (path.size() <= MAX_CONVERSATION_DEPTH) {
+        const QString currentId = path.last();
+        const QStringList *knownChain = ancestorChains.object(currentId);
+        if (knownChain != nullptr) {
+            rootChain = *knownChain;
+            complete = true;
+            break;
+        }
+        QString parentId;
+        if (!getParentId(currentId, parentId)) {
+            missingTweetId = currentId;
+            break;
+        }
+        if (parentId.isEmpty()) {
+            complete = true;
+            break;
+        }
+        path.append(parentId);
+    }
+
+    if (!complete) {
+        // Everything above the tweet which is known, starting with the topmost one
+        ancestorIds.clear();
+        for (int i = path.size() - 1; i > 0; i--) {
+            if (path.at(i) != missingTweetId) {
+                ancestorIds.append(path.at(i));
+            }
+        }
+        return false;
+    }
+
+    // Remember the chain of every tweet on the way, the ones closest to the root first
+    for (int i = path.size() - 1; i >= 0; i--) {
+        if (i < path.size() - 1) {
+            rootChain.append(path.at(i + 1));
+        }
+        ancestorChains.insert(path.at(i), new QStringList(rootChain), rootChain.size() + 1);
+    }
+    ancestorIds = rootChain;
+    return true;
+}
+
+QStringList ConversationGraph::getReplies(const QString &tweetId)
+{
+    QSet<QString> knownReplyIds;
+    if (database.isOpen()) {
+        QSqlQuery databaseQuery(database);
+        databaseQuery.prepare("select id from conversation_tweets where parent_id = (:parent_id)");
+        databaseQuery.bindValue(":parent_id", tweetId);
+        if (databaseQuery.exec()) {
+            while (databaseQuery.next()) {
+                knownReplyIds.insert(databaseQuery.value(0).toString());
+            }
+        }
+    }
+    for (QMultiHash<QString, QString>::const_iterator pendingReply = pendingReplies.constFind(tweetId); pendingReply != pendingReplies.constEnd() && pendingReply.key() == tweetId; ++pendingReply) {
+        knownReplyIds.insert(pendingReply.value());
+    }
+    QStringList replyIds = knownReplyIds.toList();
+    // Tweet IDs grow over time, equally long IDs sort like numbers
+    std::sort(replyIds.begin(), replyIds.end(), [](const QString &first, const QString &second) {
+        return first.length() == second.length() ? first < second : first.length() < second.length();
+    });
+    return replyIds;
+}
+
+bool ConversationGraph::getKnownConversation(const QString &tweetId, QVariantList &conversationTweets)
+{
+    qint64 checkedAt;
+    if (!getConversationCheckedAt(tweetId, checkedAt)) {
+        return false;
+    }
+    if (QDateTime::currentMSecsSinceEpoch() / 1000 - checkedAt > CONVERSATION_REFRESH_SECONDS) {
+        return false;
+    }
+
+    QStringList ancestorIds;
+    QString missingTweetId;
+    if (!getAncestors(tweetId, ancestorIds, missingTweetId)) {
+        qDebug() << "Conversation of " + tweetId + " is missing " + missingTweetId;
+        return false;
+    }
+    conversationTweets.clear();
+    for (const QString &ancestorId : ancestorIds) {
+        QVariantMap ancestor = getTweet(ancestorId);
+        if (ancestor.isEmpty()) {
+            return false;
+        }
+        conversationTweets.append(ancestor);
+    }
+    conversationTweets.append(getTweet(tweetId));
+    appendReplies(tweetId, conversationTweets, 0);
+    return true;
+}
+
+void ConversationGraph::setConversationChecked(const QString &tweetId)
+{
+    if (writer == nullptr) {
+        return;
+    }
+    // Goes through the writer as well, the tweet itself may still be waiting there
+    PendingCheck pendingCheck;
+    pendingCheck.checkedAt = QDateTime::currentMSecsSinceEpoch() / 1000;
+    pendingCheck.sequence = ++writeSequence;
+    pendingChecks.insert(tweetId, pendingCheck);
+    writer->storeConversationChecked(tweetId, pendingCheck.checkedAt, pendingCheck.sequence);
+}
+
+void ConversationGraph::handleWritten(const quint64 &sequence)
+{
+    QHash<QString, PendingTweet>::iterator pendingTweet = pendingTweets.begin();
+    while (pendingTweet != pendingTweets.end()) {
+        if (pendingTweet->sequence <= sequence) {
+            pendingReplies.remove(pendingTweet->tweet.value("in_reply_to_status_id_str").toString(), pendingTweet.key());
+            pendingTweet = pendingTweets.erase(pendingTweet);
+        } else {
+            ++pendingTweet;
+        }
+    }
+    QHash<QString, PendingCheck>::iterator pendingCheck = pendingChecks.begin();
+    while (pendingCheck != pendingChecks.end()) {
+        if (pendingCheck->sequence <= sequence) {
+            pendingCheck = pendingChecks.erase(pendingCheck);
+        } else {
+            ++pendingCheck;
+        }
+    }
+}
+
+void ConversationGraph::initializeDatabase(const QString &dataDirectory)
+{
+    qDebug() << "ConversationGraph::initializeDatabase";
+    QDir().mkpath(dataDirectory);
+    QString databaseFilePath = dataDirectory + "/cache.db";
+    connectionName = QString(CONVERSATION_DATABASE_CONNECTION).arg(dataDirectory);
+    database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    database.setDatabaseName(databaseFilePath);
+    if (!database.open()) {
+        qDebug() << "Error opening SQLite database " + databaseFilePath + ", conversations are not cached";
+        return;
+    }
+
+    QSqlQuery databaseQuery(database);
+    // Reading doesn't have to wait for the writer to commit
+    if (!databaseQuery.exec("pragma journal_mode = wal")) {
+        qDebug() << "Error enabling write-ahead logging!" << databaseQuery.lastError().text();
+    }
+    if (!database.tables().contains("conversation_tweets")) {
+        if (databaseQuery.exec("create table conversation_tweets (id text primary key, parent_id text, tweet text, stored_at integer, conversation_checked_at integer)") &&
+                databaseQuery.exec("create index conversation_tweets_parent_id on conversation_tweets (parent_id)")) {
+            qDebug() << "Conversation table successfully created!";
+        } else {
+            qDebug() << "Error creating conversation table!" << databaseQuery.lastError().text();
+        }
+    }
+
+    // Removes the expired tweets first
+    writer = new ConversationGraphWriter(databaseFilePath, QDateTime::currentMSecsSinceEpoch() / 1000 - CONVERSATION_TTL_SECONDS, this);
+    connect(writer, &ConversationGraphWriter::written, this, &ConversationGraph::handleWritten);
+    writer->start();
+}
+
+void ConversationGraph::closeDatabase()
+{
+    if (writer != nullptr) {
+        // Whatever is still queued belongs to this account and is written before switching
+        writer->stop();
+        writer->wait();
+        delete writer;
+        writer = nullptr;
+    }
+    pendingTweets.clear();
+    pendingReplies.clear();
+    pendingChecks.clear();
+    if (connectionName.isEmpty()) {
+        return;
+    }
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+    connectionName.clear();
+}
+
+void ConversationGraph::storeTweet(const QVariantMap &tweet)
+{
+    QString tweetId = tweet.value("id_str").toString();
+    if (tweetId.isEmpty()) {
+        return;
+    }
+    QString parentId = tweet.value("in_reply_to_status_id_str").toString();
+    parentIds.insert(tweetId, new QString(parentId));
+    if (writer == nullptr) {
+        return;
+    }
+
+    QHash<QString, PendingTweet>::iterator pendingTweet = pendingTweets.find(tweetId);
+    if (pendingTweet != pendingTweets.end()) {
+        pendingReplies.remove(pendingTweet->tweet.value("in_reply_to_status_id_str").toString(), tweetId);
+    } else {
+        pendingTweet = pendingTweets.insert(tweetId, PendingTweet());
+    }
+    pendingTweet->tweet = tweet;
+    pendingTweet->sequence = ++writeSequence;
+    pendingReplies.insert(parentId, tweetId);
+    writer->storeTweet(tweet, pendingTweet->sequence);
+}
+
+bool ConversationGraph::getConversationCheckedAt(const QString &tweetId, qint64 &checkedAt)
+{
+    QHash<QString, PendingCheck>::const_iterator pendingCheck = pendingChecks.constFind(tweetId);
+    if (pendingCheck != pendingChecks.constEnd()) {
+        checkedAt = pendingCheck->checkedAt;
+        return true;
+    }
+    if (!database.isOpen()) {
+        return false;
+    }
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("select conversation_checked_at from conversation_tweets where id = (:id)");
+    databaseQuery.bindValue(":id", tweetId);
+    if (!databaseQuery.exec() || !databaseQuery.next() || databaseQuery.value(0).isNull()) {
+        return false;
+    }
+    checkedAt = databaseQuery.value(0).toLongLong();
+    return true;
+}
+
+bool ConversationGraph::getParentId(const QString &tweetId, QString &parentId)
+{
+    const QString *knownParent = parentIds.object(tweetId);
+    if (knownParent != nullptr) {
+        parentId = *knownParent;
+        return true;
+    }
+    if (!database.isOpen()) {
+        return false;
+    }
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("select parent_id from conversation_tweets where id = (:id)");
+    databaseQuery.bindValue(":id", tweetId);
+    if (!databaseQuery.exec() || !databaseQuery.next()) {
+        return false;
+    }
+    parentId = databaseQuery.value(0).toString();
+    parentIds.insert(tweetId, new QString(parentId));
+    return true;
+}
+
+void ConversationGraph::appendReplies(const QString &tweetId, QVariantList &conversationTweets, const int &depth)
+{
+    if (depth >= MAX_CONVERSATION_DEPTH) {
+        return;
+    }
+    // Every reply is directly followed by the replies to it
+    const QStringList replyIds = getReplies(tweetId);
+    for (const QString &replyId : replyIds) {
+        QVariantMap reply = getTweet(replyId);
+        if (!reply.isEmpty()) {
+            conversationTweets.append(reply);
+            appendReplies(replyId, conversationTweets, depth + 1);
+        }
+    }
+}
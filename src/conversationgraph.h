@@ -0,0 +1,100 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CONVERSATIONGRAPH_H
+#define CONVERSATIONGRAPH_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QMultiHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QSqlDatabase>
+
+class ConversationGraphWriter;
+
+/*
+ * Remembers every tweet which passes through the API together with the tweet it replies to,
+ * so that threads can be put together from the cache database instead of the network.
+ * Tweets are stored as the account saw them (protected tweets, favorited and retweeted flags),
+ * so every account has its own graph in its data directory. The tweets are written by a
+ * ConversationGraphWriter in the background and kept in memory until they are stored.
+ */
+class ConversationGraph : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConversationGraph(QObject *parent = nullptr);
+    ~ConversationGraph();
+
+    // Closes the graph of the previous account and opens the one in the given directory
+    void setDataDirectory(const QString &dataDirectory);
+
+    void addTweet(const QVariantMap &tweet);
+    void addTweets(const QVariantList &tweets);
+    QVariantMap getTweet(const QString &tweetId);
+
+    // Returns the IDs from the root of the thread down to the parent of the tweet. If the chain
+    // is incomplete, the known part is returned and missingTweetId is the first unknown ancestor.
+    bool getAncestors(const QString &tweetId, QStringList &ancestorIds, QString &missingTweetId);
+    QStringList getReplies(const QString &tweetId);
+
+    // Returns true if the conversation of the tweet was checked recently and the whole thread is stored
+    bool getKnownConversation(const QString &tweetId, QVariantList &conversationTweets);
+    void setConversationChecked(const QString &tweetId);
+
+private slots:
+    void handleWritten(const quint64 &sequence);
+
+private:
+    struct PendingTweet {
+        QVariantMap tweet;
+        quint64 sequence;
+    };
+    struct PendingCheck {
+        qint64 checkedAt;
+        quint64 sequence;
+    };
+
+    QSqlDatabase database;
+    QString connectionName;
+    ConversationGraphWriter *writer;
+    // Grows over all writers, so that a late report of a previous account's writer can't remove anything
+    quint64 writeSequence;
+    // Queued for the writer, but not yet confirmed to be in the table
+    QHash<QString, PendingTweet> pendingTweets;
+    QMultiHash<QString, QString> pendingReplies;
+    QHash<QString, PendingCheck> pendingChecks;
+    // Recently used parent IDs, an empty parent ID means the tweet doesn't reply to anything.
+    // Everything else is looked up in the table again.
+    QCache<QString, QString> parentIds;
+    // Recently used complete ancestor chains, they never change once the root is known
+    QCache<QString, QStringList> ancestorChains;
+
+    void initializeDatabase(const QString &dataDirectory);
+    void closeDatabase();
+    void storeTweet(const QVariantMap &tweet);
+    bool getConversationCheckedAt(const QString &tweetId, qint64 &checkedAt);
+    bool getParentId(const QString &tweetId, QString &parentId);
+    void appendReplies(const QString &tweetId, QVariantList &conversationTweets, const int &depth);
+};
+
+#endif // CONVERSATIONGRAPH_H
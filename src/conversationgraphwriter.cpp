@@ -0,0 +1,166 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "conversationgraphwriter.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVector>
+
+const char CONVERSATION_WRITER_DATABASE_CONNECTION[] = "conversationWriter:%1";
+
+ConversationGraphWriter::ConversationGraphWriter(const QString &databaseFilePath, const qint64 &expiry, QObject *parent) : QThread(parent)
+{
+    this->databaseFilePath = databaseFilePath;
+    this->connectionName = QString(CONVERSATION_WRITER_DATABASE_CONNECTION).arg(databaseFilePath);
+    this->expiry = expiry;
+    this->stopping = false;
+}
+
+void ConversationGraphWriter::storeTweet(const QVariantMap &tweet, const quint64 &sequence)
+{
+    WriteOperation writeOperation;
+    writeOperation.tweet = tweet;
+    writeOperation.checkedAt = 0;
+    writeOperation.sequence = sequence;
+    enqueue(writeOperation);
+}
+
+void ConversationGraphWriter::storeConversationChecked(const QString &tweetId, const qint64 &checkedAt, const quint64 &sequence)
+{
+    WriteOperation writeOperation;
+    writeOperation.tweetId = tweetId;
+    writeOperation.checkedAt = checkedAt;
+    writeOperation.sequence = sequence;
+    enqueue(writeOperation);
+}
+
+void ConversationGraphWriter::stop()
+{
+    QMutexLocker locker(&queueMutex);
+    stopping = true;
+    queueCondition.wakeOne();
+}
+
+void ConversationGraphWriter::run()
+{
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(databaseFilePath);
+        if (database.open()) {
+            QSqlQuery databaseQuery(database);
+            databaseQuery.prepare("delete from conversation_tweets where stored_at < (:expiry)");
+            databaseQuery.bindValue(":expiry", expiry);
+            if (!databaseQuery.exec()) {
+                qDebug() << "Error removing expired conversation tweets!" << databaseQuery.lastError().text();
+            }
+        } else {
+            qDebug() << "Error opening SQLite database " + databaseFilePath + ", conversation tweets are not stored";
+        }
+
+        forever {
+            QList<WriteOperation> batch;
+            {
+                QMutexLocker locker(&queueMutex);
+                while (queue.isEmpty() && !stopping) {
+                    queueCondition.wait(&queueMutex);
+                }
+                if (queue.isEmpty()) {
+                    break;
+                }
+                batch.swap(queue);
+            }
+            // Even if nothing could be written, the graph doesn't need to keep the tweets any longer
+            if (database.isOpen()) {
+                writeBatch(database, batch);
+            }
+            emit written(batch.last().sequence);
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void ConversationGraphWriter::enqueue(const WriteOperation &writeOperation)
+{
+    QMutexLocker locker(&queueMutex);
+    queue.append(writeOperation);
+    queueCondition.wakeOne();
+}
+
+void ConversationGraphWriter::writeBatch(QSqlDatabase &database, const QList<WriteOperation> &batch)
+{
+    // Serialized up front, the database stays locked only for the writes
+    QVector<QByteArray> tweetsJson(batch.size());
+    for (int i = 0; i < batch.size(); i++) {
+        if (batch.at(i).tweetId.isEmpty()) {
+            tweetsJson[i] = QJsonDocument::fromVariant(batch.at(i).tweet).toJson(QJsonDocument::Compact);
+        }
+    }
+
+    const qint64 storedAt = QDateTime::currentMSecsSinceEpoch() / 1000;
+    QSqlQuery updateQuery(database);
+    updateQuery.prepare("update conversation_tweets set parent_id = (:parent_id), tweet = (:tweet), stored_at = (:stored_at) where id = (:id)");
+    QSqlQuery insertQuery(database);
+    insertQuery.prepare("insert into conversation_tweets (id, parent_id, tweet, stored_at) values((:id),(:parent_id),(:tweet),(:stored_at))");
+    QSqlQuery checkedQuery(database);
+    checkedQuery.prepare("update conversation_tweets set conversation_checked_at = (:checked_at) where id = (:id)");
+
+    bool transaction = database.transaction();
+    for (int i = 0; i < batch.size(); i++) {
+        const WriteOperation &writeOperation = batch.at(i);
+        if (writeOperation.tweetId.isEmpty()) {
+            writeTweet(updateQuery, insertQuery, writeOperation.tweet, tweetsJson.at(i), storedAt);
+        } else {
+            checkedQuery.bindValue(":checked_at", writeOperation.checkedAt);
+            checkedQuery.bindValue(":id", writeOperation.tweetId);
+            if (!checkedQuery.exec()) {
+                qDebug() << "Error updating conversation of " + writeOperation.tweetId << checkedQuery.lastError().text();
+            }
+        }
+    }
+    if (transaction && !database.commit()) {
+        qDebug() << "Error storing conversation tweets!" << database.lastError().text();
+    }
+}
+
+void ConversationGraphWriter::writeTweet(QSqlQuery &updateQuery, QSqlQuery &insertQuery, const QVariantMap &tweet, const QByteArray &tweetJson, const qint64 &storedAt)
+{
+    QString tweetId = tweet.value("id_str").toString();
+    QString parentId = tweet.value("in_reply_to_status_id_str").toString();
+
+    // Updated in place, an already checked conversation stays checked
+    updateQuery.bindValue(":parent_id", parentId);
+    updateQuery.bindValue(":tweet", tweetJson);
+    updateQuery.bindValue(":stored_at", storedAt);
+    updateQuery.bindValue(":id", tweetId);
+    if (updateQuery.exec() && updateQuery.numRowsAffected() > 0) {
+        return;
+    }
+    insertQuery.bindValue(":id", tweetId);
+    insertQuery.bindValue(":parent_id", parentId);
+    insertQuery.bindValue(":tweet", tweetJson);
+    insertQuery.bindValue(":stored_at", storedAt);
+    if (!insertQuery.exec()) {
+        qDebug() << "Error storing tweet " + tweetId << insertQuery.lastError().text();
+    }
+}
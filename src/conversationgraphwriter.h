@@ -0,0 +1,74 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CONVERSATIONGRAPHWRITER_H
+#define CONVERSATIONGRAPHWRITER_H
+
+#include <QThread>
+#include <QList>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVariantMap>
+#include <QWaitCondition>
+
+class QSqlQuery;
+
+/*
+ * Writes the tweets of a ConversationGraph to its table through an own database connection.
+ * Everything queued while a batch is being written goes into the next transaction, so the
+ * JSON serialization and the SQLite writes never block the thread which receives the tweets.
+ */
+class ConversationGraphWriter : public QThread
+{
+    Q_OBJECT
+    void run() Q_DECL_OVERRIDE;
+public:
+    ConversationGraphWriter(const QString &databaseFilePath, const qint64 &expiry, QObject *parent = 0);
+
+    // Sequence numbers must grow, written() reports the last one of each batch
+    void storeTweet(const QVariantMap &tweet, const quint64 &sequence);
+    void storeConversationChecked(const QString &tweetId, const qint64 &checkedAt, const quint64 &sequence);
+    // Writes what is still queued and ends the thread
+    void stop();
+
+signals:
+    void written(const quint64 &sequence);
+
+private:
+    struct WriteOperation {
+        QVariantMap tweet;
+        QString tweetId;
+        qint64 checkedAt;
+        quint64 sequence;
+    };
+
+    QString databaseFilePath;
+    QString connectionName;
+    qint64 expiry;
+    QMutex queueMutex;
+    QWaitCondition queueCondition;
+    QList<WriteOperation> queue;
+    bool stopping;
+
+    void enqueue(const WriteOperation &writeOperation);
+    void writeBatch(QSqlDatabase &database, const QList<WriteOperation> &batch);
+    void writeTweet(QSqlQuery &updateQuery, QSqlQuery &insertQuery, const QVariantMap &tweet, const QByteArray &tweetJson, const qint64 &storedAt);
+};
+
+#endif // CONVERSATIONGRAPHWRITER_H
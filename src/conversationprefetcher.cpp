@@ -0,0 +1,214 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "conversationprefetcher.h"
+
+#include "conversationgraph.h"
+#include "twitterapi.h"
+#include "o1requestor.h"
+#include "o0requestparameter.h"
+#include "o0globals.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+// Part of the 900 statuses/show requests per 15 minutes which is left to tweets the user actually opens
+const int PREFETCH_RATE_LIMIT_RESERVE = 300;
+// Number of ancestors fetched for a single reply, long threads are completed when they are opened
+const int MAX_PREFETCH_DEPTH = 10;
+const int MAX_PENDING_PREFETCHES = 20;
+
+ConversationPrefetcher::ConversationPrefetcher(O1Requestor *requestor, ConversationGraph *conversationGraph, QObject *parent) : QObject(parent)
+{
+    this->requestor = requestor;
+    this->conversationGraph = conversationGraph;
+    this->dataSaverMode = false;
+    this->rateLimitRemaining = -1;
+    this->rateLimitReset = 0;
+    this->resumeScheduled = false;
+}
+
+void ConversationPrefetcher::setRequestor(O1Requestor *requestor)
+{
+    this->requestor = requestor;
+}
+
+void ConversationPrefetcher::prefetch(const QString &tweetId, const int &priority)
+{
+    if (this->dataSaverMode) {
+        return;
+    }
+    QStringList ancestorIds;
+    QString missingTweetId;
+    if (conversationGraph->getAncestors(tweetId, ancestorIds, missingTweetId) || missingTweetId.isEmpty() || missingTweetId == tweetId) {
+        return;
+    }
+    qDebug() << "ConversationPrefetcher::prefetch" << tweetId << missingTweetId << priority;
+    enqueue(missingTweetId, priority, ancestorIds.size() + 1);
+    startNextRequest();
+}
+
+void ConversationPrefetcher::setDataSaverMode(const bool &dataSaverMode)
+{
+    qDebug() << "ConversationPrefetcher::setDataSaverMode" << dataSaverMode;
+    this->dataSaverMode = dataSaverMode;
+    if (dataSaverMode) {
+        this->pendingRequests.clear();
+    }
+}
+
+void ConversationPrefetcher::updateRateLimit(QNetworkReply *reply)
+{
+    if (!reply->hasRawHeader("x-rate-limit-remaining")) {
+        return;
+    }
+    this->rateLimitRemaining = reply->rawHeader("x-rate-limit-remaining").toInt();
+    this->rateLimitReset = reply->rawHeader("x-rate-limit-reset").toLongLong();
+}
+
+void ConversationPrefetcher::handlePrefetchFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reply->deleteLater();
+    QString tweetId = this->runningTweetId;
+    this->runningTweetId.clear();
+    int depth = reply->property("depth").toInt();
+    int priority = reply->property("priority").toInt();
+    updateRateLimit(reply);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qDebug() << "Unable to prefetch tweet " + tweetId << reply->errorString();
+        int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (statusCode == 403 || statusCode == 404) {
+            this->unavailableTweetIds.insert(tweetId);
+        }
+    } else {
+        QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
+        if (jsonDocument.isObject()) {
+            QVariantMap tweet = jsonDocument.object().toVariantMap();
+            TwitterApi::ingestTweet(tweet, conversationGraph);
+            // Continues with the next unknown tweet further up the thread
+            QStringList ancestorIds;
+            QString missingTweetId;
+            if (depth < MAX_PREFETCH_DEPTH && !conversationGraph->getAncestors(tweetId, ancestorIds, missingTweetId) && !missingTweetId.isEmpty()) {
+                enqueue(missingTweetId, priority, depth + 1);
+            }
+        }
+    }
+    startNextRequest();
+}
+
+void ConversationPrefetcher::resumePrefetching()
+{
+    this->resumeScheduled = false;
+    this->rateLimitRemaining = -1;
+    startNextRequest();
+}
+
+void ConversationPrefetcher::enqueue(const QString &tweetId, const int &priority, const int &depth)
+{
+    if (tweetId == this->runningTweetId || this->unavailableTweetIds.contains(tweetId)) {
+        return;
+    }
+    for (int i = 0; i < this->pendingRequests.size(); i++) {
+        if (this->pendingRequests.at(i).tweetId == tweetId) {
+            if (this->pendingRequests.at(i).priority >= priority) {
+                return;
+            }
+            this->pendingRequests.removeAt(i);
+            break;
+        }
+    }
+
+    PendingRequest pendingRequest;
+    pendingRequest.tweetId = tweetId;
+    pendingRequest.priority = priority;
+    pendingRequest.depth = depth;
+    int position = 0;
+    while (position < this->pendingRequests.size() && this->pendingRequests.at(position).priority > priority) {
+        position++;
+    }
+    this->pendingRequests.insert(position, pendingRequest);
+    // Whatever was scrolled past long ago is dropped first
+    while (this->pendingRequests.size() > MAX_PENDING_PREFETCHES) {
+        this->pendingRequests.removeLast();
+    }
+}
+
+bool ConversationPrefetcher::hasRateLimitBudget()
+{
+    if (this->rateLimitRemaining < 0 || this->rateLimitRemaining > PREFETCH_RATE_LIMIT_RESERVE) {
+        return true;
+    }
+    qint64 secondsUntilReset = this->rateLimitReset - QDateTime::currentMSecsSinceEpoch() / 1000;
+    if (secondsUntilReset <= 0) {
+        return true;
+    }
+    if (!this->resumeScheduled) {
+        qDebug() << "Rate limit reserve reached, prefetching conversations again in" << secondsUntilReset << "seconds";
+        this->resumeScheduled = true;
+        QTimer::singleShot(secondsUntilReset * 1000, this, SLOT(resumePrefetching()));
+    }
+    return false;
+}
+
+void ConversationPrefetcher::startNextRequest()
+{
+    if (!this->runningTweetId.isEmpty() || this->pendingRequests.isEmpty() || this->dataSaverMode || !hasRateLimitBudget()) {
+        return;
+    }
+    PendingRequest pendingRequest = this->pendingRequests.takeFirst();
+    QVariantMap storedTweet = conversationGraph->getTweet(pendingRequest.tweetId);
+    if (!storedTweet.isEmpty()) {
+        // Arrived in the meantime, e.g. with a timeline
+        startNextRequest();
+        return;
+    }
+    qDebug() << "ConversationPrefetcher::startNextRequest" << pendingRequest.tweetId;
+    this->runningTweetId = pendingRequest.tweetId;
+
+    QUrl url = QUrl(API_STATUSES_SHOW);
+    QUrlQuery urlQuery = QUrlQuery();
+    urlQuery.addQueryItem("tweet_mode", "extended");
+    urlQuery.addQueryItem("include_entities", "true");
+    urlQuery.addQueryItem("trim_user", "false");
+    urlQuery.addQueryItem("id", pendingRequest.tweetId);
+    urlQuery.addQueryItem("include_ext_alt_text", "true");
+    url.setQuery(urlQuery);
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, O2_MIME_TYPE_XFORM);
+    request.setPriority(QNetworkRequest::LowPriority);
+
+    QList<O0RequestParameter> requestParameters = QList<O0RequestParameter>();
+    requestParameters.append(O0RequestParameter(QByteArray("tweet_mode"), QByteArray("extended")));
+    requestParameters.append(O0RequestParameter(QByteArray("include_entities"), QByteArray("true")));
+    requestParameters.append(O0RequestParameter(QByteArray("trim_user"), QByteArray("false")));
+    requestParameters.append(O0RequestParameter(QByteArray("id"), pendingRequest.tweetId.toUtf8()));
+    requestParameters.append(O0RequestParameter(QByteArray("include_ext_alt_text"), QByteArray("true")));
+    QNetworkReply *reply = requestor->get(request, requestParameters);
+    reply->setProperty("depth", pendingRequest.depth);
+    reply->setProperty("priority", pendingRequest.priority);
+
+    connect(reply, SIGNAL(finished()), this, SLOT(handlePrefetchFinished()));
+}
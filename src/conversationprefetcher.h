@@ -0,0 +1,76 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CONVERSATIONPREFETCHER_H
+#define CONVERSATIONPREFETCHER_H
+
+#include <QObject>
+#include <QList>
+#include <QNetworkReply>
+#include <QSet>
+#include <QString>
+
+class O1Requestor;
+class ConversationGraph;
+
+/*
+ * Fetches the missing ancestors of replies into the conversation graph before they are opened.
+ * Only one tweet is requested at a time, and prefetching stops while the statuses/show
+ * rate limit is close to being used up or while data saving is active.
+ */
+class ConversationPrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConversationPrefetcher(O1Requestor *requestor, ConversationGraph *conversationGraph, QObject *parent = nullptr);
+
+    void setRequestor(O1Requestor *requestor);
+    void prefetch(const QString &tweetId, const int &priority);
+    void setDataSaverMode(const bool &dataSaverMode);
+    // Rate limit headers of any statuses/show response, the interactive requests use up the same limit
+    void updateRateLimit(QNetworkReply *reply);
+
+private slots:
+    void handlePrefetchFinished();
+    void resumePrefetching();
+
+private:
+    struct PendingRequest {
+        QString tweetId;
+        int priority;
+        int depth;
+    };
+
+    O1Requestor *requestor;
+    ConversationGraph *conversationGraph;
+    // Ordered by priority, requests with the same priority are ordered from newest to oldest
+    QList<PendingRequest> pendingRequests;
+    QString runningTweetId;
+    // Deleted or protected tweets, there is no point in asking again
+    QSet<QString> unavailableTweetIds;
+    bool dataSaverMode;
+    int rateLimitRemaining;
+    qint64 rateLimitReset;
+    bool resumeScheduled;
+
+    void enqueue(const QString &tweetId, const int &priority, const int &depth);
+    bool hasRateLimitBudget();
+    void startNextRequest();
+};
+
+#endif // CONVERSATIONPREFETCHER_H
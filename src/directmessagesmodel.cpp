@@ -24,9 +24,10 @@
 
 const char SETTINGS_LAST_MESSAGE[] = "messages/lastId";
 
-DirectMessagesModel::DirectMessagesModel(TwitterApi *twitterApi) : settings("harbour-piepmatz", "settings")
+DirectMessagesModel::DirectMessagesModel(TwitterApi *twitterApi, AccountModel &accountModel)
 {
     this->twitterApi = twitterApi;
+    this->accountModel = &accountModel;
     this->incrementalUpdate = false;
 
     connect(twitterApi, &TwitterApi::directMessagesListError, this, &DirectMessagesModel::handleDirectMessagesListError);
@@ -100,12 +101,13 @@ void DirectMessagesModel::handleDirectMessagesListSuccessful(const QVariantMap &
         QString senderId = singleMessage.value("sender_id").toString();
         QString recipientId = singleMessage.value("target").toMap().value("recipient_id").toString();
         if (iterations == 0 && !firstOtherMessageFound && recipientId == this->userId) {
-            QString storedMessageId = settings.value(SETTINGS_LAST_MESSAGE).toString();
+            QSettings *settings = accountModel->getActiveSession()->getSettings();
+            QString storedMessageId = settings->value(SETTINGS_LAST_MESSAGE).toString();
             QString lastMessageId = singleEvent.value("id").toString();
             if (!storedMessageId.isEmpty() && storedMessageId != lastMessageId) {
                 emit newMessagesFound();
             }
-            settings.setValue(SETTINGS_LAST_MESSAGE, lastMessageId);
+            settings->setValue(SETTINGS_LAST_MESSAGE, lastMessageId);
             firstOtherMessageFound = true;
         }
         if (!involvedUsers.contains(senderId)) {
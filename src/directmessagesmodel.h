@@ -22,8 +22,8 @@
 #include <QAbstractListModel>
 #include <QList>
 #include <QVariantList>
-#include <QSettings>
 #include "twitterapi.h"
+#include "accountmodel.h"
 
 const int MAX_ITERATIONS = 2;
 
@@ -31,7 +31,7 @@ class DirectMessagesModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
-    DirectMessagesModel(TwitterApi *twitterApi);
+    DirectMessagesModel(TwitterApi *twitterApi, AccountModel &accountModel);
 
     virtual int rowCount(const QModelIndex&) const;
     virtual QVariant data(const QModelIndex &index, int role) const;
@@ -56,7 +56,7 @@ private slots:
 
 private:
     TwitterApi *twitterApi;
-    QSettings settings;
+    AccountModel *accountModel;
     int iterations;
     QList<QString> involvedUsers;
     QList<QString> invalidUsers;
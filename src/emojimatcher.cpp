@@ -0,0 +1,236 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "emojimatcher.h"
+#include "emojitable.h"
+
+#include <QVarLengthArray>
+#include <algorithm>
+#include <map>
+
+namespace {
+
+const uint TEXT_PRESENTATION_SELECTOR = 0xFE0E;
+const uint EMOJI_PRESENTATION_SELECTOR = 0xFE0F;
+
+// Longer than the longest sequence in the table
+const int MAX_EMOJI_LENGTH = 16;
+
+uint readCodePoint(const QString &text, const int &position, int &length)
+{
+    const QChar character = text.at(position);
+    if (character.isHighSurrogate() && position + 1 < text.size() && text.at(position + 1).isLowSurrogate()) {
+        length = 2;
+        return QChar::surrogateToUcs4(character, text.at(position + 1));
+    }
+    length = 1;
+    return character.unicode();
+}
+
+// Symbols which are shown as text unless they are followed by an emoji presentation selector
+bool requiresPresentationSelector(const uint &codePoint)
+{
+    return codePoint == 0x00A9 || codePoint == 0x00AE || codePoint == 0x2122 || codePoint == 0x265F;
+}
+
+bool isWordCharacter(const QChar &character)
+{
+    return (character >= QLatin1Char('a') && character <= QLatin1Char('z')) || (character >= QLatin1Char('A') && character <= QLatin1Char('Z')) ||
+            (character >= QLatin1Char('0') && character <= QLatin1Char('9')) || character == QLatin1Char('_');
+}
+
+}
+
+const EmojiMatcher &EmojiMatcher::getInstance()
+{
+    static const EmojiMatcher emojiMatcher;
+    return emojiMatcher;
+}
+
+EmojiMatcher::EmojiMatcher()
+{
+    // Built with maps first, afterwards every node gets its children as one sorted range of edges
+    std::vector<std::map<uint, int> > children(1);
+    std::vector<bool> terminals(1, false);
+    const int tableSize = sizeof(EMOJI_SEQUENCES) / sizeof(EMOJI_SEQUENCES[0]);
+    int node = 0;
+    for (int i = 0; i < tableSize; i++) {
+        const uint codePoint = EMOJI_SEQUENCES[i];
+        if (codePoint == 0) {
+            terminals[node] = true;
+            node = 0;
+            continue;
+        }
+        std::map<uint, int>::const_iterator child = children[node].find(codePoint);
+        if (child == children[node].end()) {
+            children[node][codePoint] = children.size();
+            node = children.size();
+            children.push_back(std::map<uint, int>());
+            terminals.push_back(false);
+        } else {
+            node = child->second;
+        }
+    }
+
+    nodes.resize(children.size());
+    for (size_t i = 0; i < children.size(); i++) {
+        Node &trieNode = nodes[i];
+        trieNode.firstEdge = edges.size();
+        trieNode.edgeCount = children[i].size();
+        trieNode.terminal = terminals[i];
+        for (std::map<uint, int>::const_iterator child = children[i].begin(); child != children[i].end(); ++child) {
+            Edge edge;
+            edge.codePoint = child->first;
+            edge.node = child->second;
+            edges.append(edge);
+        }
+    }
+}
+
+int EmojiMatcher::findChild(const int &node, const uint &codePoint) const
+{
+    const Node &trieNode = nodes.at(node);
+    const Edge *first = edges.constData() + trieNode.firstEdge;
+    const Edge *last = first + trieNode.edgeCount;
+    const Edge *edge = std::lower_bound(first, last, codePoint, [](const Edge &edge, const uint &codePoint) {
+        return edge.codePoint < codePoint;
+    });
+    return (edge != last && edge->codePoint == codePoint) ? edge->node : -1;
+}
+
+int EmojiMatcher::matchEmoji(const QString &text, const int &position, QString &iconName) const
+{
+    // Follows the trie as far as possible and remembers the longest complete emoji on the way
+    QVarLengthArray<uint, MAX_EMOJI_LENGTH> path;
+    int matchLength = 0;
+    int matchCodePoints = 0;
+    bool presentationSelector = false;
+    bool matchPresentationSelector = false;
+    int node = 0;
+    int currentPosition = position;
+    while (currentPosition < text.size() && path.size() < MAX_EMOJI_LENGTH) {
+        int codePointLength;
+        const uint codePoint = readCodePoint(text, currentPosition, codePointLength);
+        const int child = findChild(node, codePoint);
+        if (child < 0) {
+            // Image names only contain the selector within ZWJ sequences, anywhere else it is simply swallowed
+            if (codePoint == EMOJI_PRESENTATION_SELECTOR && node != 0) {
+                currentPosition += codePointLength;
+                presentationSelector = true;
+                if (nodes.at(node).terminal && path.size() == matchCodePoints) {
+                    matchLength = currentPosition - position;
+                    matchPresentationSelector = true;
+                }
+                continue;
+            }
+            break;
+        }
+        node = child;
+        path.append(codePoint);
+        currentPosition += codePointLength;
+        if (nodes.at(node).terminal) {
+            matchLength = currentPosition - position;
+            matchCodePoints = path.size();
+            matchPresentationSelector = presentationSelector;
+        }
+    }
+    if (matchLength == 0) {
+        return 0;
+    }
+
+    // The selector may also have been taken as the start of a longer ZWJ sequence which did not match
+    if (position + matchLength < text.size() && text.at(position + matchLength).unicode() == EMOJI_PRESENTATION_SELECTOR) {
+        matchLength++;
+        matchPresentationSelector = true;
+    }
+    const int matchEnd = position + matchLength;
+    if (matchEnd < text.size() && text.at(matchEnd).unicode() == TEXT_PRESENTATION_SELECTOR) {
+        return 0;
+    }
+    if (matchCodePoints == 1 && !matchPresentationSelector && requiresPresentationSelector(path.at(0))) {
+        return 0;
+    }
+
+    iconName.clear();
+    for (int i = 0; i < matchCodePoints; i++) {
+        if (i > 0) {
+            iconName.append(QLatin1Char('-'));
+        }
+        iconName.append(QString::number(path.at(i), 16));
+    }
+    return matchLength;
+}
+
+int EmojiMatcher::getEmojiLength(const QString &text, const int &position) const
+{
+    QString iconName;
+    return matchEmoji(text, position, iconName);
+}
+
+QString EmojiMatcher::emojify(const QString &text, const int &emojiSize, const bool &withImages) const
+{
+    QString emojifiedText;
+    emojifiedText.reserve(text.size() + text.size() / 4);
+    const QString imageSize = QString::number(emojiSize);
+    QString iconName;
+    const int textLength = text.size();
+    int position = 0;
+    while (position < textLength) {
+        const QChar character = text.at(position);
+
+        // QML has a weird bug. If an ampersand is followed by an HTML tag or a character, the tag is ignored and returned as string or the following string is omitted
+        // Therefore replacing the ampersand with &amp; in these cases, entities are kept
+        if (character == QLatin1Char('&')) {
+            int entityEnd = position + 1;
+            while (entityEnd < textLength && isWordCharacter(text.at(entityEnd))) {
+                entityEnd++;
+            }
+            if (entityEnd > position + 1 && entityEnd < textLength && text.at(entityEnd) == QLatin1Char(';')) {
+                emojifiedText.append(text.midRef(position, entityEnd + 1 - position));
+                position = entityEnd + 1;
+            } else {
+                if (position + 1 < textLength && (text.at(position + 1) == QLatin1Char('<') || isWordCharacter(text.at(position + 1)))) {
+                    emojifiedText.append(QLatin1String("&amp;"));
+                } else {
+                    emojifiedText.append(character);
+                }
+                position++;
+            }
+            continue;
+        }
+
+        // Only keycaps start with ASCII characters, all other emoji are outside of it
+        const ushort unicode = character.unicode();
+        const bool candidate = unicode >= 0x80 || unicode == '#' || unicode == '*' || (unicode >= '0' && unicode <= '9');
+        const int matchLength = (withImages && candidate) ? matchEmoji(text, position, iconName) : 0;
+        if (matchLength > 0) {
+            emojifiedText.append(QLatin1String("<img src=\"../js/emoji/"));
+            emojifiedText.append(iconName);
+            emojifiedText.append(QLatin1String(".svg\" align=\"middle\" width=\""));
+            emojifiedText.append(imageSize);
+            emojifiedText.append(QLatin1String("\" height=\""));
+            emojifiedText.append(imageSize);
+            emojifiedText.append(QLatin1String("\"/>"));
+            position += matchLength;
+        } else {
+            emojifiedText.append(character);
+            position++;
+        }
+    }
+    return emojifiedText;
+}
@@ -0,0 +1,61 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef EMOJIMATCHER_H
+#define EMOJIMATCHER_H
+
+#include <QString>
+#include <QVector>
+
+/*
+ * Replaces emoji by the bundled emoji images in a single pass over the text. The emoji are
+ * taken from a table which is generated from the images at build time and cover ZWJ sequences,
+ * skin tones, flags and keycaps. Emoji variation selectors are optional like with twemoji.
+ */
+class EmojiMatcher
+{
+public:
+    static const EmojiMatcher &getInstance();
+
+    // Returns rich text for StyledText, with images of the given size if withImages is set
+    QString emojify(const QString &text, const int &emojiSize, const bool &withImages = true) const;
+    // Returns the length of the emoji starting at the given position or 0 if there is none
+    int getEmojiLength(const QString &text, const int &position) const;
+
+private:
+    EmojiMatcher();
+
+    // Trie over code points, the children of a node are sorted by code point
+    struct Node {
+        int firstEdge;
+        int edgeCount;
+        bool terminal;
+    };
+    struct Edge {
+        uint codePoint;
+        int node;
+    };
+
+    QVector<Node> nodes;
+    QVector<Edge> edges;
+
+    int findChild(const int &node, const uint &codePoint) const;
+    int matchEmoji(const QString &text, const int &position, QString &iconName) const;
+};
+
+#endif // EMOJIMATCHER_H
@@ -43,13 +43,29 @@
 #include "ownlistsmodel.h"
 #include "membershiplistsmodel.h"
 #include "savedsearchesmodel.h"
+#include "mergedtimelinemodel.h"
+#include "tweetlengthcounter.h"
+#include "relativetime.h"
+#include "notificationpoller.h"
 //#include "wagnis/wagnis.h"
 
 int main(int argc, char *argv[])
 {
+    // Headless mode, only checks all accounts for new mentions and messages
+    if (argc > 1 && qstrcmp(argv[1], "--poll") == 0) {
+        QCoreApplication app(argc, argv);
+        app.setOrganizationName("harbour-piepmatz");
+        app.setApplicationName("harbour-piepmatz");
+        NotificationPoller notificationPoller;
+        notificationPoller.start();
+        return app.exec();
+    }
+
     QScopedPointer<QGuiApplication> app(SailfishApp::application(argc, argv));
     QScopedPointer<QQuickView> view(SailfishApp::createView());
 
+    qmlRegisterType<RelativeTime>("harbour.piepmatz", 1, 0, "RelativeTime");
+
     QQmlContext *context = view.data()->rootContext();
     AccountModel accountModel;
     context->setContextProperty("accountModel", &accountModel);
@@ -63,9 +79,18 @@ int main(int argc, char *argv[])
 //    Wagnis *wagnis = accountModel.getWagnis();
 //    context->setContextProperty("wagnis", wagnis);
 
-    TimelineModel timelineModel(twitterApi);
-    context->setContextProperty("timelineModel", &timelineModel);
-    context->setContextProperty("coverModel", timelineModel.coverModel);
+    // Timelines, mentions and lists are kept by the session of each account, the ones of the active account are shown
+    auto setSessionModels = [context, &accountModel]() {
+        AccountSession *activeSession = accountModel.getActiveSession();
+        context->setContextProperty("timelineModel", activeSession->getTimelineModel());
+        context->setContextProperty("coverModel", activeSession->getTimelineModel()->coverModel);
+        context->setContextProperty("mentionsModel", activeSession->getMentionsModel());
+        context->setContextProperty("ownListsModel", activeSession->getOwnListsModel());
+        context->setContextProperty("membershipListsModel", activeSession->getMembershipListsModel());
+        context->setContextProperty("mergedTimelineModel", activeSession->getMergedTimelineModel());
+    };
+    setSessionModels();
+    QObject::connect(&accountModel, &AccountModel::activeSessionChanged, setSessionModels);
 
     SearchModel searchModel(twitterApi);
     context->setContextProperty("searchModel", &searchModel);
@@ -73,27 +98,21 @@ int main(int argc, char *argv[])
     SearchUsersModel searchUsersModel(twitterApi);
     context->setContextProperty("searchUsersModel", &searchUsersModel);
 
-    MentionsModel mentionsModel(twitterApi, accountModel);
-    context->setContextProperty("mentionsModel", &mentionsModel);
-
     ImagesModel imagesModel(twitterApi);
     context->setContextProperty("imagesModel", &imagesModel);
 
-    DirectMessagesModel directMessagesModel(twitterApi);
+    DirectMessagesModel directMessagesModel(twitterApi, accountModel);
     context->setContextProperty("directMessagesModel", &directMessagesModel);
 
     TrendsModel trendsModel(twitterApi);
     context->setContextProperty("trendsModel", &trendsModel);
 
-    OwnListsModel ownListsModel(twitterApi);
-    context->setContextProperty("ownListsModel", &ownListsModel);
-
-    MembershipListsModel membershipListsModel(twitterApi);
-    context->setContextProperty("membershipListsModel", &membershipListsModel);
-
     SavedSearchesModel savedSearchesModel(twitterApi);
     context->setContextProperty("savedSearchesModel", &savedSearchesModel);
 
+    TweetLengthCounter tweetLengthCounter;
+    context->setContextProperty("tweetLengthCounter", &tweetLengthCounter);
+
     view->setSource(SailfishApp::pathTo("qml/harbour-piepmatz.qml"));
     view->show();
     return app->exec();
@@ -0,0 +1,145 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "htmlcharsetdecoder.h"
+
+#include <QDebug>
+#include <QRegularExpression>
+#include <QTextCodec>
+#include <QTextDecoder>
+
+// As in the HTML specification, meta declarations are only looked for at the very beginning
+const int CHARSET_PRESCAN_BYTES = 1024;
+
+namespace {
+
+QByteArray findCharsetParameter(const QString &text)
+{
+    QRegularExpression charsetExpression("charset\\s*=\\s*[\"']?\\s*([A-Za-z0-9_:.+-]+)", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch charsetMatch = charsetExpression.match(text);
+    if (charsetMatch.hasMatch()) {
+        return charsetMatch.captured(1).toUpper().toLatin1();
+    }
+    return QByteArray();
+}
+
+QByteArray findMetaCharset(const QByteArray &head)
+{
+    // Both <meta charset="..."> and <meta http-equiv="Content-Type" content="...; charset=...">
+    QRegularExpression metaExpression("<meta\\s[^>]*charset[^>]*>", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch metaMatch = metaExpression.match(QString::fromLatin1(head));
+    if (metaMatch.hasMatch()) {
+        return findCharsetParameter(metaMatch.captured(0));
+    }
+    return QByteArray();
+}
+
+}
+
+HtmlCharsetDecoder::HtmlCharsetDecoder(const QString &contentType)
+{
+    this->headerCharset = findCharsetParameter(contentType);
+    this->decoder = nullptr;
+    this->passthrough = false;
+    this->charsetDetermined = false;
+}
+
+HtmlCharsetDecoder::~HtmlCharsetDecoder()
+{
+    delete this->decoder;
+}
+
+QByteArray HtmlCharsetDecoder::decode(const QByteArray &data)
+{
+    if (this->charsetDetermined) {
+        return convert(data);
+    }
+    this->pendingData.append(data);
+    if (!determineCharset(false)) {
+        return QByteArray();
+    }
+    QByteArray pendingData = this->pendingData;
+    this->pendingData.clear();
+    return convert(pendingData);
+}
+
+QByteArray HtmlCharsetDecoder::finish()
+{
+    if (this->charsetDetermined) {
+        return QByteArray();
+    }
+    determineCharset(true);
+    QByteArray pendingData = this->pendingData;
+    this->pendingData.clear();
+    return convert(pendingData);
+}
+
+QByteArray HtmlCharsetDecoder::getCharset() const
+{
+    return this->charset;
+}
+
+bool HtmlCharsetDecoder::determineCharset(const bool &endOfData)
+{
+    // A byte order mark beats everything else, but we need to see the first bytes for it
+    if (this->pendingData.size() < 3 && !endOfData) {
+        return false;
+    }
+    if (this->pendingData.startsWith("\xEF\xBB\xBF")) {
+        this->charset = "UTF-8";
+        this->pendingData.remove(0, 3);
+    } else if (this->pendingData.startsWith("\xFE\xFF")) {
+        this->charset = "UTF-16BE";
+        this->pendingData.remove(0, 2);
+    } else if (this->pendingData.startsWith("\xFF\xFE")) {
+        this->charset = "UTF-16LE";
+        this->pendingData.remove(0, 2);
+    } else if (!this->headerCharset.isEmpty()) {
+        this->charset = this->headerCharset;
+    } else {
+        if (this->pendingData.size() < CHARSET_PRESCAN_BYTES && !endOfData) {
+            return false;
+        }
+        this->charset = findMetaCharset(this->pendingData.left(CHARSET_PRESCAN_BYTES));
+        if (this->charset.isEmpty()) {
+            this->charset = "UTF-8";
+        }
+    }
+
+    QTextCodec *codec = QTextCodec::codecForName(this->charset);
+    if (!codec) {
+        qDebug() << "HtmlCharsetDecoder: Unknown charset" << this->charset << "- assuming UTF-8";
+        codec = QTextCodec::codecForName("UTF-8");
+        this->charset = "UTF-8";
+    }
+    this->passthrough = (codec->mibEnum() == 106);
+    if (!this->passthrough) {
+        this->decoder = codec->makeDecoder();
+    }
+    this->charsetDetermined = true;
+    qDebug() << "HtmlCharsetDecoder: Using charset" << this->charset;
+    return true;
+}
+
+QByteArray HtmlCharsetDecoder::convert(const QByteArray &data)
+{
+    if (this->passthrough) {
+        return data;
+    }
+    return this->decoder->toUnicode(data).toUtf8();
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HTMLCHARSETDECODER_H
+#define HTMLCHARSETDECODER_H
+
+#include <QByteArray>
+#include <QString>
+
+class QTextCodec;
+class QTextDecoder;
+
+/*
+ * Turns an HTML document of any encoding into UTF-8 while it is being received.
+ * The encoding is taken from a byte order mark, the Content-Type header or a meta
+ * declaration within the first 1024 bytes, in this order. UTF-8 documents are
+ * passed through without being copied or transcoded.
+ */
+class HtmlCharsetDecoder
+{
+public:
+    explicit HtmlCharsetDecoder(const QString &contentType = QString());
+    ~HtmlCharsetDecoder();
+
+    // Returns the UTF-8 for everything which could be decoded so far
+    QByteArray decode(const QByteArray &data);
+    // Call at the end of the document, returns what is still buffered
+    QByteArray finish();
+
+    QByteArray getCharset() const;
+
+private:
+    HtmlCharsetDecoder(const HtmlCharsetDecoder&) = delete;
+    HtmlCharsetDecoder& operator=(const HtmlCharsetDecoder&) = delete;
+
+    QByteArray headerCharset;
+    QByteArray charset;
+    QByteArray pendingData;
+    QTextDecoder *decoder;
+    bool passthrough;
+    bool charsetDetermined;
+
+    bool determineCharset(const bool &endOfData);
+    QByteArray convert(const QByteArray &data);
+};
+
+#endif // HTMLCHARSETDECODER_H
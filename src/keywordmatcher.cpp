@@ -0,0 +1,125 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "keywordmatcher.h"
+
+#include <QQueue>
+#include <cstring>
+
+namespace {
+
+uchar toLowerAscii(const uchar &character)
+{
+    return (character >= 'A' && character <= 'Z') ? character + ('a' - 'A') : character;
+}
+
+}
+
+KeywordMatcher::KeywordMatcher()
+{
+    memset(byteClasses, 0, sizeof(byteClasses));
+    classCount = 1;
+}
+
+void KeywordMatcher::addKeyword(const QByteArray &keyword, const uint &categories)
+{
+    keywords.append(qMakePair(keyword, categories));
+}
+
+void KeywordMatcher::compile()
+{
+    memset(byteClasses, 0, sizeof(byteClasses));
+    classCount = 1;
+    for (const QPair<QByteArray, uint> &keyword : keywords) {
+        for (const char character : keyword.first) {
+            const uchar lowerCharacter = toLowerAscii(static_cast<uchar>(character));
+            if (byteClasses[lowerCharacter] == 0) {
+                byteClasses[lowerCharacter] = classCount++;
+            }
+        }
+    }
+    for (int character = 'A'; character <= 'Z'; character++) {
+        byteClasses[character] = byteClasses[character + ('a' - 'A')];
+    }
+
+    // The trie, state 0 is the root. As the root is nobody's child, 0 marks a missing transition for now.
+    transitions = QVector<int>(classCount, 0);
+    outputs = QVector<uint>(1, 0);
+    for (const QPair<QByteArray, uint> &keyword : keywords) {
+        int state = 0;
+        for (const char character : keyword.first) {
+            const int transition = state * classCount + byteClasses[static_cast<uchar>(character)];
+            if (transitions.at(transition) == 0) {
+                transitions[transition] = outputs.size();
+                transitions.resize(transitions.size() + classCount);
+                outputs.append(0);
+            }
+            state = transitions.at(transition);
+        }
+        outputs[state] |= keyword.second;
+    }
+
+    // Breadth-first, so that the failure state of every state is complete before its children are visited.
+    // Missing transitions are replaced by the ones of the failure state, which turns the trie into a DFA.
+    QVector<int> failures(outputs.size(), 0);
+    QQueue<int> pendingStates;
+    for (int byteClass = 0; byteClass < classCount; byteClass++) {
+        if (transitions.at(byteClass) != 0) {
+            pendingStates.enqueue(transitions.at(byteClass));
+        }
+    }
+    while (!pendingStates.isEmpty()) {
+        const int state = pendingStates.dequeue();
+        const int failureRow = failures.at(state) * classCount;
+        for (int byteClass = 0; byteClass < classCount; byteClass++) {
+            const int transition = state * classCount + byteClass;
+            const int child = transitions.at(transition);
+            if (child != 0) {
+                failures[child] = transitions.at(failureRow + byteClass);
+                outputs[child] |= outputs.at(failures.at(child));
+                pendingStates.enqueue(child);
+            } else {
+                transitions[transition] = transitions.at(failureRow + byteClass);
+            }
+        }
+    }
+}
+
+uint KeywordMatcher::match(const char *text, const int &length) const
+{
+    Q_ASSERT(!transitions.isEmpty());
+
+    const int *transitionTable = transitions.constData();
+    const uint *outputTable = outputs.constData();
+    const int spaceClass = byteClasses[static_cast<uchar>(' ')];
+
+    int state = transitionTable[spaceClass];
+    uint categories = outputTable[state];
+    for (int i = 0; i < length; i++) {
+        state = transitionTable[state * classCount + byteClasses[static_cast<uchar>(text[i])]];
+        categories |= outputTable[state];
+    }
+    state = transitionTable[state * classCount + spaceClass];
+    categories |= outputTable[state];
+    return categories;
+}
+
+uint KeywordMatcher::match(const QLatin1String &text) const
+{
+    return match(text.data(), text.size());
+}
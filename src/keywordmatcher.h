@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef KEYWORDMATCHER_H
+#define KEYWORDMATCHER_H
+
+#include <QByteArray>
+#include <QLatin1String>
+#include <QPair>
+#include <QVector>
+
+/*
+ * Finds any number of keywords in one pass over a piece of text (Aho-Corasick over bytes).
+ * Every keyword belongs to one or more categories, a match reports the categories of all
+ * keywords found. ASCII letters are compared case-insensitively. The text is matched as
+ * if it was surrounded by spaces, so a keyword like " hid " only matches the whole word.
+ */
+class KeywordMatcher
+{
+public:
+    KeywordMatcher();
+
+    void addKeyword(const QByteArray &keyword, const uint &categories);
+    // Builds the automaton, needs to be called after the last keyword was added and before matching
+    void compile();
+
+    uint match(const char *text, const int &length) const;
+    uint match(const QLatin1String &text) const;
+
+private:
+    QVector<QPair<QByteArray, uint> > keywords;
+    // Bytes which don't occur in any keyword share class 0
+    uchar byteClasses[256];
+    int classCount;
+    // Transition table of the automaton, one row of classCount entries per state
+    QVector<int> transitions;
+    QVector<uint> outputs;
+};
+
+#endif // KEYWORDMATCHER_H
@@ -0,0 +1,150 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "linkpreviewfetcher.h"
+
+#include "twitterapi.h"
+#include "opengraphcache.h"
+#include "opengraphresponsehandler.h"
+
+#include <QDebug>
+#include <QNetworkRequest>
+#include <QUrl>
+
+// Number of link previews which are retrieved in parallel
+const int MAX_RUNNING_PREVIEW_REQUESTS = 3;
+
+LinkPreviewFetcher::LinkPreviewFetcher(TwitterApi *twitterApi) : QObject(twitterApi)
+{
+    this->twitterApi = twitterApi;
+    this->manager = new QNetworkAccessManager(this);
+    this->byteBudget = 0;
+    this->bytesConsumed = 0;
+}
+
+void LinkPreviewFetcher::fetch(const QString &address, const int &priority)
+{
+    PendingRequest pendingRequest;
+    pendingRequest.address = address;
+    pendingRequest.canonicalUrl = OpenGraphCache::getCanonicalUrl(address);
+    pendingRequest.priority = priority;
+    enqueue(pendingRequest);
+    startPendingRequests();
+}
+
+void LinkPreviewFetcher::raisePriority(const QString &address, const int &priority)
+{
+    QString canonicalUrl = OpenGraphCache::getCanonicalUrl(address);
+    for (int i = 0; i < pendingRequests.size(); i++) {
+        if (pendingRequests.at(i).canonicalUrl == canonicalUrl) {
+            // Asked for again, so it is most likely visible right now
+            PendingRequest pendingRequest = pendingRequests.takeAt(i);
+            pendingRequest.priority = qMax(pendingRequest.priority, priority);
+            enqueue(pendingRequest);
+            return;
+        }
+    }
+}
+
+void LinkPreviewFetcher::cancel(const QString &address)
+{
+    QString canonicalUrl = OpenGraphCache::getCanonicalUrl(address);
+    for (int i = 0; i < pendingRequests.size(); i++) {
+        if (pendingRequests.at(i).canonicalUrl == canonicalUrl) {
+            qDebug() << "LinkPreviewFetcher: Cancelled pending request for" << address;
+            pendingRequests.removeAt(i);
+            return;
+        }
+    }
+    QNetworkReply *reply = runningReplies.value(canonicalUrl);
+    if (reply) {
+        qDebug() << "LinkPreviewFetcher: Aborting request for" << address;
+        reply->abort();
+    }
+}
+
+void LinkPreviewFetcher::setByteBudget(const qint64 &byteBudget)
+{
+    this->byteBudget = byteBudget;
+}
+
+void LinkPreviewFetcher::resetByteBudget()
+{
+    this->bytesConsumed = 0;
+    startPendingRequests();
+}
+
+void LinkPreviewFetcher::handleDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    Q_UNUSED(bytesTotal);
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    this->bytesConsumed += bytesReceived - replyBytesReceived.value(reply);
+    replyBytesReceived.insert(reply, bytesReceived);
+}
+
+void LinkPreviewFetcher::handleFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    replyBytesReceived.remove(reply);
+    runningReplies.remove(runningReplies.key(reply));
+    startPendingRequests();
+}
+
+void LinkPreviewFetcher::enqueue(const PendingRequest &pendingRequest)
+{
+    int position = 0;
+    while (position < pendingRequests.size() && pendingRequests.at(position).priority > pendingRequest.priority) {
+        position++;
+    }
+    pendingRequests.insert(position, pendingRequest);
+}
+
+void LinkPreviewFetcher::startPendingRequests()
+{
+    while (!pendingRequests.isEmpty() && runningReplies.size() < MAX_RUNNING_PREVIEW_REQUESTS) {
+        PendingRequest pendingRequest = pendingRequests.takeFirst();
+        if (this->byteBudget > 0 && this->bytesConsumed >= this->byteBudget) {
+            qDebug() << "LinkPreviewFetcher: Byte budget exhausted, skipping" << pendingRequest.address;
+            twitterApi->deliverOpenGraphError(pendingRequest.address, "Link preview budget exhausted for " + pendingRequest.address, false);
+            continue;
+        }
+        startRequest(pendingRequest);
+    }
+}
+
+void LinkPreviewFetcher::startRequest(const PendingRequest &pendingRequest)
+{
+    qDebug() << "LinkPreviewFetcher::startRequest" << pendingRequest.address << pendingRequest.priority;
+    QUrl url = QUrl(pendingRequest.address);
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0 (Wayland; SailfishOS) Piepmatz (Not Firefox/52.0)");
+    request.setRawHeader(QByteArray("Accept"), QByteArray("text/html,application/xhtml+xml"));
+    request.setRawHeader(QByteArray("Accept-Charset"), QByteArray("utf-8"));
+    QNetworkReply *reply = manager->get(request);
+    runningReplies.insert(pendingRequest.canonicalUrl, reply);
+
+    OpenGraphResponseHandler *openGraphResponseHandler = new OpenGraphResponseHandler(pendingRequest.address, twitterApi);
+    openGraphResponseHandler->setParent(reply);
+
+    connect(reply, SIGNAL(readyRead()), openGraphResponseHandler, SLOT(handleOpenGraphReadyRead()));
+    connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), openGraphResponseHandler, SLOT(handleOpenGraphError(QNetworkReply::NetworkError)));
+    connect(reply, SIGNAL(finished()), openGraphResponseHandler, SLOT(handleOpenGraphFinished()));
+    connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(handleDownloadProgress(qint64,qint64)));
+    connect(reply, SIGNAL(finished()), this, SLOT(handleFinished()));
+}
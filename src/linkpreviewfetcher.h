@@ -0,0 +1,71 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LINKPREVIEWFETCHER_H
+#define LINKPREVIEWFETCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QString>
+
+class TwitterApi;
+
+// Retrieves link previews through its own network access manager, only a few at a time and most relevant first
+class LinkPreviewFetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LinkPreviewFetcher(TwitterApi *twitterApi);
+
+    void fetch(const QString &address, const int &priority);
+    void raisePriority(const QString &address, const int &priority);
+    void cancel(const QString &address);
+
+    // A budget of 0 means no limit, the budget is consumed until resetByteBudget() is called
+    void setByteBudget(const qint64 &byteBudget);
+    void resetByteBudget();
+
+private slots:
+    void handleDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void handleFinished();
+
+private:
+    struct PendingRequest {
+        QString address;
+        QString canonicalUrl;
+        int priority;
+    };
+
+    TwitterApi *twitterApi;
+    QNetworkAccessManager *manager;
+    // Ordered by priority, requests with the same priority are ordered from newest to oldest
+    QList<PendingRequest> pendingRequests;
+    QHash<QString, QNetworkReply *> runningReplies;
+    QHash<QNetworkReply *, qint64> replyBytesReceived;
+    qint64 byteBudget;
+    qint64 bytesConsumed;
+
+    void enqueue(const PendingRequest &pendingRequest);
+    void startPendingRequests();
+    void startRequest(const PendingRequest &pendingRequest);
+};
+
+#endif // LINKPREVIEWFETCHER_H
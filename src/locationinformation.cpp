@@ -22,7 +22,7 @@
 
 const char SETTINGS_POSITIONING[] = "settings/positioning";
 
-LocationInformation::LocationInformation(QObject *parent) : QObject(parent), settings("harbour-piepmatz", "settings")
+LocationInformation::LocationInformation(QSettings *settings, QObject *parent) : QObject(parent), settings(settings)
 {
     qDebug() << "Initializing location services...";
     source = QGeoPositionInfoSource::createDefaultSource(this);
@@ -36,6 +36,11 @@ LocationInformation::LocationInformation(QObject *parent) : QObject(parent), set
     }
 }
 
+void LocationInformation::setSettings(QSettings *settings)
+{
+    this->settings = settings;
+}
+
 bool LocationInformation::hasInformation()
 {
     return !this->currentPosition.isEmpty();
@@ -43,7 +48,7 @@ bool LocationInformation::hasInformation()
 
 bool LocationInformation::isEnabled()
 {
-    return settings.value(SETTINGS_POSITIONING, true).toBool();
+    return settings->value(SETTINGS_POSITIONING, true).toBool();
 }
 
 void LocationInformation::setEnabled(const bool &enabled)
@@ -56,7 +61,7 @@ void LocationInformation::setEnabled(const bool &enabled)
             this->currentPosition.clear();
         }
     }
-    settings.setValue(SETTINGS_POSITIONING, enabled);
+    settings->setValue(SETTINGS_POSITIONING, enabled);
 }
 
 QVariantMap LocationInformation::getCurrentPosition()
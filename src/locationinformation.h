@@ -28,7 +28,10 @@ class LocationInformation : public QObject
 {
     Q_OBJECT
 public:
-    explicit LocationInformation(QObject *parent = 0);
+    explicit LocationInformation(QSettings *settings, QObject *parent = 0);
+
+    // The settings of the active account
+    void setSettings(QSettings *settings);
 
     Q_INVOKABLE bool hasInformation();
     Q_INVOKABLE bool isEnabled();
@@ -45,7 +48,7 @@ private slots:
 
 private:
     QGeoPositionInfoSource *source;
-    QSettings settings;
+    QSettings *settings;
     QVariantMap currentPosition;
     int updateCount;
     bool enabled;
@@ -21,8 +21,17 @@
 MembershipListsModel::MembershipListsModel(TwitterApi *twitterApi)
 {
     this->twitterApi = twitterApi;
-    connect(twitterApi, &TwitterApi::listsMembershipsSuccessful, this, &MembershipListsModel::handleMembershipListsSuccessful);
-    connect(twitterApi, &TwitterApi::listsMembershipsError, this, &MembershipListsModel::handleMembershipListsError);
+}
+
+void MembershipListsModel::setActive(const bool &active)
+{
+    if (active) {
+        connect(twitterApi, &TwitterApi::listsMembershipsSuccessful, this, &MembershipListsModel::handleMembershipListsSuccessful, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::listsMembershipsError, this, &MembershipListsModel::handleMembershipListsError, Qt::UniqueConnection);
+    } else {
+        disconnect(twitterApi, nullptr, this, nullptr);
+        this->updateInProgress = false;
+    }
 }
 
 int MembershipListsModel::rowCount(const QModelIndex &) const
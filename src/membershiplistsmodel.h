@@ -29,6 +29,8 @@ class MembershipListsModel : public QAbstractListModel
 public:
     MembershipListsModel(TwitterApi *twitterApi);
 
+    void setActive(const bool &active);
+
     virtual int rowCount(const QModelIndex &) const;
     virtual QVariant data(const QModelIndex &index, int role) const;
 
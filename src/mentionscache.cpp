@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "mentionscache.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+
+// One connection per account, the poller keeps the caches of all accounts open at the same time
+const char MENTIONS_DATABASE_CONNECTION[] = "mentions:%1";
+const int MENTIONS_CACHE_SIZE = 200;
+
+MentionsCache::MentionsCache(const QString &dataDirectory, QObject *parent) : QObject(parent)
+{
+    initializeDatabase(dataDirectory);
+}
+
+MentionsCache::~MentionsCache()
+{
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+QVariantList MentionsCache::getMentions()
+{
+    QVariantList mentions;
+    if (!database.isOpen()) {
+        return mentions;
+    }
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("select tweet from mentions order by id desc limit (:limit)");
+    databaseQuery.bindValue(":limit", MENTIONS_CACHE_SIZE);
+    if (!databaseQuery.exec()) {
+        qDebug() << "Error selecting mentions!" << databaseQuery.lastError().text();
+        return mentions;
+    }
+    while (databaseQuery.next()) {
+        QJsonDocument tweetDocument = QJsonDocument::fromJson(databaseQuery.value(0).toByteArray());
+        if (tweetDocument.isObject()) {
+            mentions.append(tweetDocument.object().toVariantMap());
+        }
+    }
+    return mentions;
+}
+
+void MentionsCache::insert(const QVariantList &mentions)
+{
+    if (!database.isOpen() || mentions.isEmpty()) {
+        return;
+    }
+    database.transaction();
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("insert or replace into mentions values((:id), (:tweet))");
+    for (const QVariant &mention : mentions) {
+        const QVariantMap mentionMap = mention.toMap();
+        databaseQuery.bindValue(":id", mentionMap.value("id_str").toLongLong());
+        databaseQuery.bindValue(":tweet", QJsonDocument(QJsonObject::fromVariantMap(mentionMap)).toJson(QJsonDocument::Compact));
+        if (!databaseQuery.exec()) {
+            qDebug() << "Error storing mention " + mentionMap.value("id_str").toString() << databaseQuery.lastError().text();
+        }
+    }
+    databaseQuery.prepare("delete from mentions where id not in (select id from mentions order by id desc limit (:limit))");
+    databaseQuery.bindValue(":limit", MENTIONS_CACHE_SIZE);
+    if (!databaseQuery.exec()) {
+        qDebug() << "Error removing old mentions!" << databaseQuery.lastError().text();
+    }
+    database.commit();
+}
+
+void MentionsCache::initializeDatabase(const QString &dataDirectory)
+{
+    qDebug() << "MentionsCache::initializeDatabase" << dataDirectory;
+    QDir().mkpath(dataDirectory);
+    QString databaseFilePath = dataDirectory + "/cache.db";
+    connectionName = QString(MENTIONS_DATABASE_CONNECTION).arg(dataDirectory);
+    database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    database.setDatabaseName(databaseFilePath);
+    if (!database.open()) {
+        qDebug() << "Error opening SQLite database " + databaseFilePath + ", mentions are not cached";
+        return;
+    }
+
+    if (!database.tables().contains("mentions")) {
+        QSqlQuery databaseQuery(database);
+        if (databaseQuery.exec("create table mentions (id integer primary key, tweet text)")) {
+            qDebug() << "Mentions table successfully created!";
+        } else {
+            qDebug() << "Error creating mentions table!" << databaseQuery.lastError().text();
+        }
+    }
+}
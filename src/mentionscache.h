@@ -0,0 +1,46 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef MENTIONSCACHE_H
+#define MENTIONSCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QVariantList>
+#include <QSqlDatabase>
+
+// Keeps the latest mentions of an account in the cache database of its data directory, shared by the app and the background poller
+class MentionsCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MentionsCache(const QString &dataDirectory, QObject *parent = nullptr);
+    ~MentionsCache();
+
+    // Newest first
+    QVariantList getMentions();
+    void insert(const QVariantList &mentions);
+
+private:
+    QSqlDatabase database;
+    QString connectionName;
+
+    void initializeDatabase(const QString &dataDirectory);
+};
+
+#endif // MENTIONSCACHE_H
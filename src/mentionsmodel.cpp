@@ -27,34 +27,42 @@ const char SETTINGS_LAST_MENTION[] = "mentions/lastId";
 const char SETTINGS_LAST_RETWEET[] = "retweets/lastId";
 const char SETTINGS_LAST_FOLLOWER_COUNT[] = "lastFollowerCount";
 const char SETTINGS_LAST_KNOWN_FOLLOWERS[] = "lastKnownFollowers";
+const char FOLLOWERS_DATABASE_CONNECTION[] = "followers:%1";
 // We generate this amount of named follower entries maximum...
 const int SETTINGS_MAX_NAMED_FOLLOWERS = 25;
 
-MentionsModel::MentionsModel(TwitterApi *twitterApi, AccountModel &accountModel) : settings("harbour-piepmatz", "settings")
+MentionsModel::MentionsModel(TwitterApi *twitterApi, AccountSession *session) : settings(session->getSettings())
 {
     this->twitterApi = twitterApi;
-    this->screenName = accountModel.getCurrentAccount().value("screen_name").toString();
-    this->accountModel = &accountModel;
+    this->session = session;
     resetStatus();
     initializeDatabase();
-
-    connect(twitterApi, &TwitterApi::mentionsTimelineError, this, &MentionsModel::handleUpdateMentionsError);
-    connect(twitterApi, &TwitterApi::mentionsTimelineSuccessful, this, &MentionsModel::handleUpdateMentionsSuccessful);
-    connect(twitterApi, &TwitterApi::retweetTimelineError, this, &MentionsModel::handleUpdateRetweetsError);
-    connect(twitterApi, &TwitterApi::retweetTimelineSuccessful, this, &MentionsModel::handleUpdateRetweetsSuccessful);
-    connect(twitterApi, &TwitterApi::retweetsForError, this, &MentionsModel::handleRetweetsForError);
-    connect(twitterApi, &TwitterApi::retweetsForSuccessful, this, &MentionsModel::handleRetweetsForSuccessful);
-    connect(twitterApi, &TwitterApi::followersError, this, &MentionsModel::handleFollowersError);
-    connect(twitterApi, &TwitterApi::followersSuccessful, this, &MentionsModel::handleFollowersSuccessful);
-    connect(twitterApi, &TwitterApi::verifyCredentialsError, this, &MentionsModel::handleVerifyCredentialsError);
-    connect(twitterApi, &TwitterApi::verifyCredentialsSuccessful, this, &MentionsModel::handleVerifyCredentialsSuccessful);
-    connect(this->accountModel, &AccountModel::accountSwitched, this, &MentionsModel::handleAccountSwitched);
 }
 
 MentionsModel::~MentionsModel()
 {
     qDebug() << "MentionsModel::destroy";
-    database.close();
+    closeDatabase();
+}
+
+void MentionsModel::setActive(const bool &active)
+{
+    if (active) {
+        connect(twitterApi, &TwitterApi::mentionsTimelineError, this, &MentionsModel::handleUpdateMentionsError, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::mentionsTimelineSuccessful, this, &MentionsModel::handleUpdateMentionsSuccessful, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::retweetTimelineError, this, &MentionsModel::handleUpdateRetweetsError, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::retweetTimelineSuccessful, this, &MentionsModel::handleUpdateRetweetsSuccessful, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::retweetsForError, this, &MentionsModel::handleRetweetsForError, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::retweetsForSuccessful, this, &MentionsModel::handleRetweetsForSuccessful, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::followersError, this, &MentionsModel::handleFollowersError, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::followersSuccessful, this, &MentionsModel::handleFollowersSuccessful, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::verifyCredentialsError, this, &MentionsModel::handleVerifyCredentialsError, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::verifyCredentialsSuccessful, this, &MentionsModel::handleVerifyCredentialsSuccessful, Qt::UniqueConnection);
+    } else {
+        disconnect(twitterApi, nullptr, this, nullptr);
+        // An update which is still running can't be completed with the results of another account
+        resetStatus();
+    }
 }
 
 int MentionsModel::rowCount(const QModelIndex &) const
@@ -77,12 +85,12 @@ void MentionsModel::update()
     twitterApi->mentionsTimeline();
     // Protected accounts don't have retweets and are also not allowed to fetch them
     // Even if there might be ones from times when the account wasn't protected...
-    if (this->accountModel->getCurrentAccount().value("protected").toBool()) {
+    if (this->session->getAccount().value("protected").toBool()) {
         this->retweetsUpdated = true;
     } else {
         twitterApi->retweetTimeline();
     }
-    twitterApi->followers(this->screenName);
+    twitterApi->followers(this->session->getScreenName());
     twitterApi->verifyCredentials();
 }
 
@@ -199,12 +207,6 @@ void MentionsModel::handleVerifyCredentialsError(const QString &errorMessage)
     handleUpdateError(errorMessage);
 }
 
-void MentionsModel::handleAccountSwitched()
-{
-    resetStatus();
-    initializeDatabase();
-}
-
 void MentionsModel::handleUpdateError(const QString &errorMessage)
 {
     qDebug() << "MentionsModel::handleUpdateError";
@@ -239,7 +241,7 @@ void MentionsModel::handleUpdateSuccessful()
 void MentionsModel::resetStatus()
 {
     qDebug() << "MentionsModel::resetStatus";
-    this->settings.sync();
+    this->settings->sync();
     this->newNamedFollowerCount = 0;
     this->newGeneralFollowerCount = 0;
     this->retweetsCount = 0;
@@ -254,9 +256,12 @@ void MentionsModel::resetStatus()
 void MentionsModel::initializeDatabase()
 {
     qDebug() << "MentionsModel::initializeDatabase";
-    QString databaseDirectory = getDirectory(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz");
+    // Each account keeps its known followers in its own data directory
+    QString databaseDirectory = getDirectory(session->getDataDirectory());
     QString databaseFilePath = databaseDirectory + "/cache.db";
-    database = QSqlDatabase::addDatabase("QSQLITE");
+    // The models of all sessions stay open at the same time
+    connectionName = QString(FOLLOWERS_DATABASE_CONNECTION).arg(databaseFilePath);
+    database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     database.setDatabaseName(databaseFilePath);
     if (database.open()) {
         qDebug() << "SQLite database " + databaseFilePath + " successfully opened";
@@ -265,6 +270,22 @@ void MentionsModel::initializeDatabase()
     } else {
         qDebug() << "Error opening SQLite database " + databaseFilePath;
     }
+
+    // Mentions which were received before, possibly by the background poller, are shown until the next update
+    this->mentionsCache = new MentionsCache(databaseDirectory, this);
+    beginResetModel();
+    mentions = mentionsCache->getMentions();
+    endResetModel();
+}
+
+void MentionsModel::closeDatabase()
+{
+    if (!database.isValid()) {
+        return;
+    }
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
 }
 
 QString MentionsModel::getDirectory(const QString &directoryString)
@@ -301,7 +322,7 @@ void MentionsModel::processRawMentions()
 {
     qDebug() << "MentionsModel::processRawMentions";
     if (!rawMentions.isEmpty()) {
-        QString storedMentionId = settings.value(SETTINGS_LAST_MENTION).toString();
+        QString storedMentionId = settings->value(SETTINGS_LAST_MENTION).toString();
         if (!storedMentionId.isEmpty()) {
             QListIterator<QVariant> rawMentionsIterator(rawMentions);
             int newMentions = 0;
@@ -321,19 +342,20 @@ void MentionsModel::processRawMentions()
                 }
             }
         }
-        settings.setValue(SETTINGS_LAST_MENTION, rawMentions.first().toMap().value("id_str").toString());
+        settings->setValue(SETTINGS_LAST_MENTION, rawMentions.first().toMap().value("id_str").toString());
+        mentionsCache->insert(rawMentions);
     }
 }
 
 void MentionsModel::processCredentials()
 {
     qDebug() << "MentionsModel::processCredentials";
-    int lastFollowerCount = settings.value(SETTINGS_LAST_FOLLOWER_COUNT).toInt();
+    int lastFollowerCount = settings->value(SETTINGS_LAST_FOLLOWER_COUNT).toInt();
     int currentFollowerCount = myAccount.value("followers_count").toInt();
     if (lastFollowerCount > 0 && lastFollowerCount < currentFollowerCount) {
         this->newGeneralFollowerCount = currentFollowerCount - lastFollowerCount;
     }
-    settings.setValue(SETTINGS_LAST_FOLLOWER_COUNT, currentFollowerCount);
+    settings->setValue(SETTINGS_LAST_FOLLOWER_COUNT, currentFollowerCount);
 }
 
 void MentionsModel::processRawFollowers()
@@ -344,7 +366,7 @@ void MentionsModel::processRawFollowers()
     databaseQuery.prepare("insert into followers values((:id),(:name),(:screen_name),(:image_url), CURRENT_TIMESTAMP)");
 
     QVariantList currentFollowers = rawFollowers.value("users").toList();
-    QStringList lastKnownFollowers = settings.value(SETTINGS_LAST_KNOWN_FOLLOWERS).toStringList();
+    QStringList lastKnownFollowers = settings->value(SETTINGS_LAST_KNOWN_FOLLOWERS).toStringList();
     if (!lastKnownFollowers.isEmpty()) {
         QListIterator<QVariant> currentFollowersIterator(currentFollowers);
         int i = 0;
@@ -380,7 +402,7 @@ void MentionsModel::processRawFollowers()
             currentLastFollowers.append(lastFollower);
         }
     }
-    settings.setValue(SETTINGS_LAST_KNOWN_FOLLOWERS, currentLastFollowers);
+    settings->setValue(SETTINGS_LAST_KNOWN_FOLLOWERS, currentLastFollowers);
 
 }
 
@@ -389,7 +411,7 @@ void MentionsModel::processRawRetweets()
     qDebug() << "MentionsModel::processRawRetweets";
     if (!rawRetweets.isEmpty()) {
         qSort(rawRetweets.begin(), rawRetweets.end(), compareMentions);
-        QString storedRetweetId = settings.value(SETTINGS_LAST_RETWEET).toString();
+        QString storedRetweetId = settings->value(SETTINGS_LAST_RETWEET).toString();
         if (!storedRetweetId.isEmpty()) {
             QListIterator<QVariant> rawRetweetIterator(rawRetweets);
             int newRetweets = 0;
@@ -409,7 +431,7 @@ void MentionsModel::processRawRetweets()
                 }
             }
         }
-        settings.setValue(SETTINGS_LAST_RETWEET, rawRetweets.first().toMap().value("id_str").toString());
+        settings->setValue(SETTINGS_LAST_RETWEET, rawRetweets.first().toMap().value("id_str").toString());
     }
 }
 
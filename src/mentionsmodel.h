@@ -25,15 +25,18 @@
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include "twitterapi.h"
-#include "accountmodel.h"
+#include "accountsession.h"
+#include "mentionscache.h"
 
 class MentionsModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
-    MentionsModel(TwitterApi *twitterApi, AccountModel &accountModel);
+    MentionsModel(TwitterApi *twitterApi, AccountSession *session);
     ~MentionsModel();
 
+    void setActive(const bool &active);
+
     virtual int rowCount(const QModelIndex&) const;
     virtual QVariant data(const QModelIndex &index, int role) const;
 
@@ -57,7 +60,6 @@ public slots:
     void handleFollowersError(const QString &errorMessage);
     void handleVerifyCredentialsSuccessful(const QVariantMap &result);
     void handleVerifyCredentialsError(const QString &errorMessage);
-    void handleAccountSwitched();
 
 private:
 
@@ -66,6 +68,7 @@ private:
     void resetStatus();
 
     void initializeDatabase();
+    void closeDatabase();
     QString getDirectory(const QString &directoryString);
     void createFollowersTable(const QStringList &existingTables);
 
@@ -76,14 +79,15 @@ private:
     void getFollowersFromDatabase();
 
     QVariantList mentions;
-    QSettings settings;
+    QSettings *settings;
     QSqlDatabase database;
+    QString connectionName;
+    MentionsCache *mentionsCache;
     TwitterApi *twitterApi;
-    AccountModel *accountModel;
+    AccountSession *session;
 
     QVariantList followersFromDatabase;
 
-    QString screenName;
     bool updateInProgress;
     bool mentionsUpdated;
     QVariantList rawMentions;
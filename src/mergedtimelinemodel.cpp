@@ -0,0 +1,253 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "mergedtimelinemodel.h"
+
+#include <QDebug>
+#include <queue>
+#include <vector>
+
+namespace {
+
+const char SETTINGS_MERGED_TIMELINE_LISTS[] = "mergedTimeline/listIds";
+// Older tweets are dropped from the end of the timeline
+const int MAX_MERGED_TWEETS = 1000;
+
+qulonglong getTweetId(const QVariantMap &tweet)
+{
+    return tweet.value("id_str").toULongLong();
+}
+
+// Retweets are shown only once, no matter whether the original tweet or another retweet came first
+qulonglong getRelevantTweetId(const QVariantMap &tweet)
+{
+    const QVariantMap retweetedStatus = tweet.value("retweeted_status").toMap();
+    return retweetedStatus.isEmpty() ? getTweetId(tweet) : getTweetId(retweetedStatus);
+}
+
+struct MergeCursor {
+    qulonglong tweetId;
+    int source;
+    int position;
+
+    bool operator<(const MergeCursor &other) const
+    {
+        return tweetId < other.tweetId;
+    }
+};
+
+}
+
+MergedTimelineModel::MergedTimelineModel(TwitterApi *twitterApi, AccountSession *session) : settings(session->getSettings())
+{
+    this->twitterApi = twitterApi;
+    this->listIds = settings->value(SETTINGS_MERGED_TIMELINE_LISTS).toStringList();
+}
+
+MergedTimelineModel::~MergedTimelineModel()
+{
+}
+
+void MergedTimelineModel::setActive(const bool &active)
+{
+    if (active) {
+        connect(twitterApi, &TwitterApi::mergedTimelineSourceSuccessful, this, &MergedTimelineModel::handleMergedTimelineSourceSuccessful, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::mergedTimelineSourceError, this, &MergedTimelineModel::handleMergedTimelineSourceError, Qt::UniqueConnection);
+    } else {
+        disconnect(twitterApi, nullptr, this, nullptr);
+        // The merged tweets stay, but the sources of a running update won't report back anymore
+        pendingResults.clear();
+        pendingSources.clear();
+    }
+}
+
+int MergedTimelineModel::rowCount(const QModelIndex &) const
+{
+    return mergedTweets.size();
+}
+
+QVariant MergedTimelineModel::data(const QModelIndex &index, int role) const
+{
+    if (index.isValid() && role == Qt::DisplayRole) {
+        return QVariant(mergedTweets.value(index.row()));
+    }
+    return QVariant();
+}
+
+void MergedTimelineModel::update()
+{
+    qDebug() << "MergedTimelineModel::update";
+    if (!pendingSources.isEmpty()) {
+        qDebug() << "Merged timeline update already in progress";
+        return;
+    }
+    emit mergedTimelineStartUpdate();
+    QStringList sources = QStringList() << MERGED_TIMELINE_HOME_SOURCE << listIds;
+    for (const QString &sourceId : sources) {
+        pendingSources.insert(sourceId);
+    }
+    for (const QString &sourceId : sources) {
+        const qulonglong newestTweetId = newestTweetIds.value(sourceId);
+        twitterApi->mergedTimelineSource(sourceId, newestTweetId == 0 ? QString() : QString::number(newestTweetId));
+    }
+}
+
+QStringList MergedTimelineModel::getListIds()
+{
+    return listIds;
+}
+
+bool MergedTimelineModel::containsList(const QString &listId)
+{
+    return listIds.contains(listId);
+}
+
+void MergedTimelineModel::addList(const QString &listId)
+{
+    qDebug() << "MergedTimelineModel::addList" << listId;
+    if (!listIds.contains(listId)) {
+        listIds.append(listId);
+        settings->setValue(SETTINGS_MERGED_TIMELINE_LISTS, listIds);
+    }
+}
+
+void MergedTimelineModel::removeList(const QString &listId)
+{
+    qDebug() << "MergedTimelineModel::removeList" << listId;
+    if (listIds.removeAll(listId) > 0) {
+        settings->setValue(SETTINGS_MERGED_TIMELINE_LISTS, listIds);
+        resetSource(listId);
+    }
+}
+
+void MergedTimelineModel::handleMergedTimelineSourceSuccessful(const QString &sourceId, const QVariantList &result, const QString &newestTweetId)
+{
+    qDebug() << "MergedTimelineModel::handleMergedTimelineSourceSuccessful" << sourceId << result.size();
+    if (!pendingSources.remove(sourceId)) {
+        return;
+    }
+    if (!newestTweetId.isEmpty()) {
+        newestTweetIds.insert(sourceId, qMax(newestTweetIds.value(sourceId), newestTweetId.toULongLong()));
+    }
+    if (!result.isEmpty()) {
+        pendingResults.insert(sourceId, result);
+    }
+    if (pendingSources.isEmpty()) {
+        mergePendingResults();
+    }
+}
+
+void MergedTimelineModel::handleMergedTimelineSourceError(const QString &sourceId, const QString &errorMessage)
+{
+    qDebug() << "MergedTimelineModel::handleMergedTimelineSourceError" << sourceId << errorMessage;
+    if (!pendingSources.remove(sourceId)) {
+        return;
+    }
+    emit mergedTimelineError(errorMessage);
+    if (pendingSources.isEmpty()) {
+        mergePendingResults();
+    }
+}
+
+void MergedTimelineModel::resetSource(const QString &sourceId)
+{
+    newestTweetIds.remove(sourceId);
+    pendingResults.remove(sourceId);
+    if (pendingSources.remove(sourceId) && pendingSources.isEmpty()) {
+        mergePendingResults();
+    }
+}
+
+void MergedTimelineModel::mergePendingResults()
+{
+    // Every source delivers its tweets newest first, so the newest remaining tweet of all
+    // sources is always at the top of a heap holding one cursor per source
+    const QList<QVariantList> sourceResults = pendingResults.values();
+    pendingResults.clear();
+    std::priority_queue<MergeCursor, std::vector<MergeCursor> > cursors;
+    for (int source = 0; source < sourceResults.size(); source++) {
+        const QVariantList &sourceResult = sourceResults.at(source);
+        if (!sourceResult.isEmpty()) {
+            MergeCursor cursor;
+            cursor.tweetId = getTweetId(sourceResult.first().toMap());
+            cursor.source = source;
+            cursor.position = 0;
+            cursors.push(cursor);
+        }
+    }
+
+    QVariantList newTweets;
+    QVector<qulonglong> newTweetIds;
+    while (!cursors.empty()) {
+        MergeCursor cursor = cursors.top();
+        cursors.pop();
+        const QVariantList &sourceResult = sourceResults.at(cursor.source);
+        const QVariantMap tweet = sourceResult.at(cursor.position).toMap();
+        const qulonglong relevantTweetId = getRelevantTweetId(tweet);
+        if (!seenTweetIds.contains(cursor.tweetId) && !seenTweetIds.contains(relevantTweetId)) {
+            seenTweetIds.insert(cursor.tweetId);
+            seenTweetIds.insert(relevantTweetId);
+            newTweets.append(tweet);
+            newTweetIds.append(cursor.tweetId);
+        }
+        if (++cursor.position < sourceResult.size()) {
+            cursor.tweetId = getTweetId(sourceResult.at(cursor.position).toMap());
+            cursors.push(cursor);
+        }
+    }
+
+    insertTweets(newTweets, newTweetIds);
+    emit mergedTimelineUpdated(newTweets.size());
+}
+
+void MergedTimelineModel::insertTweets(const QVariantList &tweets, const QVector<qulonglong> &tweetIds)
+{
+    // Both lists are sorted newest first. Consecutive new tweets which belong between the same
+    // two rows are inserted as one block, the existing rows are never moved around.
+    int row = 0;
+    int newTweet = 0;
+    while (newTweet < tweets.size()) {
+        while (row < mergedTweetIds.size() && mergedTweetIds.at(row) > tweetIds.at(newTweet)) {
+            row++;
+        }
+        int blockEnd = newTweet;
+        while (blockEnd < tweets.size() && (row == mergedTweetIds.size() || tweetIds.at(blockEnd) > mergedTweetIds.at(row))) {
+            blockEnd++;
+        }
+        const int blockSize = blockEnd - newTweet;
+        beginInsertRows(QModelIndex(), row, row + blockSize - 1);
+        for (int i = 0; i < blockSize; i++) {
+            mergedTweets.insert(row + i, tweets.at(newTweet + i));
+            mergedTweetIds.insert(row + i, tweetIds.at(newTweet + i));
+        }
+        endInsertRows();
+        row += blockSize;
+        newTweet = blockEnd;
+    }
+
+    if (mergedTweets.size() > MAX_MERGED_TWEETS) {
+        beginRemoveRows(QModelIndex(), MAX_MERGED_TWEETS, mergedTweets.size() - 1);
+        for (int i = MAX_MERGED_TWEETS; i < mergedTweets.size(); i++) {
+            seenTweetIds.remove(mergedTweetIds.at(i));
+            seenTweetIds.remove(getRelevantTweetId(mergedTweets.at(i).toMap()));
+        }
+        mergedTweets.erase(mergedTweets.begin() + MAX_MERGED_TWEETS, mergedTweets.end());
+        mergedTweetIds.resize(MAX_MERGED_TWEETS);
+        endRemoveRows();
+    }
+}
@@ -0,0 +1,83 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef MERGEDTIMELINEMODEL_H
+#define MERGEDTIMELINEMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+#include <QSettings>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+#include "twitterapi.h"
+#include "accountsession.h"
+
+/*
+ * Home timeline and any number of lists combined into one timeline, newest tweet first.
+ * Each source is fetched from its newest known tweet on. The new tweets of all sources are
+ * merged with a k-way merge on their IDs and inserted into the existing rows, tweets which
+ * are already shown (also as retweet or from another source) are skipped.
+ */
+class MergedTimelineModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    MergedTimelineModel(TwitterApi *twitterApi, AccountSession *session);
+    ~MergedTimelineModel();
+
+    void setActive(const bool &active);
+
+    virtual int rowCount(const QModelIndex&) const;
+    virtual QVariant data(const QModelIndex &index, int role) const;
+
+    Q_INVOKABLE void update();
+    Q_INVOKABLE QStringList getListIds();
+    Q_INVOKABLE bool containsList(const QString &listId);
+    Q_INVOKABLE void addList(const QString &listId);
+    Q_INVOKABLE void removeList(const QString &listId);
+
+signals:
+    void mergedTimelineStartUpdate();
+    void mergedTimelineUpdated(int newTweets);
+    void mergedTimelineError(const QString &errorMessage);
+
+public slots:
+    void handleMergedTimelineSourceSuccessful(const QString &sourceId, const QVariantList &result, const QString &newestTweetId);
+    void handleMergedTimelineSourceError(const QString &sourceId, const QString &errorMessage);
+
+private:
+    QVariantList mergedTweets;
+    // IDs of mergedTweets, kept alongside to merge without converting the tweets again
+    QVector<qulonglong> mergedTweetIds;
+    // IDs of the tweets in mergedTweets and of their retweeted tweets
+    QSet<qulonglong> seenTweetIds;
+    QHash<QString, qulonglong> newestTweetIds;
+    QHash<QString, QVariantList> pendingResults;
+    QSet<QString> pendingSources;
+    QStringList listIds;
+    QSettings *settings;
+    TwitterApi *twitterApi;
+
+    void resetSource(const QString &sourceId);
+    void mergePendingResults();
+    void insertTweets(const QVariantList &tweets, const QVector<qulonglong> &tweetIds);
+};
+
+#endif // MERGEDTIMELINEMODEL_H
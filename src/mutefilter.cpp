@@ -0,0 +1,176 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "mutefilter.h"
+
+#include <QDebug>
+
+namespace {
+
+const char SETTINGS_MUTE_RULES[] = "muteRules";
+const uint CATEGORY_MUTED = 1;
+
+// Lower case with everything but letters, digits, hashtags, mentions and underscores replaced by single spaces
+QByteArray normalizeText(const QString &text)
+{
+    QString normalizedText = text.toLower();
+    for (QChar &character : normalizedText) {
+        if (!character.isLetterOrNumber() && character != QLatin1Char('#') && character != QLatin1Char('@') && character != QLatin1Char('_')) {
+            character = QLatin1Char(' ');
+        }
+    }
+    return normalizedText.simplified().toUtf8();
+}
+
+QString getTweetText(const QVariantMap &tweet)
+{
+    return tweet.contains("full_text") ? tweet.value("full_text").toString() : tweet.value("text").toString();
+}
+
+}
+
+MuteFilter::MuteFilter(QSettings *settings, QObject *parent) : QObject(parent), settings(settings)
+{
+    loadRules();
+}
+
+MuteFilter::MuteFilter(const QString &settingsFileName, QObject *parent) : QObject(parent), settings(new QSettings(settingsFileName, QSettings::IniFormat, this))
+{
+    loadRules();
+}
+
+void MuteFilter::setSettings(QSettings *settings)
+{
+    this->settings = settings;
+    loadRules();
+}
+
+void MuteFilter::loadRules()
+{
+    settings->sync();
+    this->rules = settings->value(SETTINGS_MUTE_RULES).toStringList();
+    compileRules();
+}
+
+QStringList MuteFilter::getRules() const
+{
+    return this->rules;
+}
+
+void MuteFilter::setRules(const QStringList &rules)
+{
+    this->rules.clear();
+    for (const QString &rule : rules) {
+        const QString trimmedRule = rule.trimmed();
+        if (!trimmedRule.isEmpty() && !this->rules.contains(trimmedRule)) {
+            this->rules.append(trimmedRule);
+        }
+    }
+    settings->setValue(SETTINGS_MUTE_RULES, this->rules);
+    compileRules();
+}
+
+bool MuteFilter::isMuted(const QVariantMap &tweet) const
+{
+    const QVariantMap retweetedStatus = tweet.value("retweeted_status").toMap();
+    const QVariantMap relevantTweet = retweetedStatus.isEmpty() ? tweet : retweetedStatus;
+    const QVariantMap quotedStatus = relevantTweet.value("quoted_status").toMap();
+
+    if (!this->mutedScreenNames.isEmpty()) {
+        if (this->mutedScreenNames.contains(tweet.value("user").toMap().value("screen_name").toString().toLower()) ||
+                this->mutedScreenNames.contains(retweetedStatus.value("user").toMap().value("screen_name").toString().toLower()) ||
+                this->mutedScreenNames.contains(quotedStatus.value("user").toMap().value("screen_name").toString().toLower())) {
+            return true;
+        }
+    }
+    if (isTextMuted(getTweetText(relevantTweet))) {
+        return true;
+    }
+    return !quotedStatus.isEmpty() && isTextMuted(getTweetText(quotedStatus));
+}
+
+int MuteFilter::filterTweets(QVariantList &tweets) const
+{
+    if (this->rules.isEmpty()) {
+        return 0;
+    }
+    int removedTweets = 0;
+    QVariantList::iterator tweet = tweets.begin();
+    while (tweet != tweets.end()) {
+        if (isMuted(tweet->toMap())) {
+            tweet = tweets.erase(tweet);
+            removedTweets++;
+        } else {
+            ++tweet;
+        }
+    }
+    qDebug() << "MuteFilter::filterTweets" << removedTweets << "of" << (tweets.size() + removedTweets) << "tweets muted";
+    return removedTweets;
+}
+
+void MuteFilter::compileRules()
+{
+    this->keywordMatcher = KeywordMatcher();
+    this->hasKeywords = false;
+    this->mutedScreenNames.clear();
+    QStringList expressions;
+    for (const QString &rule : this->rules) {
+        if (rule.length() > 2 && rule.startsWith(QLatin1Char('/')) && rule.endsWith(QLatin1Char('/'))) {
+            const QString expression = rule.mid(1, rule.length() - 2);
+            if (QRegularExpression(expression).isValid()) {
+                expressions.append("(?:" + expression + ")");
+            } else {
+                qDebug() << "MuteFilter: Ignoring invalid regular expression" << expression;
+            }
+        } else if (rule.length() > 1 && rule.startsWith(QLatin1Char('@'))) {
+            this->mutedScreenNames.insert(rule.mid(1).toLower());
+        } else {
+            // Same normalization as for the text, the surrounding spaces restrict it to whole words
+            const QByteArray keyword = normalizeText(rule);
+            if (!keyword.isEmpty()) {
+                this->keywordMatcher.addKeyword(" " + keyword + " ", CATEGORY_MUTED);
+                // Muted words also mute the hashtag of the same name
+                if (!keyword.startsWith('#')) {
+                    this->keywordMatcher.addKeyword(" #" + keyword + " ", CATEGORY_MUTED);
+                }
+                this->hasKeywords = true;
+            }
+        }
+    }
+    this->keywordMatcher.compile();
+
+    this->hasExpressions = !expressions.isEmpty();
+    this->mutedExpression = QRegularExpression(expressions.join(QLatin1Char('|')), QRegularExpression::CaseInsensitiveOption | QRegularExpression::UseUnicodePropertiesOption);
+    if (this->hasExpressions) {
+        this->mutedExpression.optimize();
+    }
+}
+
+bool MuteFilter::isTextMuted(const QString &text) const
+{
+    if (text.isEmpty()) {
+        return false;
+    }
+    if (this->hasKeywords) {
+        const QByteArray normalizedText = normalizeText(text);
+        if (this->keywordMatcher.match(normalizedText.constData(), normalizedText.length()) & CATEGORY_MUTED) {
+            return true;
+        }
+    }
+    return this->hasExpressions && this->mutedExpression.match(text).hasMatch();
+}
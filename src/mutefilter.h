@@ -0,0 +1,69 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef MUTEFILTER_H
+#define MUTEFILTER_H
+
+#include <QObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QSettings>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include "keywordmatcher.h"
+
+/*
+ * Removes tweets matching the mute rules of the user before they are handed to any model.
+ * A rule is a word or phrase, a #hashtag, an @user or a /regular expression/. Words and
+ * hashtags are compiled into one KeywordMatcher and only match whole words, all regular
+ * expressions are combined into one expression.
+ */
+class MuteFilter : public QObject
+{
+    Q_OBJECT
+public:
+    // Uses the rules of the given settings, usually the ones of the active account session
+    explicit MuteFilter(QSettings *settings, QObject *parent = nullptr);
+    // Uses the rules of the given settings file
+    explicit MuteFilter(const QString &settingsFileName, QObject *parent = nullptr);
+
+    QStringList getRules() const;
+    void setRules(const QStringList &rules);
+    // Uses the rules of another account from now on
+    void setSettings(QSettings *settings);
+
+    bool isMuted(const QVariantMap &tweet) const;
+    // Returns the number of removed tweets
+    int filterTweets(QVariantList &tweets) const;
+
+private:
+    QSettings *settings;
+    QStringList rules;
+    KeywordMatcher keywordMatcher;
+    bool hasKeywords;
+    QSet<QString> mutedScreenNames;
+    QRegularExpression mutedExpression;
+    bool hasExpressions;
+
+    void loadRules();
+    void compileRules();
+    bool isTextMuted(const QString &text) const;
+};
+
+#endif // MUTEFILTER_H
@@ -0,0 +1,330 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "notificationpoller.h"
+#include "twitterapi.h"
+#include "mutefilter.h"
+#include "o0globals.h"
+
+#include <QDateTime>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDebug>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QUrlQuery>
+
+namespace {
+
+const int POLL_INTERVAL_MIN = 2 * 60 * 1000;
+const int POLL_INTERVAL_MAX = 30 * 60 * 1000;
+
+// Same settings as in MentionsModel and DirectMessagesModel, so that the app doesn't report anything twice
+const char SETTINGS_LAST_MENTION[] = "mentions/lastId";
+const char SETTINGS_LAST_MESSAGE[] = "messages/lastId";
+
+}
+
+NotificationPoller::NotificationPoller(QObject *parent)
+    : QObject(parent)
+    , manager(new QNetworkAccessManager(this))
+    , encryptionKey(AccountSession::obtainEncryptionKey())
+{
+    pollTimer.setSingleShot(true);
+    connect(&pollTimer, &QTimer::timeout, this, &NotificationPoller::handlePollTimeout);
+}
+
+void NotificationPoller::start()
+{
+    qDebug() << "NotificationPoller::start";
+    readAccounts();
+    scheduleNextPoll();
+}
+
+void NotificationPoller::handlePollTimeout()
+{
+    // Accounts may have been added or removed in the app in the meantime
+    readAccounts();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QHash<QString, PolledAccount>::iterator accountsIterator;
+    for (accountsIterator = accounts.begin(); accountsIterator != accounts.end(); ++accountsIterator) {
+        PolledAccount &account = accountsIterator.value();
+        if (account.pendingRequests == 0 && account.nextPoll <= now) {
+            account.newItemsFound = false;
+            account.errorOccurred = false;
+            account.pendingRequests = 2;
+            pollMentions(accountsIterator.key());
+            pollMessages(accountsIterator.key());
+        }
+    }
+    scheduleNextPoll();
+}
+
+void NotificationPoller::readAccounts()
+{
+    QDir accountsDirectory(AccountSession::getAccountsConfigDirectory());
+    const QStringList screenNames = accountsDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &screenName : screenNames) {
+        if (accounts.contains(screenName)) {
+            continue;
+        }
+        AccountSession *session = new AccountSession(screenName, encryptionKey, manager, this);
+        if (!session->isLinked()) {
+            session->deleteLater();
+            continue;
+        }
+        qDebug() << "Polling account " + screenName;
+        PolledAccount account;
+        account.session = session;
+        account.mentionsCache = new MentionsCache(session->getDataDirectory(), this);
+        account.conversationGraph = new ConversationGraph(this);
+        account.conversationGraph->setDataDirectory(session->getDataDirectory());
+        account.nextPoll = 0;
+        account.interval = POLL_INTERVAL_MIN;
+        account.pendingRequests = 0;
+        account.newItemsFound = false;
+        account.errorOccurred = false;
+        accounts.insert(screenName, account);
+    }
+
+    QHash<QString, PolledAccount>::iterator accountsIterator = accounts.begin();
+    while (accountsIterator != accounts.end()) {
+        if (!screenNames.contains(accountsIterator.key()) && accountsIterator.value().pendingRequests == 0) {
+            qDebug() << "Account " + accountsIterator.key() + " was removed";
+            accountsIterator.value().session->deleteLater();
+            accountsIterator.value().mentionsCache->deleteLater();
+            accountsIterator.value().conversationGraph->deleteLater();
+            accountsIterator = accounts.erase(accountsIterator);
+        } else {
+            ++accountsIterator;
+        }
+    }
+}
+
+void NotificationPoller::scheduleNextPoll()
+{
+    // One timer for all accounts, running until the earliest next poll
+    qint64 nextPoll = -1;
+    for (const PolledAccount &account : accounts) {
+        if (account.pendingRequests == 0 && (nextPoll < 0 || account.nextPoll < nextPoll)) {
+            nextPoll = account.nextPoll;
+        }
+    }
+    if (nextPoll < 0) {
+        // Without accounts, check again for new ones now and then
+        nextPoll = accounts.isEmpty() ? QDateTime::currentMSecsSinceEpoch() + POLL_INTERVAL_MAX : -1;
+    }
+    if (nextPoll < 0) {
+        pollTimer.stop();
+        return;
+    }
+    pollTimer.start(qMax(qint64(0), nextPoll - QDateTime::currentMSecsSinceEpoch()));
+}
+
+void NotificationPoller::pollMentions(const QString &screenName)
+{
+    qDebug() << "NotificationPoller::pollMentions" << screenName;
+    QSettings settings(getSettingsFileName(screenName), QSettings::IniFormat);
+    QString lastMentionId = settings.value(SETTINGS_LAST_MENTION).toString();
+
+    QUrl url = QUrl(API_STATUSES_MENTIONS_TIMELINE);
+    QUrlQuery urlQuery = QUrlQuery();
+    urlQuery.addQueryItem("tweet_mode", "extended");
+    urlQuery.addQueryItem("include_entities", "true");
+    urlQuery.addQueryItem("count", "200");
+    urlQuery.addQueryItem("include_ext_alt_text", "true");
+    if (!lastMentionId.isEmpty()) {
+        urlQuery.addQueryItem("since_id", lastMentionId);
+    }
+    url.setQuery(urlQuery);
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, O2_MIME_TYPE_XFORM);
+
+    QList<O0RequestParameter> requestParameters = QList<O0RequestParameter>();
+    requestParameters.append(O0RequestParameter(QByteArray("tweet_mode"), QByteArray("extended")));
+    requestParameters.append(O0RequestParameter(QByteArray("include_entities"), QByteArray("true")));
+    requestParameters.append(O0RequestParameter(QByteArray("count"), QByteArray("200")));
+    requestParameters.append(O0RequestParameter(QByteArray("include_ext_alt_text"), QByteArray("true")));
+    if (!lastMentionId.isEmpty()) {
+        requestParameters.append(O0RequestParameter(QByteArray("since_id"), lastMentionId.toUtf8()));
+    }
+    QNetworkReply *reply = accounts.value(screenName).session->getRequestor()->get(request, requestParameters);
+    reply->setObjectName(screenName);
+
+    connect(reply, SIGNAL(finished()), this, SLOT(handleMentionsFinished()));
+}
+
+void NotificationPoller::pollMessages(const QString &screenName)
+{
+    qDebug() << "NotificationPoller::pollMessages" << screenName;
+    QUrl url = QUrl(API_DIRECT_MESSAGES_LIST);
+    QUrlQuery urlQuery = QUrlQuery();
+    urlQuery.addQueryItem("count", "20");
+    url.setQuery(urlQuery);
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, O2_MIME_TYPE_XFORM);
+
+    QList<O0RequestParameter> requestParameters = QList<O0RequestParameter>();
+    requestParameters.append(O0RequestParameter(QByteArray("count"), QByteArray("20")));
+    QNetworkReply *reply = accounts.value(screenName).session->getRequestor()->get(request, requestParameters);
+    reply->setObjectName(screenName);
+
+    connect(reply, SIGNAL(finished()), this, SLOT(handleMessagesFinished()));
+}
+
+void NotificationPoller::handleMentionsFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reply->deleteLater();
+    QString screenName = reply->objectName();
+    qDebug() << "NotificationPoller::handleMentionsFinished" << screenName;
+    if (!accounts.contains(screenName)) {
+        return;
+    }
+    if (reply->error() != QNetworkReply::NoError) {
+        qWarning() << "NotificationPoller::handleMentionsFinished:" << (int)reply->error() << reply->errorString();
+        finishRequest(screenName, false, true);
+        return;
+    }
+
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
+    if (!jsonDocument.isArray()) {
+        finishRequest(screenName, false, true);
+        return;
+    }
+    QVariantList tweets = jsonDocument.array().toVariantList();
+    int newMentions = 0;
+    if (!tweets.isEmpty()) {
+        QString settingsFileName = getSettingsFileName(screenName);
+        QSettings settings(settingsFileName, QSettings::IniFormat);
+        // Without a known mention, this is the first poll of the account and everything counts as old
+        bool firstPoll = settings.value(SETTINGS_LAST_MENTION).toString().isEmpty();
+        // The marker also moves past muted mentions, otherwise they would be requested again and again
+        settings.setValue(SETTINGS_LAST_MENTION, tweets.first().toMap().value("id_str").toString());
+        MuteFilter muteFilter(settingsFileName);
+        TwitterApi::ingestTweets(tweets, &muteFilter, accounts.value(screenName).conversationGraph);
+        accounts.value(screenName).mentionsCache->insert(tweets);
+        if (!firstPoll) {
+            newMentions = tweets.size();
+        }
+    }
+
+    if (newMentions > 1) {
+        publishNotification(tr("New Mentions"), tr("@%1 has been mentioned %2 times!").arg(screenName).arg(newMentions));
+    } else if (newMentions == 1) {
+        publishNotification(tr("New Mention"), tr("@%1 has been mentioned!").arg(screenName));
+    }
+    finishRequest(screenName, newMentions > 0, false);
+}
+
+void NotificationPoller::handleMessagesFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reply->deleteLater();
+    QString screenName = reply->objectName();
+    qDebug() << "NotificationPoller::handleMessagesFinished" << screenName;
+    if (!accounts.contains(screenName)) {
+        return;
+    }
+    if (reply->error() != QNetworkReply::NoError) {
+        qWarning() << "NotificationPoller::handleMessagesFinished:" << (int)reply->error() << reply->errorString();
+        finishRequest(screenName, false, true);
+        return;
+    }
+
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
+    if (!jsonDocument.isObject()) {
+        finishRequest(screenName, false, true);
+        return;
+    }
+    QString userId = accounts.value(screenName).session->getAuthenticator()->extraTokens().value("user_id").toString();
+    QSettings settings(getSettingsFileName(screenName), QSettings::IniFormat);
+    QString storedMessageId = settings.value(SETTINGS_LAST_MESSAGE).toString();
+    QString lastMessageId;
+    int newMessages = 0;
+    const QVariantList events = jsonDocument.object().toVariantMap().value("events").toList();
+    for (const QVariant &event : events) {
+        QVariantMap singleEvent = event.toMap();
+        QString recipientId = singleEvent.value("message_create").toMap().value("target").toMap().value("recipient_id").toString();
+        if (recipientId != userId) {
+            continue;
+        }
+        QString messageId = singleEvent.value("id").toString();
+        if (messageId == storedMessageId) {
+            break;
+        }
+        if (lastMessageId.isEmpty()) {
+            lastMessageId = messageId;
+        }
+        newMessages++;
+    }
+    if (!lastMessageId.isEmpty()) {
+        settings.setValue(SETTINGS_LAST_MESSAGE, lastMessageId);
+    }
+    if (storedMessageId.isEmpty()) {
+        newMessages = 0;
+    }
+
+    if (newMessages > 0) {
+        publishNotification(tr("New Messages"), tr("@%1 has new direct messages!").arg(screenName));
+    }
+    finishRequest(screenName, newMessages > 0, false);
+}
+
+void NotificationPoller::finishRequest(const QString &screenName, const bool &newItemsFound, const bool &errorOccurred)
+{
+    PolledAccount &account = accounts[screenName];
+    account.newItemsFound = account.newItemsFound || newItemsFound;
+    account.errorOccurred = account.errorOccurred || errorOccurred;
+    account.pendingRequests--;
+    if (account.pendingRequests > 0) {
+        return;
+    }
+
+    // Active accounts are checked often, quiet ones and failing ones less and less
+    if (account.errorOccurred) {
+        account.interval = qMin(account.interval * 2, POLL_INTERVAL_MAX);
+    } else if (account.newItemsFound) {
+        account.interval = POLL_INTERVAL_MIN;
+    } else {
+        account.interval = qMin(account.interval * 3 / 2, POLL_INTERVAL_MAX);
+    }
+    account.nextPoll = QDateTime::currentMSecsSinceEpoch() + account.interval;
+    qDebug() << "Polling " + screenName + " again in " + QString::number(account.interval / 1000) + " seconds";
+    scheduleNextPoll();
+}
+
+QString NotificationPoller::getSettingsFileName(const QString &screenName)
+{
+    // Each account has its own settings, also the one which is active in the app
+    return accounts.value(screenName).session->getConfigDirectory() + "/settings.conf";
+}
+
+void NotificationPoller::publishNotification(const QString &summary, const QString &body)
+{
+    qDebug() << "NotificationPoller::publishNotification" << summary << body;
+    QDBusMessage notification = QDBusMessage::createMethodCall("org.freedesktop.Notifications", "/org/freedesktop/Notifications", "org.freedesktop.Notifications", "Notify");
+    QVariantMap hints;
+    hints.insert("x-nemo-preview-summary", summary);
+    hints.insert("x-nemo-preview-body", body);
+    notification << QString("Piepmatz") << uint(0) << QString("/usr/share/icons/hicolor/256x256/apps/harbour-piepmatz.png") << summary << body << QStringList() << hints << int(-1);
+    QDBusConnection::sessionBus().send(notification);
+}
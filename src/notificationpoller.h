@@ -0,0 +1,77 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef NOTIFICATIONPOLLER_H
+#define NOTIFICATIONPOLLER_H
+
+#include <QObject>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTimer>
+#include "accountsession.h"
+#include "conversationgraph.h"
+#include "mentionscache.h"
+
+/*
+ * Headless mode of the app: polls the mentions and direct messages of all linked accounts
+ * and publishes notifications for new ones. Mentions are requested as a delta since the
+ * last known mention and stored in the same caches the app uses, the last known mention
+ * and message are the same settings the app checks. Accounts are polled more often after
+ * something new was found and less often while nothing happens or requests fail.
+ */
+class NotificationPoller : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NotificationPoller(QObject *parent = nullptr);
+
+    void start();
+
+private slots:
+    void handlePollTimeout();
+    void handleMentionsFinished();
+    void handleMessagesFinished();
+
+private:
+    struct PolledAccount {
+        AccountSession *session;
+        MentionsCache *mentionsCache;
+        ConversationGraph *conversationGraph;
+        qint64 nextPoll;
+        int interval;
+        int pendingRequests;
+        bool newItemsFound;
+        bool errorOccurred;
+    };
+
+    QNetworkAccessManager *manager;
+    QString encryptionKey;
+    QHash<QString, PolledAccount> accounts;
+    QTimer pollTimer;
+
+    void readAccounts();
+    void scheduleNextPoll();
+    void pollMentions(const QString &screenName);
+    void pollMessages(const QString &screenName);
+    void finishRequest(const QString &screenName, const bool &newItemsFound, const bool &errorOccurred);
+    QString getSettingsFileName(const QString &screenName);
+    void publishNotification(const QString &summary, const QString &body);
+};
+
+#endif // NOTIFICATIONPOLLER_H
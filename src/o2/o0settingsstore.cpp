@@ -32,13 +32,27 @@ void O0SettingsStore::setGroupKey(const QString &groupKey) {
 
 QString O0SettingsStore::value(const QString &key, const QString &defaultValue) {
     QString fullKey = groupKey_.isEmpty() ? key : (groupKey_ + '/' + key);
-    if (!settings_->contains(fullKey)) {
-        return defaultValue;
+    // Tokens are read for every signed request, so they are decrypted only once
+    QHash<QString, QString>::const_iterator cachedValue = cache_.constFind(fullKey);
+    if (cachedValue == cache_.constEnd()) {
+        QString value;
+        if (settings_->contains(fullKey)) {
+            value = crypt_.decryptToString(settings_->value(fullKey).toString());
+            if (value.isNull()) {
+                value = QString("");
+            }
+        }
+        cachedValue = cache_.insert(fullKey, value);
     }
-    return crypt_.decryptToString(settings_->value(fullKey).toString());
+    return cachedValue.value().isNull() ? defaultValue : cachedValue.value();
 }
 
 void O0SettingsStore::setValue(const QString &key, const QString &value) {
     QString fullKey = groupKey_.isEmpty() ? key : (groupKey_ + '/' + key);
     settings_->setValue(fullKey, crypt_.encryptToString(value));
+    cache_.insert(fullKey, value.isNull() ? QString("") : value);
+}
+
+void O0SettingsStore::clearCache() {
+    cache_.clear();
 }
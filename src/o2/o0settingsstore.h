@@ -1,6 +1,7 @@
 #ifndef O0SETTINGSSTORE_H
 #define O0SETTINGSSTORE_H
 
+#include <QHash>
 #include <QSettings>
 #include <QString>
 
@@ -30,6 +31,9 @@ public:
     /// Set a string value for a key
     void setValue(const QString &key, const QString &value);
 
+    /// Forget all values read so far, e.g. if the settings were changed behind the store's back
+    void clearCache();
+
 Q_SIGNALS:
     // Property change signals
     void groupKeyChanged();
@@ -38,6 +42,8 @@ protected:
     QSettings* settings_;
     QString groupKey_;
     O0SimpleCrypt crypt_;
+    /// Decrypted values by full key, a null string marks a key which is not set
+    QHash<QString, QString> cache_;
 };
 
 #endif // O0SETTINGSSTORE_H
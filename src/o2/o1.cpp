@@ -27,6 +27,15 @@ O1::O1(QObject *parent): O0BaseAuth(parent) {
     qRegisterMetaType<QNetworkReply::NetworkError>("QNetworkReply::NetworkError");
     connect(replyServer_, SIGNAL(verificationReceived(QMap<QString,QString>)), this, SLOT(onVerificationReceived(QMap<QString,QString>)));
     setCallbackUrl(O2_CALLBACK_URL);
+#if QT_VERSION >= 0x050100
+    hmac_ = new QMessageAuthenticationCode(QCryptographicHash::Sha1);
+#endif
+}
+
+O1::~O1() {
+#if QT_VERSION >= 0x050100
+    delete hmac_;
+#endif
 }
 
 QUrl O1::requestTokenUrl() {
@@ -157,6 +166,59 @@ QByteArray O1::sign(const QList<O0RequestParameter> &oauthParams, const QList<O0
 #endif
 }
 
+QByteArray O1::signRequest(const QList<O0RequestParameter> &oauthParams, const QList<O0RequestParameter> &otherParams, const QUrl &url, QNetworkAccessManager::Operation op) {
+    const QByteArray base = requestBase(oauthParams, otherParams, url, op);
+    const QString consumerSecret = clientSecret();
+    const QString currentTokenSecret = tokenSecret();
+    if (signingKey_.isEmpty() || consumerSecret != signingConsumerSecret_ || currentTokenSecret != signingTokenSecret_) {
+        signingConsumerSecret_ = consumerSecret;
+        signingTokenSecret_ = currentTokenSecret;
+        signingKey_ = QUrl::toPercentEncoding(consumerSecret) + "&" + QUrl::toPercentEncoding(currentTokenSecret);
+#if QT_VERSION >= 0x050100
+        hmac_->setKey(signingKey_);
+#endif
+    }
+#if QT_VERSION >= 0x050100
+    hmac_->reset();
+    hmac_->addData(base);
+    return hmac_->result().toBase64();
+#else
+    return hmacSha1(signingKey_, base);
+#endif
+}
+
+QByteArray O1::requestBase(const QList<O0RequestParameter> &oauthParams, const QList<O0RequestParameter> &otherParams, const QUrl &url, QNetworkAccessManager::Operation op) {
+    // Same base string as getRequestBase(): percent-encoding the joined parameters equals joining the encoded ones
+    QList<O0RequestParameter> parameters(oauthParams);
+    parameters.append(otherParams);
+    qSort(parameters);
+    QByteArray base;
+    base.append(getOperationName(op).toUtf8() + "&");
+    base.append(QUrl::toPercentEncoding(url.toString(QUrl::RemoveQuery)) + "&");
+    for (int i = 0; i < parameters.size(); i++) {
+        if (i > 0) {
+            base.append("%26");
+        }
+        base.append(encodedParameter(parameters.at(i)));
+    }
+    return base;
+}
+
+QByteArray O1::encodedParameter(const O0RequestParameter &parameter) {
+    const bool sessionParameter = parameter.name == O2_OAUTH_CONSUMER_KEY || parameter.name == O2_OAUTH_TOKEN || parameter.name == O2_OAUTH_VERSION || parameter.name == O2_OAUTH_SIGNATURE_METHOD;
+    if (sessionParameter) {
+        QHash<QByteArray, QPair<QByteArray, QByteArray> >::const_iterator encoded = encodedSessionParameters_.constFind(parameter.name);
+        if (encoded != encodedSessionParameters_.constEnd() && encoded.value().first == parameter.value) {
+            return encoded.value().second;
+        }
+    }
+    QByteArray encoded = QUrl::toPercentEncoding(QUrl::toPercentEncoding(parameter.name)) + "%3D" + QUrl::toPercentEncoding(QUrl::toPercentEncoding(parameter.value));
+    if (sessionParameter) {
+        encodedSessionParameters_.insert(parameter.name, qMakePair(parameter.value, encoded));
+    }
+    return encoded;
+}
+
 QByteArray O1::buildAuthorizationHeader(const QList<O0RequestParameter> &oauthParams) {
     bool first = true;
     QByteArray ret("OAuth ");
@@ -179,7 +241,7 @@ QByteArray O1::buildAuthorizationHeader(const QList<O0RequestParameter> &oauthPa
 QByteArray O1::generateSignature(const QList<O0RequestParameter> headers, const QNetworkRequest &req, const QList<O0RequestParameter> &signingParameters, QNetworkAccessManager::Operation operation) {
     QByteArray signature;
     if (signatureMethod() == O2_SIGNATURE_TYPE_HMAC_SHA1) {
-        signature = sign(headers, signingParameters, req.url(), operation, clientSecret(), tokenSecret());
+        signature = signRequest(headers, signingParameters, req.url(), operation);
     } else if (signatureMethod() == O2_SIGNATURE_TYPE_PLAINTEXT) {
         signature = clientSecret().toLatin1() + "&" + tokenSecret().toLatin1();
     }
@@ -4,11 +4,14 @@
 #include <QNetworkAccessManager>
 #include <QUrl>
 #include <QNetworkReply>
+#include <QHash>
+#include <QPair>
 
 #include "o0export.h"
 #include "o0baseauth.h"
 
 class O2ReplyServer;
+class QMessageAuthenticationCode;
 
 /// Simple OAuth 1.0 authenticator.
 class O0_EXPORT O1: public O0BaseAuth {
@@ -50,6 +53,9 @@ public:
     /// Constructor.
     explicit O1(QObject *parent = 0);
 
+    /// Destructor.
+    ~O1();
+
     /// Parse a URL-encoded response string.
     static QMap<QString, QString> parseResponse(const QByteArray &response);
 
@@ -111,6 +117,15 @@ protected:
     /// Exchange temporary token to authentication token
     void exchangeToken();
 
+    /// Calculate the HMAC-SHA1 signature of a request like sign(), reusing what stays the same between requests.
+    QByteArray signRequest(const QList<O0RequestParameter> &oauthParams, const QList<O0RequestParameter> &otherParams, const QUrl &url, QNetworkAccessManager::Operation op);
+
+    /// Signature base string of a request, byte for byte the same as getRequestBase().
+    QByteArray requestBase(const QList<O0RequestParameter> &oauthParams, const QList<O0RequestParameter> &otherParams, const QUrl &url, QNetworkAccessManager::Operation op);
+
+    /// Percent-encoded "name=value" pair for the request base, as it is embedded in the base string.
+    QByteArray encodedParameter(const O0RequestParameter &parameter);
+
     QUrl requestUrl_;
     QList<O0RequestParameter> requestParameters_;
     QString callbackUrl_;
@@ -120,6 +135,17 @@ protected:
     QString signatureMethod_;
     QNetworkAccessManager *manager_;
     O2ReplyServer *replyServer_;
+
+    /// Encoded OAuth parameters which stay the same for the session (consumer key, token, version, signature method), by name, together with their raw value.
+    QHash<QByteArray, QPair<QByteArray, QByteArray> > encodedSessionParameters_;
+    /// Secrets the signing key was derived from.
+    QString signingConsumerSecret_;
+    QString signingTokenSecret_;
+    QByteArray signingKey_;
+#if QT_VERSION >= 0x050100
+    /// Keyed HMAC, reset for every request.
+    QMessageAuthenticationCode *hmac_;
+#endif
 };
 
 #endif // O1_H
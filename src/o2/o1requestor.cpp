@@ -4,12 +4,16 @@
 #include <QNetworkAccessManager>
 
 #include "o1requestor.h"
-#include "o1timedreply.h"
 #include "o0globals.h"
 
 O1Requestor::O1Requestor(QNetworkAccessManager *manager, O1 *authenticator, QObject *parent): QObject(parent) {
     manager_ = manager;
     authenticator_ = authenticator;
+    timeoutManager_ = new O1TimeoutManager(this);
+}
+
+O1TimeoutManager *O1Requestor::timeoutManager() {
+    return timeoutManager_;
 }
 
 QNetworkReply *O1Requestor::get(const QNetworkRequest &req, const QList<O0RequestParameter> &signingParameters) {
@@ -33,7 +37,7 @@ QNetworkReply *O1Requestor::put(const QNetworkRequest &req, const QList<O0Reques
 }
 
 QNetworkReply *O1Requestor::addTimer(QNetworkReply *reply) {
-    (void)new O1TimedReply(reply);
+    timeoutManager_->watch(reply);
     return reply;
 }
 
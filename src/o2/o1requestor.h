@@ -7,6 +7,7 @@
 
 #include "o0export.h"
 #include "o1.h"
+#include "o1timeoutmanager.h"
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -19,6 +20,9 @@ class O0_EXPORT O1Requestor: public QObject {
 public:
     explicit O1Requestor(QNetworkAccessManager *manager, O1 *authenticator, QObject *parent = 0);
 
+    /// Timeouts of the replies made by this requestor. Replies made elsewhere can be watched by it, too.
+    O1TimeoutManager *timeoutManager();
+
 public Q_SLOTS:
     /// Make a GET request.
     /// @param  req                 Network request.
@@ -51,11 +55,12 @@ protected:
     /// Return new request based on the original, with the "Authentication:" header added.
     QNetworkRequest setup(const QNetworkRequest &request, const QList<O0RequestParameter> &signingParameters, QNetworkAccessManager::Operation operation);
 
-    /// Augment reply with a timer.
+    /// Watch reply for timeouts, using the timeout class set in its request (O1_TIMEOUT_CLASS_ATTRIBUTE).
     QNetworkReply *addTimer(QNetworkReply *reply);
 
     QNetworkAccessManager *manager_;
     O1 *authenticator_;
+    O1TimeoutManager *timeoutManager_;
 };
 
 
@@ -0,0 +1,167 @@
+#include <QDebug>
+#include <QNetworkAccessManager>
+
+#include "o1timeoutmanager.h"
+
+namespace {
+
+/// Resolution of the wheel in milliseconds.
+const int O1_TIMEOUT_TICK = 1000;
+/// Slots of the wheel. Deadlines further away are visited once per round and listed again.
+const int O1_TIMEOUT_WHEEL_SIZE = 64;
+
+/// Limits in milliseconds per timeout class: connect, idle while uploading, first byte of the response, idle while downloading.
+const int O1_TIMEOUTS[][4] = {
+    { 15 * 1000, 15 * 1000, 30 * 1000, 15 * 1000 },
+    { 15 * 1000, 30 * 1000, 60 * 1000, 30 * 1000 },
+    { 15 * 1000, 15 * 1000, 30 * 1000, 20 * 1000 }
+};
+
+/// Ticks until a limit has passed for sure, the current tick may be almost over already.
+qint64 ticksFor(int timeout) {
+    return (timeout + O1_TIMEOUT_TICK - 1) / O1_TIMEOUT_TICK + 1;
+}
+
+}
+
+O1TimeoutManager::O1TimeoutManager(QObject *parent): QObject(parent), wheel_(O1_TIMEOUT_WHEEL_SIZE), currentTick_(0) {
+    timer_.setInterval(O1_TIMEOUT_TICK);
+    connect(&timer_, SIGNAL(timeout()), this, SLOT(onTick()));
+}
+
+void O1TimeoutManager::watch(QNetworkReply *reply) {
+    const QVariant timeoutClass = reply->request().attribute(O1_TIMEOUT_CLASS_ATTRIBUTE);
+    watch(reply, timeoutClass.isValid() ? static_cast<TimeoutClass>(timeoutClass.toInt()) : ApiTimeout);
+}
+
+void O1TimeoutManager::watch(QNetworkReply *reply, TimeoutClass timeoutClass) {
+    if (entries_.contains(reply) || reply->isFinished()) {
+        return;
+    }
+    Entry entry;
+    entry.reply = reply;
+    entry.timeoutClass = timeoutClass;
+    const bool hasBody = reply->operation() == QNetworkAccessManager::PostOperation || reply->operation() == QNetworkAccessManager::PutOperation;
+    if (hasBody) {
+        // The first upload progress tells that the connection is up
+        entry.phase = Connecting;
+        entry.deadline = currentTick_ + ticksFor(phaseTimeout(timeoutClass, Connecting));
+    } else {
+        // Nothing to observe between connecting and the response, so both limits apply together
+        entry.phase = WaitingForResponse;
+        entry.deadline = currentTick_ + ticksFor(phaseTimeout(timeoutClass, Connecting) + phaseTimeout(timeoutClass, WaitingForResponse));
+    }
+    Entry &watched = entries_.insert(reply, entry).value();
+    schedule(reply, watched);
+
+    connect(reply, SIGNAL(uploadProgress(qint64,qint64)), this, SLOT(onUploadProgress(qint64,qint64)));
+    connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(onDownloadProgress(qint64,qint64)));
+    connect(reply, SIGNAL(metaDataChanged()), this, SLOT(onMetaDataChanged()));
+    connect(reply, SIGNAL(finished()), this, SLOT(onFinished()));
+    connect(reply, SIGNAL(destroyed(QObject*)), this, SLOT(onDestroyed(QObject*)));
+
+    if (!timer_.isActive()) {
+        timer_.start();
+    }
+}
+
+int O1TimeoutManager::phaseTimeout(TimeoutClass timeoutClass, Phase phase) {
+    return O1_TIMEOUTS[timeoutClass][phase];
+}
+
+void O1TimeoutManager::enterPhase(Entry &entry, Phase phase) {
+    entry.phase = phase;
+    entry.deadline = currentTick_ + ticksFor(phaseTimeout(entry.timeoutClass, phase));
+    // Later deadlines are picked up when the current slot comes up, earlier ones need a new listing
+    if (entry.deadline < entry.scheduledTick) {
+        schedule(entry.reply, entry);
+    }
+}
+
+void O1TimeoutManager::schedule(QObject *key, Entry &entry) {
+    entry.scheduledTick = qMin(entry.deadline, currentTick_ + O1_TIMEOUT_WHEEL_SIZE - 1);
+    wheel_[entry.scheduledTick % O1_TIMEOUT_WHEEL_SIZE].append(key);
+}
+
+void O1TimeoutManager::remove(QObject *key) {
+    if (entries_.remove(key) > 0) {
+        disconnect(key, 0, this, 0);
+    }
+    if (entries_.isEmpty()) {
+        timer_.stop();
+        for (int i = 0; i < wheel_.size(); i++) {
+            wheel_[i].clear();
+        }
+    }
+}
+
+void O1TimeoutManager::onTick() {
+    currentTick_++;
+    QList<QObject *> due;
+    due.swap(wheel_[currentTick_ % O1_TIMEOUT_WHEEL_SIZE]);
+
+    QList<QNetworkReply *> expired;
+    foreach (QObject *key, due) {
+        QHash<QObject *, Entry>::iterator entry = entries_.find(key);
+        if (entry == entries_.end() || entry.value().scheduledTick != currentTick_) {
+            continue;
+        }
+        if (entry.value().deadline <= currentTick_) {
+            expired.append(entry.value().reply);
+        } else {
+            schedule(key, entry.value());
+        }
+    }
+
+    // Aborting finishes the replies right away, so their handlers may already start new requests
+    foreach (QNetworkReply *reply, expired) {
+        if (!entries_.contains(reply)) {
+            continue;
+        }
+        qWarning() << "O1TimeoutManager::onTick: Timed out" << reply->url().toString(QUrl::RemoveQuery);
+        remove(reply);
+        Q_EMIT timedOut(reply);
+        reply->abort();
+    }
+}
+
+void O1TimeoutManager::onUploadProgress(qint64 bytesSent, qint64 bytesTotal) {
+    QHash<QObject *, Entry>::iterator entry = entries_.find(sender());
+    if (entry == entries_.end() || bytesSent <= 0) {
+        return;
+    }
+    if (entry.value().phase != Connecting && entry.value().phase != Uploading) {
+        return;
+    }
+    if (bytesTotal > 0 && bytesSent >= bytesTotal) {
+        enterPhase(entry.value(), WaitingForResponse);
+    } else {
+        enterPhase(entry.value(), Uploading);
+    }
+}
+
+void O1TimeoutManager::onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
+    Q_UNUSED(bytesTotal);
+    QHash<QObject *, Entry>::iterator entry = entries_.find(sender());
+    if (entry == entries_.end() || bytesReceived <= 0) {
+        return;
+    }
+    enterPhase(entry.value(), Downloading);
+}
+
+void O1TimeoutManager::onMetaDataChanged() {
+    QHash<QObject *, Entry>::iterator entry = entries_.find(sender());
+    if (entry == entries_.end()) {
+        return;
+    }
+    enterPhase(entry.value(), Downloading);
+}
+
+void O1TimeoutManager::onFinished() {
+    remove(sender());
+}
+
+void O1TimeoutManager::onDestroyed(QObject *object) {
+    // Replies deleted before they finished, the pointer is only used as key
+    remove(object);
+}
@@ -0,0 +1,92 @@
+#ifndef O1TIMEOUTMANAGER_H
+#define O1TIMEOUTMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QTimer>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+#include "o0export.h"
+
+/// Request attribute selecting the timeout class of a request, see O1TimeoutManager::TimeoutClass.
+const QNetworkRequest::Attribute O1_TIMEOUT_CLASS_ATTRIBUTE = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+
+/// Watches any number of network replies with a single timer wheel and aborts the ones which stall.
+/// Every reply passes through up to four phases, each with its own limit from the reply's timeout class:
+/// connecting, uploading (idle time between upload progress), waiting for the first byte of the response
+/// and downloading (idle time between download progress). Replies which keep making progress never time out.
+class O0_EXPORT O1TimeoutManager: public QObject {
+    Q_OBJECT
+
+public:
+    /// Timeout classes, set per request with O1_TIMEOUT_CLASS_ATTRIBUTE.
+    enum TimeoutClass {
+        /// Quick API calls with small payloads (default).
+        ApiTimeout,
+        /// Media uploads, which may send slowly and take the server a while to process.
+        UploadTimeout,
+        /// Downloads of media and previews.
+        MediaTimeout
+    };
+
+    explicit O1TimeoutManager(QObject *parent = 0);
+
+    /// Watch a reply until it finishes. Timed out replies are aborted, which finishes them with QNetworkReply::OperationCanceledError.
+    void watch(QNetworkReply *reply, TimeoutClass timeoutClass);
+
+    /// Watch a reply with the timeout class given in its request, ApiTimeout if there is none.
+    void watch(QNetworkReply *reply);
+
+Q_SIGNALS:
+    /// Emitted right before a stalled reply is aborted.
+    void timedOut(QNetworkReply *reply);
+
+protected Q_SLOTS:
+    void onTick();
+    void onUploadProgress(qint64 bytesSent, qint64 bytesTotal);
+    void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void onMetaDataChanged();
+    void onFinished();
+    void onDestroyed(QObject *object);
+
+protected:
+    enum Phase {
+        Connecting,
+        Uploading,
+        WaitingForResponse,
+        Downloading
+    };
+
+    struct Entry {
+        QNetworkReply *reply;
+        TimeoutClass timeoutClass;
+        Phase phase;
+        /// Tick after which the reply has timed out. Progress only moves this forward, the wheel catches up lazily.
+        qint64 deadline;
+        /// Tick of the slot the reply is listed in, older listings in other slots are stale
+        qint64 scheduledTick;
+    };
+
+    /// Limit of a phase in milliseconds.
+    static int phaseTimeout(TimeoutClass timeoutClass, Phase phase);
+
+    /// Switch an entry to a phase and restart its deadline.
+    void enterPhase(Entry &entry, Phase phase);
+
+    /// List an entry in the slot of its deadline.
+    void schedule(QObject *key, Entry &entry);
+
+    /// Stop watching a reply. Its listing in the wheel is dropped when the slot comes up.
+    void remove(QObject *key);
+
+    QHash<QObject *, Entry> entries_;
+    /// One list of replies per slot, a reply is listed in the slot of its deadline modulo the wheel size
+    QVector<QList<QObject *> > wheel_;
+    qint64 currentTick_;
+    QTimer timer_;
+};
+
+#endif // O1TIMEOUTMANAGER_H
@@ -8,7 +8,7 @@ INCLUDEPATH += $$PWD
 SOURCES += \
     $$PWD/o1.cpp \
     $$PWD/o1requestor.cpp \
-    $$PWD/o1timedreply.cpp \
+    $$PWD/o1timeoutmanager.cpp \
     $$PWD/o2.cpp \
     $$PWD/o2facebook.cpp \
     $$PWD/o2gft.cpp \
@@ -29,7 +29,7 @@ HEADERS += \
     $$PWD/o1flickr.h \
     $$PWD/o1requestor.h \
     $$PWD/o1twitter.h \
-    $$PWD/o1timedreply.h \
+    $$PWD/o1timeoutmanager.h \
     $$PWD/o2.h \
     $$PWD/o2facebook.h \
     $$PWD/o2gft.h \
@@ -0,0 +1,200 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "opengraphcache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QJsonDocument>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QUrlQuery>
+
+const char OPEN_GRAPH_DATABASE_CONNECTION[] = "opengraph";
+// Open Graph data rarely changes once a page is published, pages without it are checked again earlier
+const qint64 OPEN_GRAPH_TTL_SECONDS = 7 * 24 * 60 * 60;
+const qint64 OPEN_GRAPH_NOT_FOUND_TTL_SECONDS = 6 * 60 * 60;
+const int OPEN_GRAPH_MEMORY_ENTRIES = 500;
+
+OpenGraphCache::OpenGraphCache(QObject *parent) : QObject(parent), entries(OPEN_GRAPH_MEMORY_ENTRIES)
+{
+    initializeDatabase();
+}
+
+OpenGraphCache::~OpenGraphCache()
+{
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(OPEN_GRAPH_DATABASE_CONNECTION);
+}
+
+QString OpenGraphCache::getCanonicalUrl(const QString &address)
+{
+    QUrl url(address.trimmed());
+    if (!url.isValid()) {
+        return address;
+    }
+    url.setFragment(QString());
+    if ((url.scheme() == "http" && url.port() == 80) || (url.scheme() == "https" && url.port() == 443)) {
+        url.setPort(-1);
+    }
+    if (url.path().isEmpty()) {
+        url.setPath("/");
+    }
+    if (url.hasQuery()) {
+        // Tracking parameters don't change the page, so shares from different sources should end up in the same entry
+        QUrlQuery query(url);
+        QList<QPair<QString, QString> > queryItems = query.queryItems();
+        for (const QPair<QString, QString> &queryItem : queryItems) {
+            if (queryItem.first.startsWith("utm_") || queryItem.first == "fbclid" || queryItem.first == "gclid") {
+                query.removeAllQueryItems(queryItem.first);
+            }
+        }
+        if (query.isEmpty()) {
+            url.setQuery(QString());
+        } else {
+            url.setQuery(query);
+        }
+    }
+    return url.toString(QUrl::NormalizePathSegments);
+}
+
+OpenGraphCache::LookupResult OpenGraphCache::lookup(const QString &address, QVariantMap &openGraphData)
+{
+    QString canonicalUrl = getCanonicalUrl(address);
+    CacheEntry *entry = entries.object(canonicalUrl);
+    if (entry == nullptr && database.isOpen()) {
+        QSqlQuery databaseQuery(database);
+        databaseQuery.prepare("select data, fetched_at from open_graph where url = (:url)");
+        databaseQuery.bindValue(":url", canonicalUrl);
+        if (databaseQuery.exec() && databaseQuery.next()) {
+            entry = new CacheEntry();
+            entry->openGraphData = QJsonDocument::fromJson(databaseQuery.value(0).toByteArray()).toVariant().toMap();
+            entry->fetchedAt = databaseQuery.value(1).toLongLong();
+            entries.insert(canonicalUrl, entry);
+        }
+    }
+    if (entry == nullptr) {
+        return Miss;
+    }
+    if (isExpired(*entry)) {
+        entries.remove(canonicalUrl);
+        return Miss;
+    }
+    if (entry->openGraphData.isEmpty()) {
+        return NotFound;
+    }
+    openGraphData = entry->openGraphData;
+    return Found;
+}
+
+void OpenGraphCache::insert(const QString &address, const QVariantMap &openGraphData)
+{
+    CacheEntry entry;
+    entry.openGraphData = openGraphData;
+    entry.fetchedAt = QDateTime::currentMSecsSinceEpoch() / 1000;
+    store(getCanonicalUrl(address), entry);
+}
+
+void OpenGraphCache::insertNotFound(const QString &address)
+{
+    CacheEntry entry;
+    entry.fetchedAt = QDateTime::currentMSecsSinceEpoch() / 1000;
+    store(getCanonicalUrl(address), entry);
+}
+
+bool OpenGraphCache::addRequester(const QString &address)
+{
+    QString canonicalUrl = getCanonicalUrl(address);
+    bool alreadyRequested = requesters.contains(canonicalUrl);
+    requesters[canonicalUrl].append(address);
+    return !alreadyRequested;
+}
+
+QStringList OpenGraphCache::takeRequesters(const QString &address)
+{
+    return requesters.take(getCanonicalUrl(address));
+}
+
+bool OpenGraphCache::removeRequester(const QString &address)
+{
+    QString canonicalUrl = getCanonicalUrl(address);
+    QHash<QString, QStringList>::iterator addressRequesters = requesters.find(canonicalUrl);
+    if (addressRequesters == requesters.end()) {
+        return false;
+    }
+    addressRequesters.value().removeOne(address);
+    if (addressRequesters.value().isEmpty()) {
+        requesters.erase(addressRequesters);
+        return true;
+    }
+    return false;
+}
+
+void OpenGraphCache::initializeDatabase()
+{
+    qDebug() << "OpenGraphCache::initializeDatabase";
+    QString databaseDirectory = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/harbour-piepmatz";
+    QDir().mkpath(databaseDirectory);
+    QString databaseFilePath = databaseDirectory + "/cache.db";
+    database = QSqlDatabase::addDatabase("QSQLITE", OPEN_GRAPH_DATABASE_CONNECTION);
+    database.setDatabaseName(databaseFilePath);
+    if (!database.open()) {
+        qDebug() << "Error opening SQLite database " + databaseFilePath + ", Open Graph data is only cached in memory";
+        return;
+    }
+
+    QSqlQuery databaseQuery(database);
+    if (!database.tables().contains("open_graph")) {
+        if (databaseQuery.exec("create table open_graph (url text primary key, data text, fetched_at integer)")) {
+            qDebug() << "Open Graph table successfully created!";
+        } else {
+            qDebug() << "Error creating Open Graph table!" << databaseQuery.lastError().text();
+        }
+    }
+    databaseQuery.prepare("delete from open_graph where fetched_at < (:expiry)");
+    databaseQuery.bindValue(":expiry", QDateTime::currentMSecsSinceEpoch() / 1000 - OPEN_GRAPH_TTL_SECONDS);
+    if (!databaseQuery.exec()) {
+        qDebug() << "Error removing expired Open Graph data!" << databaseQuery.lastError().text();
+    }
+}
+
+void OpenGraphCache::store(const QString &canonicalUrl, const CacheEntry &entry)
+{
+    entries.insert(canonicalUrl, new CacheEntry(entry));
+    if (!database.isOpen()) {
+        return;
+    }
+    QSqlQuery databaseQuery(database);
+    databaseQuery.prepare("insert or replace into open_graph values((:url),(:data),(:fetched_at))");
+    databaseQuery.bindValue(":url", canonicalUrl);
+    databaseQuery.bindValue(":data", entry.openGraphData.isEmpty() ? QByteArray() : QJsonDocument::fromVariant(entry.openGraphData).toJson(QJsonDocument::Compact));
+    databaseQuery.bindValue(":fetched_at", entry.fetchedAt);
+    if (!databaseQuery.exec()) {
+        qDebug() << "Error storing Open Graph data for " + canonicalUrl << databaseQuery.lastError().text();
+    }
+}
+
+bool OpenGraphCache::isExpired(const CacheEntry &entry) const
+{
+    qint64 maximumAge = entry.openGraphData.isEmpty() ? OPEN_GRAPH_NOT_FOUND_TTL_SECONDS : OPEN_GRAPH_TTL_SECONDS;
+    return QDateTime::currentMSecsSinceEpoch() / 1000 - entry.fetchedAt > maximumAge;
+}
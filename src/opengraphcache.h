@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef OPENGRAPHCACHE_H
+#define OPENGRAPHCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QSqlDatabase>
+
+// Remembers Open Graph lookups (including pages without Open Graph data) in memory and in the cache database
+class OpenGraphCache : public QObject
+{
+    Q_OBJECT
+public:
+    enum LookupResult {
+        Miss,
+        Found,
+        NotFound
+    };
+
+    explicit OpenGraphCache(QObject *parent = nullptr);
+    ~OpenGraphCache();
+
+    static QString getCanonicalUrl(const QString &address);
+
+    LookupResult lookup(const QString &address, QVariantMap &openGraphData);
+    void insert(const QString &address, const QVariantMap &openGraphData);
+    void insertNotFound(const QString &address);
+
+    // Returns false if the address is already being fetched, the requester is notified together with the first one
+    bool addRequester(const QString &address);
+    QStringList takeRequesters(const QString &address);
+    // Returns true if nobody else waits for the address anymore
+    bool removeRequester(const QString &address);
+
+private:
+    struct CacheEntry {
+        QVariantMap openGraphData;
+        qint64 fetchedAt;
+    };
+
+    // Most recently used entries only, all others are read from the database again when needed
+    QCache<QString, CacheEntry> entries;
+    QHash<QString, QStringList> requesters;
+    QSqlDatabase database;
+
+    void initializeDatabase();
+    void store(const QString &canonicalUrl, const CacheEntry &entry);
+    bool isExpired(const CacheEntry &entry) const;
+};
+
+#endif // OPENGRAPHCACHE_H
@@ -0,0 +1,325 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "opengraphresponsehandler.h"
+#include "htmlcharsetdecoder.h"
+
+#include <cctype>
+#include <QDebug>
+#include <QRegularExpression>
+
+// We never read more than this from a page, even if its head doesn't seem to end
+const qint64 MAX_OPEN_GRAPH_BYTES = 256 * 1024;
+
+namespace {
+
+int indexOfCaseInsensitive(const QByteArray &haystack, const char *needle, int from)
+{
+    const int needleLength = qstrlen(needle);
+    for (int i = from; i <= haystack.size() - needleLength; i++) {
+        if (qstrnicmp(haystack.constData() + i, needle, needleLength) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Position of the '>' which closes the tag starting at tagStart, ignoring '>' in quoted attribute values
+int findTagEnd(const QByteArray &buffer, int tagStart)
+{
+    char quote = 0;
+    for (int i = tagStart + 1; i < buffer.size(); i++) {
+        const char character = buffer.at(i);
+        if (quote) {
+            if (character == quote) {
+                quote = 0;
+            }
+        } else if (character == '"' || character == '\'') {
+            quote = character;
+        } else if (character == '>') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QMap<QByteArray, QByteArray> parseAttributes(const QByteArray &tag)
+{
+    QMap<QByteArray, QByteArray> attributes;
+    const char *current = tag.constData();
+    const char *end = current + tag.size();
+
+    // Skip the tag name
+    while (current < end && !isspace(static_cast<unsigned char>(*current)) && *current != '/') {
+        current++;
+    }
+    while (current < end) {
+        while (current < end && (isspace(static_cast<unsigned char>(*current)) || *current == '/')) {
+            current++;
+        }
+        const char *nameStart = current;
+        while (current < end && !isspace(static_cast<unsigned char>(*current)) && *current != '=' && *current != '/') {
+            current++;
+        }
+        QByteArray name = QByteArray(nameStart, current - nameStart).toLower();
+        while (current < end && isspace(static_cast<unsigned char>(*current))) {
+            current++;
+        }
+        QByteArray value;
+        if (current < end && *current == '=') {
+            current++;
+            while (current < end && isspace(static_cast<unsigned char>(*current))) {
+                current++;
+            }
+            if (current < end && (*current == '"' || *current == '\'')) {
+                const char quote = *current++;
+                const char *valueStart = current;
+                while (current < end && *current != quote) {
+                    current++;
+                }
+                value = QByteArray(valueStart, current - valueStart);
+                if (current < end) {
+                    current++;
+                }
+            } else {
+                const char *valueStart = current;
+                while (current < end && !isspace(static_cast<unsigned char>(*current))) {
+                    current++;
+                }
+                value = QByteArray(valueStart, current - valueStart);
+            }
+        }
+        if (!name.isEmpty() && !attributes.contains(name)) {
+            attributes.insert(name, value);
+        }
+    }
+    return attributes;
+}
+
+QString decodeEntities(const QString &text)
+{
+    if (!text.contains('&')) {
+        return text;
+    }
+    QString decodedText = text;
+    QRegularExpression numericEntityExpression("&#(x?)([0-9a-fA-F]+);");
+    QRegularExpressionMatch numericEntityMatch;
+    int position = 0;
+    while ((numericEntityMatch = numericEntityExpression.match(decodedText, position)).hasMatch()) {
+        bool ok = false;
+        uint codePoint = numericEntityMatch.captured(2).toUInt(&ok, numericEntityMatch.captured(1).isEmpty() ? 10 : 16);
+        QString replacement = (ok && codePoint > 0 && codePoint <= 0x10FFFF) ? QString::fromUcs4(&codePoint, 1) : numericEntityMatch.captured(0);
+        decodedText.replace(numericEntityMatch.capturedStart(), numericEntityMatch.capturedLength(), replacement);
+        position = numericEntityMatch.capturedStart() + replacement.length();
+    }
+    decodedText.replace("&quot;", "\"");
+    decodedText.replace("&apos;", "'");
+    decodedText.replace("&lt;", "<");
+    decodedText.replace("&gt;", ">");
+    decodedText.replace("&nbsp;", QString(QChar(0x00A0)));
+    decodedText.replace("&amp;", "&");
+    return decodedText;
+}
+
+}
+
+OpenGraphResponseHandler::OpenGraphResponseHandler(const QString &address, TwitterApi *twitterApi)
+{
+    this->address = address;
+    this->twitterApi = twitterApi;
+    this->scanPosition = 0;
+    this->bytesReceived = 0;
+    this->completed = false;
+}
+
+OpenGraphResponseHandler::~OpenGraphResponseHandler()
+{
+}
+
+void OpenGraphResponseHandler::handleOpenGraphReadyRead()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (this->completed) {
+        return;
+    }
+    if (this->bytesReceived == 0 && !isHtml(reply)) {
+        this->completed = true;
+        reply->abort();
+        twitterApi->deliverOpenGraphError(this->address, this->address + " is not HTML", true);
+        return;
+    }
+
+    if (this->charsetDecoder.isNull()) {
+        this->charsetDecoder.reset(new HtmlCharsetDecoder(reply->header(QNetworkRequest::ContentTypeHeader).toString()));
+    }
+    QByteArray receivedData = reply->readAll();
+    this->bytesReceived += receivedData.size();
+    this->buffer.append(this->charsetDecoder->decode(receivedData));
+
+    if (scanBuffer() || this->bytesReceived >= MAX_OPEN_GRAPH_BYTES) {
+        qDebug() << "OpenGraphResponseHandler: Done after" << this->bytesReceived << "bytes";
+        complete(reply);
+    }
+}
+
+void OpenGraphResponseHandler::handleOpenGraphError(QNetworkReply::NetworkError error)
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (this->completed) {
+        // We aborted the reply ourselves, the result was already delivered
+        return;
+    }
+    this->completed = true;
+    qWarning() << "OpenGraphResponseHandler::handleOpenGraphError:" << (int)error << reply->errorString();
+    QVariantMap parsedErrorResponse = twitterApi->parseErrorResponse(reply->errorString(), reply->readAll());
+    twitterApi->deliverOpenGraphError(this->address, parsedErrorResponse.value("message").toString(), false);
+}
+
+void OpenGraphResponseHandler::handleOpenGraphFinished()
+{
+    qDebug() << "OpenGraphResponseHandler::handleOpenGraphFinished";
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reply->deleteLater();
+    if (this->completed || reply->error() != QNetworkReply::NoError) {
+        return;
+    }
+    if (!isHtml(reply)) {
+        this->completed = true;
+        twitterApi->deliverOpenGraphError(this->address, this->address + " is not HTML", true);
+        return;
+    }
+
+    // The whole page was shorter than its head would have needed to be
+    if (this->charsetDecoder.isNull()) {
+        this->charsetDecoder.reset(new HtmlCharsetDecoder(reply->header(QNetworkRequest::ContentTypeHeader).toString()));
+    }
+    this->buffer.append(this->charsetDecoder->decode(reply->readAll()));
+    this->buffer.append(this->charsetDecoder->finish());
+    scanBuffer();
+    complete(reply);
+}
+
+bool OpenGraphResponseHandler::isHtml(QNetworkReply *reply)
+{
+    QString requestAddress = reply->request().url().toString();
+    QVariant contentTypeHeader = reply->header(QNetworkRequest::ContentTypeHeader);
+    if (!contentTypeHeader.isValid()) {
+        return false;
+    }
+    if (contentTypeHeader.toString().indexOf("text/html", 0, Qt::CaseInsensitive) == -1) {
+        qDebug() << requestAddress + " is not HTML, not checking Open Graph data...";
+        return false;
+    }
+    return true;
+}
+
+bool OpenGraphResponseHandler::scanBuffer()
+{
+    // Returns true as soon as the head of the document is complete, consumed data is dropped from the buffer
+    bool headCompleted = false;
+    while (!headCompleted) {
+        if (!this->rawTextEnd.isEmpty()) {
+            // Inside of script or style, only the matching end tag is relevant there
+            int rawTextEndPosition = indexOfCaseInsensitive(this->buffer, this->rawTextEnd.constData(), this->scanPosition);
+            if (rawTextEndPosition == -1) {
+                this->scanPosition = qMax(this->scanPosition, this->buffer.size() - this->rawTextEnd.size());
+                break;
+            }
+            this->scanPosition = rawTextEndPosition;
+            this->rawTextEnd.clear();
+        }
+
+        int tagStart = this->buffer.indexOf('<', this->scanPosition);
+        if (tagStart == -1) {
+            this->scanPosition = this->buffer.size();
+            break;
+        }
+        if (this->buffer.mid(tagStart, 4) == "<!--") {
+            int commentEnd = this->buffer.indexOf("-->", tagStart + 4);
+            if (commentEnd == -1) {
+                this->scanPosition = tagStart;
+                break;
+            }
+            this->scanPosition = commentEnd + 3;
+            continue;
+        }
+        int tagEnd = findTagEnd(this->buffer, tagStart);
+        if (tagEnd == -1) {
+            this->scanPosition = tagStart;
+            break;
+        }
+        this->scanPosition = tagEnd + 1;
+
+        QByteArray tag = this->buffer.mid(tagStart + 1, tagEnd - tagStart - 1);
+        int tagNameLength = 0;
+        while (tagNameLength < tag.size() && !isspace(static_cast<unsigned char>(tag.at(tagNameLength))) && (tag.at(tagNameLength) != '/' || tagNameLength == 0)) {
+            tagNameLength++;
+        }
+        QByteArray tagName = tag.left(tagNameLength).toLower();
+        if (tagName == "meta") {
+            handleMetaTag(tag);
+        } else if (tagName == "/head" || tagName == "body") {
+            headCompleted = true;
+        } else if (tagName == "script" || tagName == "style") {
+            this->rawTextEnd = "</" + tagName;
+        }
+    }
+
+    this->buffer.remove(0, this->scanPosition);
+    this->scanPosition = 0;
+    return headCompleted;
+}
+
+void OpenGraphResponseHandler::handleMetaTag(const QByteArray &tag)
+{
+    QMap<QByteArray, QByteArray> attributes = parseAttributes(tag);
+    QByteArray property = attributes.value("property").toLower();
+    if (property.isEmpty()) {
+        property = attributes.value("name").toLower();
+    }
+    if (property.startsWith("og:") && !this->openGraphValues.contains(property) && attributes.contains("content")) {
+        this->openGraphValues.insert(property, attributes.value("content"));
+    }
+}
+
+void OpenGraphResponseHandler::complete(QNetworkReply *reply)
+{
+    this->completed = true;
+
+    QVariantMap openGraphData;
+    if (this->openGraphValues.contains("og:image")) {
+        openGraphData.insert("image", decodeEntities(QString::fromUtf8(this->openGraphValues.value("og:image"))));
+    }
+    if (this->openGraphValues.contains("og:description")) {
+        openGraphData.insert("description", decodeEntities(QString::fromUtf8(this->openGraphValues.value("og:description"))));
+    }
+    if (this->openGraphValues.contains("og:title")) {
+        openGraphData.insert("title", decodeEntities(QString::fromUtf8(this->openGraphValues.value("og:title"))));
+    }
+
+    if (!reply->isFinished()) {
+        reply->abort();
+    }
+
+    if (openGraphData.isEmpty()) {
+        twitterApi->deliverOpenGraphError(this->address, this->address + " does not contain Open Graph data", true);
+    } else {
+        qDebug() << "Open Graph data found for " + this->address;
+        twitterApi->deliverOpenGraph(this->address, openGraphData);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef OPENGRAPHRESPONSEHANDLER_H
+#define OPENGRAPHRESPONSEHANDLER_H
+
+#include "twitterapi.h"
+#include <QObject>
+#include <QByteArray>
+#include <QMap>
+#include <QScopedPointer>
+#include <QString>
+
+class HtmlCharsetDecoder;
+
+// Reads Open Graph data while the page is still downloading and stops as soon as the document head is complete
+class OpenGraphResponseHandler : public QObject
+{
+    Q_OBJECT
+public:
+    OpenGraphResponseHandler(const QString &address, TwitterApi *twitterApi);
+    ~OpenGraphResponseHandler();
+
+public slots:
+    void handleOpenGraphReadyRead();
+    void handleOpenGraphError(QNetworkReply::NetworkError error);
+    void handleOpenGraphFinished();
+
+private:
+    QString address;
+    TwitterApi *twitterApi;
+    QScopedPointer<HtmlCharsetDecoder> charsetDecoder;
+    // Already converted to UTF-8
+    QByteArray buffer;
+    int scanPosition;
+    qint64 bytesReceived;
+    QByteArray rawTextEnd;
+    QMap<QByteArray, QByteArray> openGraphValues;
+    bool completed;
+
+    bool isHtml(QNetworkReply *reply);
+    bool scanBuffer();
+    void handleMetaTag(const QByteArray &tag);
+    void complete(QNetworkReply *reply);
+};
+
+#endif // OPENGRAPHRESPONSEHANDLER_H
@@ -21,8 +21,18 @@
 OwnListsModel::OwnListsModel(TwitterApi *twitterApi)
 {
     this->twitterApi = twitterApi;
-    connect(twitterApi, &TwitterApi::userListsSuccessful, this, &OwnListsModel::handleUserListsSuccessful);
-    connect(twitterApi, &TwitterApi::userListsError, this, &OwnListsModel::handleUserListsError);
+}
+
+void OwnListsModel::setActive(const bool &active)
+{
+    if (active) {
+        connect(twitterApi, &TwitterApi::userListsSuccessful, this, &OwnListsModel::handleUserListsSuccessful, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::userListsError, this, &OwnListsModel::handleUserListsError, Qt::UniqueConnection);
+    } else {
+        disconnect(twitterApi, nullptr, this, nullptr);
+        // A pending update would otherwise take the lists of the next account
+        this->updateInProgress = false;
+    }
 }
 
 int OwnListsModel::rowCount(const QModelIndex &) const
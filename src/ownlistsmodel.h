@@ -29,6 +29,8 @@ class OwnListsModel : public QAbstractListModel
 public:
     OwnListsModel(TwitterApi *twitterApi);
 
+    void setActive(const bool &active);
+
     virtual int rowCount(const QModelIndex &) const;
     virtual QVariant data(const QModelIndex &index, int role) const;
 
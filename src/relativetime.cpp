@@ -0,0 +1,194 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "relativetime.h"
+
+#include <QCoreApplication>
+#include <QLocale>
+#include <QMultiMap>
+#include <QHash>
+#include <QTimer>
+
+namespace {
+
+const qint64 MINUTE_MSECS = 60 * 1000;
+const qint64 HOUR_MSECS = 60 * MINUTE_MSECS;
+const qint64 DAY_MSECS = 24 * HOUR_MSECS;
+// Labels changing within this window are refreshed together
+const qint64 COALESCING_WINDOW_MSECS = 1000;
+
+/*
+ * Keeps all RelativeTime instances ordered by their next label change and runs one timer
+ * for the earliest of them.
+ */
+class RelativeTimeScheduler
+{
+public:
+    static RelativeTimeScheduler &getInstance()
+    {
+        static RelativeTimeScheduler relativeTimeScheduler;
+        return relativeTimeScheduler;
+    }
+
+    void schedule(RelativeTime *relativeTime)
+    {
+        unschedule(relativeTime);
+        const QDateTime nextLabelChange = relativeTime->getNextLabelChange(QDateTime::currentDateTimeUtc());
+        if (!nextLabelChange.isValid()) {
+            return;
+        }
+        const qint64 nextRefresh = nextLabelChange.toMSecsSinceEpoch();
+        refreshQueue.insert(nextRefresh, relativeTime);
+        scheduledRefreshes.insert(relativeTime, nextRefresh);
+        restartTimer();
+    }
+
+    void unschedule(RelativeTime *relativeTime)
+    {
+        QHash<RelativeTime *, qint64>::iterator scheduledRefresh = scheduledRefreshes.find(relativeTime);
+        if (scheduledRefresh != scheduledRefreshes.end()) {
+            refreshQueue.remove(scheduledRefresh.value(), relativeTime);
+            scheduledRefreshes.erase(scheduledRefresh);
+        }
+    }
+
+private:
+    RelativeTimeScheduler()
+    {
+        timer = new QTimer(QCoreApplication::instance());
+        timer->setSingleShot(true);
+        QObject::connect(timer, &QTimer::timeout, [this]() {
+            refreshDueLabels();
+        });
+    }
+
+    void restartTimer()
+    {
+        if (refreshQueue.isEmpty()) {
+            timer->stop();
+            return;
+        }
+        const qint64 delay = refreshQueue.firstKey() - QDateTime::currentMSecsSinceEpoch();
+        const int interval = static_cast<int>(qBound(Q_INT64_C(0), delay, DAY_MSECS));
+        if (!timer->isActive() || timer->remainingTime() > interval) {
+            timer->start(interval);
+        }
+    }
+
+    void refreshDueLabels()
+    {
+        const qint64 dueUntil = QDateTime::currentMSecsSinceEpoch() + COALESCING_WINDOW_MSECS;
+        QList<RelativeTime *> dueRelativeTimes;
+        while (!refreshQueue.isEmpty() && refreshQueue.firstKey() <= dueUntil) {
+            RelativeTime *relativeTime = refreshQueue.take(refreshQueue.firstKey());
+            scheduledRefreshes.remove(relativeTime);
+            dueRelativeTimes.append(relativeTime);
+        }
+        for (RelativeTime *relativeTime : dueRelativeTimes) {
+            relativeTime->refresh();
+            schedule(relativeTime);
+        }
+        restartTimer();
+    }
+
+    QTimer *timer;
+    QMultiMap<qint64, RelativeTime *> refreshQueue;
+    QHash<RelativeTime *, qint64> scheduledRefreshes;
+};
+
+}
+
+RelativeTime::RelativeTime(QObject *parent) : QObject(parent)
+{
+}
+
+RelativeTime::~RelativeTime()
+{
+    RelativeTimeScheduler::getInstance().unschedule(this);
+}
+
+QString RelativeTime::getCreatedAt() const
+{
+    return this->createdAt;
+}
+
+void RelativeTime::setCreatedAt(const QString &createdAt)
+{
+    if (this->createdAt == createdAt) {
+        return;
+    }
+    this->createdAt = createdAt;
+    emit createdAtChanged();
+    // Format of Twitter dates, e.g. "Wed Aug 27 13:08:45 +0000 2008"
+    QDateTime time = QLocale::c().toDateTime(createdAt, "ddd MMM dd HH:mm:ss +0000 yyyy");
+    time.setTimeSpec(Qt::UTC);
+    setTime(time);
+}
+
+QString RelativeTime::getTimestamp() const
+{
+    return this->timestamp;
+}
+
+void RelativeTime::setTimestamp(const QString &timestamp)
+{
+    if (this->timestamp == timestamp) {
+        return;
+    }
+    this->timestamp = timestamp;
+    emit timestampChanged();
+    bool validTimestamp;
+    const qint64 msecsSinceEpoch = timestamp.toLongLong(&validTimestamp);
+    setTime(validTimestamp ? QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch, Qt::UTC) : QDateTime());
+}
+
+QDateTime RelativeTime::getTime() const
+{
+    return this->time;
+}
+
+QDateTime RelativeTime::getNextLabelChange(const QDateTime &now) const
+{
+    if (!this->time.isValid()) {
+        return QDateTime();
+    }
+    const qint64 elapsed = qMax(Q_INT64_C(0), this->time.msecsTo(now));
+    if (elapsed < HOUR_MSECS) {
+        return this->time.addMSecs((elapsed / MINUTE_MSECS + 1) * MINUTE_MSECS);
+    }
+    if (elapsed < DAY_MSECS) {
+        return this->time.addMSecs((elapsed / HOUR_MSECS + 1) * HOUR_MSECS);
+    }
+    // Older items are labelled by their day, which changes at local midnight
+    if (elapsed < 7 * DAY_MSECS) {
+        return QDateTime(now.toLocalTime().date().addDays(1), QTime(0, 0));
+    }
+    return QDateTime();
+}
+
+void RelativeTime::refresh()
+{
+    emit timeChanged();
+}
+
+void RelativeTime::setTime(const QDateTime &time)
+{
+    this->time = time;
+    emit timeChanged();
+    RelativeTimeScheduler::getInstance().schedule(this);
+}
@@ -0,0 +1,69 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RELATIVETIME_H
+#define RELATIVETIME_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QString>
+
+/*
+ * Point in time of a tweet or message for delegates which show it as elapsed time. The
+ * time is parsed once and timeChanged is emitted again only when the elapsed time label
+ * changes (every minute during the first hour, every hour during the first day and at
+ * midnight afterwards). All instances share a single timer.
+ */
+class RelativeTime : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString createdAt READ getCreatedAt WRITE setCreatedAt NOTIFY createdAtChanged)
+    Q_PROPERTY(QString timestamp READ getTimestamp WRITE setTimestamp NOTIFY timestampChanged)
+    Q_PROPERTY(QDateTime time READ getTime NOTIFY timeChanged)
+public:
+    explicit RelativeTime(QObject *parent = 0);
+    ~RelativeTime();
+
+    QString getCreatedAt() const;
+    // Twitter date as in the created_at attribute of tweets
+    void setCreatedAt(const QString &createdAt);
+    QString getTimestamp() const;
+    // Milliseconds since the epoch as in the created_timestamp attribute of direct messages
+    void setTimestamp(const QString &timestamp);
+    QDateTime getTime() const;
+
+    // Returns the time at which the elapsed time label changes next, invalid if it doesn't change anymore
+    QDateTime getNextLabelChange(const QDateTime &now) const;
+    void refresh();
+
+signals:
+    void createdAtChanged();
+    void timestampChanged();
+    void timeChanged();
+
+public slots:
+
+private:
+    QString createdAt;
+    QString timestamp;
+    QDateTime time;
+
+    void setTime(const QDateTime &time);
+};
+
+#endif // RELATIVETIME_H
@@ -22,19 +22,26 @@
 
 const char SETTINGS_CURRENT_TWEET[] = "tweets/currentId";
 
-TimelineModel::TimelineModel(TwitterApi *twitterApi)
-    : coverModel(new CoverModel(this)), settings("harbour-piepmatz", "settings")
+TimelineModel::TimelineModel(TwitterApi *twitterApi, AccountSession *session)
+    : coverModel(new CoverModel(this)), settings(session->getSettings())
 {
     this->twitterApi = twitterApi;
-
-    connect(twitterApi, &TwitterApi::homeTimelineError, this, &TimelineModel::handleHomeTimelineError);
-    connect(twitterApi, &TwitterApi::homeTimelineSuccessful, this, &TimelineModel::handleHomeTimelineSuccessful);
 }
 
 TimelineModel::~TimelineModel()
 {
 }
 
+void TimelineModel::setActive(const bool &active)
+{
+    if (active) {
+        connect(twitterApi, &TwitterApi::homeTimelineError, this, &TimelineModel::handleHomeTimelineError, Qt::UniqueConnection);
+        connect(twitterApi, &TwitterApi::homeTimelineSuccessful, this, &TimelineModel::handleHomeTimelineSuccessful, Qt::UniqueConnection);
+    } else {
+        disconnect(twitterApi, nullptr, this, nullptr);
+    }
+}
+
 int TimelineModel::rowCount(const QModelIndex &) const
 {
     return timelineTweets.size();
@@ -70,7 +77,7 @@ void TimelineModel::loadMore()
 void TimelineModel::setCurrentTweetId(const QString &tweetId)
 {
     qDebug() << "TimelineModel::setCurrentTweetId" << tweetId;
-    settings.setValue(SETTINGS_CURRENT_TWEET, tweetId);
+    settings->setValue(SETTINGS_CURRENT_TWEET, tweetId);
 }
 
 void TimelineModel::handleHomeTimelineSuccessful(const QVariantList &result, const bool incrementalUpdate)
@@ -100,7 +107,7 @@ void TimelineModel::handleHomeTimelineSuccessful(const QVariantList &result, con
     QListIterator<QVariant> tweetIterator(timelineTweets);
     int i = 0;
     int modelIndex = 0;
-    QString lastTweetId = settings.value(SETTINGS_CURRENT_TWEET).toString();
+    QString lastTweetId = settings->value(SETTINGS_CURRENT_TWEET).toString();
     while (tweetIterator.hasNext()) {
         QMap<QString,QVariant> singleTweet = tweetIterator.next().toMap();
         if (singleTweet.value("id_str").toString() == lastTweetId) {
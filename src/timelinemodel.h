@@ -23,15 +23,18 @@
 #include <QSettings>
 #include <QVariantList>
 #include "twitterapi.h"
+#include "accountsession.h"
 #include "covermodel.h"
 
 class TimelineModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
-    TimelineModel(TwitterApi *twitterApi);
+    TimelineModel(TwitterApi *twitterApi, AccountSession *session);
     ~TimelineModel();
 
+    void setActive(const bool &active);
+
     virtual int rowCount(const QModelIndex&) const;
     virtual QVariant data(const QModelIndex &index, int role) const;
 
@@ -53,7 +56,7 @@ public slots:
 
 private:
     QVariantList timelineTweets;
-    QSettings settings;
+    QSettings *settings;
     TwitterApi *twitterApi;
 
 };
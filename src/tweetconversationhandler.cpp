@@ -18,11 +18,12 @@
 */
 #include "tweetconversationhandler.h"
 
-TweetConversationHandler::TweetConversationHandler(TwitterApi *twitterApi, QString tweetId, QVariantList relatedTweets, QObject *parent) : QObject(parent)
+TweetConversationHandler::TweetConversationHandler(TwitterApi *twitterApi, ConversationGraph *conversationGraph, QString tweetId, QVariantList relatedTweets, QObject *parent) : QObject(parent)
 {
     this->tweetId = tweetId;
     this->relatedTweets = relatedTweets;
     this->twitterApi = twitterApi;
+    this->conversationGraph = conversationGraph;
 
     connect(this->twitterApi, SIGNAL(showStatusError(QString)), this, SLOT(handleShowStatusError(QString)));
     connect(this->twitterApi, SIGNAL(showStatusSuccessful(QVariantMap)), this, SLOT(handleShowStatusSuccessful(QVariantMap)));
@@ -35,7 +36,15 @@ void TweetConversationHandler::buildConversation()
         QListIterator<QVariant> relatedTweetIterator(relatedTweets);
         while (relatedTweetIterator.hasNext()) {
             QString relatedTweetId = relatedTweetIterator.next().toString();
-            twitterApi->showStatus(relatedTweetId);
+            // Only tweets which aren't stored already are requested
+            QVariantMap storedTweet = conversationGraph->getTweet(relatedTweetId);
+            if (storedTweet.isEmpty()) {
+                twitterApi->showStatus(relatedTweetId);
+            } else {
+                qDebug() << "Tweet from a conversation found in cache" << relatedTweetId;
+                this->receivedTweets.insert(relatedTweetId, storedTweet);
+                this->handleTweetReceived();
+            }
         }
     }
 }
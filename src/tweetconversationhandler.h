@@ -21,12 +21,13 @@
 
 #include <QObject>
 #include "twitterapi.h"
+#include "conversationgraph.h"
 
 class TweetConversationHandler : public QObject
 {
     Q_OBJECT
 public:
-    explicit TweetConversationHandler(TwitterApi *twitterApi, QString tweetId, QVariantList relatedTweets, QObject *parent = 0);
+    explicit TweetConversationHandler(TwitterApi *twitterApi, ConversationGraph *conversationGraph, QString tweetId, QVariantList relatedTweets, QObject *parent = 0);
 
     Q_INVOKABLE void buildConversation();
 
@@ -44,6 +45,7 @@ private:
     QVariantList relatedTweets;
     QVariantMap receivedTweets;
     TwitterApi *twitterApi;
+    ConversationGraph *conversationGraph;
     int tweetsReceived = 0;
 
     void handleTweetReceived();
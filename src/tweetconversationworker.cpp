@@ -0,0 +1,64 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "tweetconversationworker.h"
+#include "htmlcharsetdecoder.h"
+
+#include "QGumboParser/qgumbodocument.h"
+#include "QGumboParser/qgumbonode.h"
+#include "QGumboParser/qgumboselector.h"
+
+#include <QDebug>
+#include <stdexcept>
+
+TweetConversationWorker::TweetConversationWorker(const QString &tweetId, const QByteArray &htmlDocument, const QString &contentType, QObject *parent) : QThread(parent)
+{
+    this->tweetId = tweetId;
+    this->htmlDocument = htmlDocument;
+    this->contentType = contentType;
+}
+
+void TweetConversationWorker::parseConversation()
+{
+    qDebug() << "TweetConversationWorker::parseConversation" << this->tweetId;
+
+    QVariantList relatedTweets;
+    try {
+        // Gumbo works on UTF-8, for UTF-8 pages the decoder hands the received bytes through untouched
+        HtmlCharsetDecoder charsetDecoder(this->contentType);
+        QByteArray utf8Document = charsetDecoder.decode(this->htmlDocument);
+        utf8Document.append(charsetDecoder.finish());
+        this->htmlDocument.clear();
+        QGumboDocument parsedResult = QGumboDocument::parse(utf8Document);
+        QGumboNode root = parsedResult.rootNode();
+
+        static const QGumboSelector tweetSelector = QGumboSelector::compile(".tweet:not(.promoted-tweet)[data-tweet-id]");
+        QGumboNodes tweetNodes = root.querySelectorAll(tweetSelector);
+        for (QGumboNode &tweetNode : tweetNodes) {
+            QString otherTweetId = tweetNode.getAttribute("data-tweet-id");
+            if (!otherTweetId.isEmpty()) {
+                qDebug() << "Found Tweet ID: " << otherTweetId;
+                relatedTweets.append(otherTweetId);
+            }
+        }
+    } catch (const std::exception &exception) {
+        qWarning() << "Unable to parse conversation of tweet" << this->tweetId << exception.what();
+    }
+
+    emit conversationParsed(this->tweetId, relatedTweets);
+}
@@ -0,0 +1,48 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TWEETCONVERSATIONWORKER_H
+#define TWEETCONVERSATIONWORKER_H
+
+#include <QThread>
+#include <QByteArray>
+#include <QString>
+#include <QVariantList>
+
+// Parses a tweet's HTML page in the background and only hands the IDs of the related tweets back
+class TweetConversationWorker : public QThread
+{
+    Q_OBJECT
+    void run() Q_DECL_OVERRIDE {
+        parseConversation();
+    }
+public:
+    TweetConversationWorker(const QString &tweetId, const QByteArray &htmlDocument, const QString &contentType, QObject *parent = 0);
+
+signals:
+    void conversationParsed(const QString &tweetId, const QVariantList &relatedTweets);
+
+private:
+    void parseConversation();
+
+    QString tweetId;
+    QByteArray htmlDocument;
+    QString contentType;
+};
+
+#endif // TWEETCONVERSATIONWORKER_H
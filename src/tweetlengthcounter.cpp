@@ -0,0 +1,381 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "tweetlengthcounter.h"
+#include "emojimatcher.h"
+
+#include <QDebug>
+#include <QStringList>
+
+namespace {
+
+// Configuration of twitter-text (version 2), weights are scaled by 100
+const int WEIGHT_SCALE = 100;
+const int DEFAULT_WEIGHT = 200;
+const int MAX_WEIGHTED_TWEET_LENGTH = 280;
+const int DEFAULT_TRANSFORMED_URL_LENGTH = 23;
+
+struct WeightRange {
+    uint start;
+    uint end;
+    int weight;
+};
+
+const WeightRange WEIGHT_RANGES[] = {
+    { 0, 4351, 100 },
+    { 8192, 8205, 100 },
+    { 8208, 8223, 100 },
+    { 8242, 8247, 100 }
+};
+
+// URLs without protocol are only detected for these top level domains
+const char GENERIC_TOP_LEVEL_DOMAINS[] = " com net org info biz edu gov mil int name pro mobi aero asia cat coop jobs museum tel travel "
+        "app dev io blog xyz online site shop club news tech page art top live store social wiki space website email cloud media link network digital world today ";
+const char COUNTRY_CODE_TOP_LEVEL_DOMAINS[] = " ac ad ae af ag ai al am an ao aq ar as at au aw ax az ba bb bd be bf bg bh bi bj bl bm bn bo bq br bs bt bv bw by bz "
+        "ca cc cd cf cg ch ci ck cl cm cn co cr cu cv cw cx cy cz de dj dk dm do dz ec ee eg eh er es et eu fi fj fk fm fo fr ga gb gd ge gf gg gh gi "
+        "gl gm gn gp gq gr gs gt gu gw gy hk hm hn hr ht hu id ie il im in io iq ir is it je jm jo jp ke kg kh ki km kn kp kr kw ky kz la lb lc li lk "
+        "lr ls lt lu lv ly ma mc md me mf mg mh mk ml mm mn mo mp mq mr ms mt mu mv mw mx my mz na nc ne nf ng ni nl no np nr nu nz om pa pe pf pg ph "
+        "pk pl pm pn pr ps pt pw py qa re ro rs ru rw sa sb sc sd se sg sh si sj sk sl sm sn so sr ss st su sv sx sy sz tc td tf tg th tj tk tl tm tn "
+        "to tp tr tt tv tw tz ua ug uk um us uy uz va vc ve vg vi vn vu wf ws ye yt za zm zw ";
+
+int getCharacterWeight(const uint &codePoint)
+{
+    for (const WeightRange &weightRange : WEIGHT_RANGES) {
+        if (codePoint >= weightRange.start && codePoint <= weightRange.end) {
+            return weightRange.weight;
+        }
+    }
+    return DEFAULT_WEIGHT;
+}
+
+bool isInvalidCharacter(const uint &codePoint)
+{
+    return codePoint == 0xFFFE || codePoint == 0xFEFF || codePoint == 0xFFFF;
+}
+
+bool isAsciiAlphanumeric(const QChar &character)
+{
+    const ushort unicode = character.unicode();
+    return (unicode >= 'a' && unicode <= 'z') || (unicode >= 'A' && unicode <= 'Z') || (unicode >= '0' && unicode <= '9');
+}
+
+bool isHostCharacter(const QChar &character, const bool &asciiOnly)
+{
+    return isAsciiAlphanumeric(character) || character == QLatin1Char('-') || character == QLatin1Char('_') || character == QLatin1Char('.') ||
+            (!asciiOnly && character.unicode() >= 0x80 && character.isLetterOrNumber());
+}
+
+bool isPathCharacter(const QChar &character)
+{
+    return character.isLetterOrNumber() || QByteArray("!*';:=+,.$/%#[]-_~@|&?()").contains(character.toLatin1()) || character.unicode() == 0x2013;
+}
+
+bool isPathEndingCharacter(const QChar &character)
+{
+    return character.isLetterOrNumber() || QByteArray("+-=_#/&").contains(character.toLatin1());
+}
+
+bool containsDomain(const char *domains, const QString &topLevelDomain)
+{
+    return qstrstr(domains, QByteArray(" " + topLevelDomain.toLatin1() + " ").constData()) != 0;
+}
+
+bool startsWithProtocol(const QString &word, const int &position, int &protocolLength)
+{
+    if (word.midRef(position, 7).compare(QLatin1String("http://"), Qt::CaseInsensitive) == 0) {
+        protocolLength = 7;
+        return true;
+    }
+    if (word.midRef(position, 8).compare(QLatin1String("https://"), Qt::CaseInsensitive) == 0) {
+        protocolLength = 8;
+        return true;
+    }
+    protocolLength = 0;
+    return false;
+}
+
+}
+
+TweetLengthCounter::TweetLengthCounter(QObject *parent) : QObject(parent)
+{
+    this->totalWeight = 0;
+    this->invalidSegments = 0;
+    this->transformedUrlLength = DEFAULT_TRANSFORMED_URL_LENGTH;
+}
+
+void TweetLengthCounter::setConfiguration(const QVariantMap &configuration)
+{
+    const int shortUrlLength = configuration.value("short_url_length_https").toInt();
+    if (shortUrlLength <= 0 || shortUrlLength == this->transformedUrlLength) {
+        return;
+    }
+    qDebug() << "TweetLengthCounter::setConfiguration" << shortUrlLength;
+    this->transformedUrlLength = shortUrlLength;
+    const QString text = this->currentText;
+    this->currentText.clear();
+    this->segments.clear();
+    this->totalWeight = 0;
+    this->invalidSegments = 0;
+    updateText(text);
+}
+
+void TweetLengthCounter::updateText(const QString &text)
+{
+    if (text == this->currentText) {
+        return;
+    }
+
+    // Determine the edited range from the common prefix and suffix of the old and the new text
+    const int oldLength = this->currentText.length();
+    const int newLength = text.length();
+    const int commonLength = qMin(oldLength, newLength);
+    int prefixLength = 0;
+    while (prefixLength < commonLength && this->currentText.at(prefixLength) == text.at(prefixLength)) {
+        prefixLength++;
+    }
+    int suffixLength = 0;
+    while (suffixLength < commonLength - prefixLength && this->currentText.at(oldLength - suffixLength - 1) == text.at(newLength - suffixLength - 1)) {
+        suffixLength++;
+    }
+    const int changeEnd = oldLength - suffixLength;
+
+    // Segments touching the edited range are measured again, their neighbours remain valid
+    int firstSegment = this->segments.size();
+    int lastSegment = -1;
+    int regionStart = 0;
+    int regionEnd = 0;
+    int segmentStart = 0;
+    for (int i = 0; i < this->segments.size(); i++) {
+        const int segmentEnd = segmentStart + this->segments.at(i).length;
+        if (segmentStart > changeEnd) {
+            break;
+        }
+        if (segmentEnd >= prefixLength && firstSegment > i) {
+            firstSegment = i;
+            regionStart = segmentStart;
+        }
+        lastSegment = i;
+        regionEnd = segmentEnd;
+        segmentStart = segmentEnd;
+    }
+    if (firstSegment > lastSegment) {
+        firstSegment = this->segments.size();
+        lastSegment = firstSegment - 1;
+        regionStart = oldLength;
+        regionEnd = oldLength;
+    }
+
+    QVector<Segment> measuredSegments;
+    measureSegments(text, regionStart, regionEnd + newLength - oldLength, measuredSegments);
+    for (int i = firstSegment; i <= lastSegment; i++) {
+        const Segment &segment = this->segments.at(i);
+        this->totalWeight -= segment.weight;
+        this->invalidSegments -= segment.invalid ? 1 : 0;
+    }
+    for (const Segment &segment : measuredSegments) {
+        this->totalWeight += segment.weight;
+        this->invalidSegments += segment.invalid ? 1 : 0;
+    }
+    this->segments.remove(firstSegment, lastSegment - firstSegment + 1);
+    for (int i = 0; i < measuredSegments.size(); i++) {
+        this->segments.insert(firstSegment + i, measuredSegments.at(i));
+    }
+    this->currentText = text;
+}
+
+int TweetLengthCounter::getWeightedLength()
+{
+    return this->totalWeight / WEIGHT_SCALE;
+}
+
+int TweetLengthCounter::getPermillage()
+{
+    return getWeightedLength() * 1000 / MAX_WEIGHTED_TWEET_LENGTH;
+}
+
+bool TweetLengthCounter::isValid()
+{
+    const int weightedLength = getWeightedLength();
+    return this->invalidSegments == 0 && weightedLength > 0 && weightedLength <= MAX_WEIGHTED_TWEET_LENGTH;
+}
+
+int TweetLengthCounter::getTweetLength(const QString &text)
+{
+    QVector<Segment> measuredSegments;
+    measureSegments(text, 0, text.length(), measuredSegments);
+    int weight = 0;
+    for (const Segment &segment : measuredSegments) {
+        weight += segment.weight;
+    }
+    return weight / WEIGHT_SCALE;
+}
+
+void TweetLengthCounter::measureSegments(const QString &text, const int &start, const int &end, QVector<Segment> &measuredSegments) const
+{
+    int segmentStart = start;
+    while (segmentStart < end) {
+        const bool whitespace = text.at(segmentStart).isSpace();
+        int segmentEnd = segmentStart + 1;
+        while (segmentEnd < end && text.at(segmentEnd).isSpace() == whitespace) {
+            segmentEnd++;
+        }
+
+        Segment segment;
+        segment.length = segmentEnd - segmentStart;
+        segment.invalid = false;
+        if (whitespace) {
+            segment.weight = 0;
+            for (int i = segmentStart; i < segmentEnd; i++) {
+                segment.weight += getCharacterWeight(text.at(i).unicode());
+            }
+        } else {
+            segment.weight = measureWord(text.mid(segmentStart, segment.length), segment.invalid);
+        }
+        measuredSegments.append(segment);
+        segmentStart = segmentEnd;
+    }
+}
+
+int TweetLengthCounter::measureWord(const QString &word, bool &invalid) const
+{
+    // Twitter counts the NFC normalized text
+    bool ascii = true;
+    for (const QChar &character : word) {
+        if (character.unicode() >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+    const QString normalizedWord = ascii ? word : word.normalized(QString::NormalizationForm_C);
+
+    const EmojiMatcher &emojiMatcher = EmojiMatcher::getInstance();
+    int weight = 0;
+    int position = 0;
+    while (position < normalizedWord.length()) {
+        const int urlEnd = getUrlEnd(normalizedWord, position);
+        if (urlEnd > position) {
+            weight += this->transformedUrlLength * WEIGHT_SCALE;
+            position = urlEnd;
+            continue;
+        }
+        if (!ascii) {
+            const int emojiLength = emojiMatcher.getEmojiLength(normalizedWord, position);
+            if (emojiLength > 0) {
+                weight += DEFAULT_WEIGHT;
+                position += emojiLength;
+                continue;
+            }
+        }
+
+        uint codePoint = normalizedWord.at(position).unicode();
+        if (QChar::isHighSurrogate(codePoint) && position + 1 < normalizedWord.length() && normalizedWord.at(position + 1).isLowSurrogate()) {
+            codePoint = QChar::surrogateToUcs4(normalizedWord.at(position), normalizedWord.at(position + 1));
+            position++;
+        }
+        position++;
+        weight += getCharacterWeight(codePoint);
+        invalid = invalid || isInvalidCharacter(codePoint);
+    }
+    return weight;
+}
+
+int TweetLengthCounter::getUrlEnd(const QString &word, const int &position) const
+{
+    // URLs may not be glued to a preceding word, mention, cashtag or hashtag
+    if (!isAsciiAlphanumeric(word.at(position))) {
+        return -1;
+    }
+    if (position > 0) {
+        const QChar precedingCharacter = word.at(position - 1);
+        if (isAsciiAlphanumeric(precedingCharacter) || QByteArray("@$#").contains(precedingCharacter.toLatin1()) ||
+                precedingCharacter.unicode() == 0xFF20 || precedingCharacter.unicode() == 0xFF03) {
+            return -1;
+        }
+    }
+
+    int protocolLength;
+    const bool withProtocol = startsWithProtocol(word, position, protocolLength);
+    if (!withProtocol && position > 0 && QByteArray("-_./").contains(word.at(position - 1).toLatin1())) {
+        return -1;
+    }
+
+    const int hostStart = position + protocolLength;
+    int hostEnd = hostStart;
+    while (hostEnd < word.length() && isHostCharacter(word.at(hostEnd), !withProtocol)) {
+        hostEnd++;
+    }
+    while (hostEnd > hostStart && !word.at(hostEnd - 1).isLetterOrNumber()) {
+        hostEnd--;
+    }
+    const QStringList labels = word.mid(hostStart, hostEnd - hostStart).split(QLatin1Char('.'));
+    if (labels.size() < 2 || labels.contains(QString())) {
+        return -1;
+    }
+    const QString topLevelDomain = labels.last().toLower();
+    const bool countryCode = containsDomain(COUNTRY_CODE_TOP_LEVEL_DOMAINS, topLevelDomain);
+    if (withProtocol) {
+        // Any alphabetic top level domain is fine with an explicit protocol
+        if (topLevelDomain.length() < 2) {
+            return -1;
+        }
+        if (!topLevelDomain.startsWith(QLatin1String("xn--"))) {
+            for (const QChar &character : topLevelDomain) {
+                if (character < QLatin1Char('a') || character > QLatin1Char('z')) {
+                    return -1;
+                }
+            }
+        }
+    } else if (!countryCode && !containsDomain(GENERIC_TOP_LEVEL_DOMAINS, topLevelDomain)) {
+        return -1;
+    }
+
+    int urlEnd = hostEnd;
+    if (urlEnd + 1 < word.length() && word.at(urlEnd) == QLatin1Char(':') && word.at(urlEnd + 1).isDigit()) {
+        urlEnd++;
+        while (urlEnd < word.length() && word.at(urlEnd).isDigit()) {
+            urlEnd++;
+        }
+    }
+
+    int pathEnd = urlEnd;
+    if (pathEnd < word.length() && QByteArray("/?#").contains(word.at(pathEnd).toLatin1())) {
+        int openParentheses = 0;
+        while (pathEnd < word.length() && isPathCharacter(word.at(pathEnd))) {
+            if (word.at(pathEnd) == QLatin1Char('(')) {
+                openParentheses++;
+            } else if (word.at(pathEnd) == QLatin1Char(')')) {
+                if (openParentheses == 0) {
+                    break;
+                }
+                openParentheses--;
+            }
+            pathEnd++;
+        }
+        // Trailing punctuation belongs to the sentence, not to the URL
+        while (pathEnd > urlEnd && !isPathEndingCharacter(word.at(pathEnd - 1)) && word.at(pathEnd - 1) != QLatin1Char(')')) {
+            pathEnd--;
+        }
+    }
+    const bool hasPath = pathEnd > urlEnd;
+
+    // Without protocol, plain country code domains like example.de are only URLs with a path
+    if (!withProtocol && countryCode && labels.size() == 2 && !hasPath && word.midRef(hostStart, hostEnd - hostStart).compare(QLatin1String("t.co"), Qt::CaseInsensitive) != 0) {
+        return -1;
+    }
+    return pathEnd;
+}
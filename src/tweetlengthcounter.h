@@ -0,0 +1,70 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TWEETLENGTHCOUNTER_H
+#define TWEETLENGTHCOUNTER_H
+
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+/*
+ * Counts the weighted length of tweets like twitter-text does: URLs count with the length
+ * of the shortened t.co links, CJK characters twice and emoji sequences as two characters.
+ * The text is split into words and whitespace, on each update only the words touched by the
+ * edit are measured again.
+ */
+class TweetLengthCounter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TweetLengthCounter(QObject *parent = 0);
+
+    Q_INVOKABLE void setConfiguration(const QVariantMap &configuration);
+    Q_INVOKABLE void updateText(const QString &text);
+    Q_INVOKABLE int getWeightedLength();
+    Q_INVOKABLE int getPermillage();
+    Q_INVOKABLE bool isValid();
+    // Measures the given text from scratch, e.g. for image descriptions and direct messages
+    Q_INVOKABLE int getTweetLength(const QString &text);
+
+signals:
+
+public slots:
+
+private:
+
+    struct Segment {
+        int length;
+        int weight;
+        bool invalid;
+    };
+
+    QString currentText;
+    QVector<Segment> segments;
+    int totalWeight;
+    int invalidSegments;
+    int transformedUrlLength;
+
+    void measureSegments(const QString &text, const int &start, const int &end, QVector<Segment> &measuredSegments) const;
+    int measureWord(const QString &word, bool &invalid) const;
+    int getUrlEnd(const QString &word, const int &position) const;
+};
+
+#endif // TWEETLENGTHCOUNTER_H
@@ -0,0 +1,182 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "tweettextrenderer.h"
+
+#include <QDebug>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+struct Replacement {
+    int beginOffset;
+    int endOffset;
+    QString originalString;
+    QString replacementString;
+};
+
+bool isTweetUrl(const QString &url)
+{
+    return url.contains("twitter.com/") && url.contains("/status/");
+}
+
+// Twitter counts code points, QString counts UTF-16 code units
+QVector<int> getCodePointOffsets(const QString &text)
+{
+    QVector<int> codePointOffsets;
+    codePointOffsets.reserve(text.size() + 1);
+    for (int i = 0; i < text.size(); i++) {
+        codePointOffsets.append(i);
+        if (text.at(i).isHighSurrogate() && i + 1 < text.size() && text.at(i + 1).isLowSurrogate()) {
+            i++;
+        }
+    }
+    codePointOffsets.append(text.size());
+    return codePointOffsets;
+}
+
+void appendReplacement(QList<Replacement> &replacements, const QVector<int> &codePointOffsets, const QVariantMap &entity, const QString &originalString, const QString &replacementString)
+{
+    QVariantList indices = entity.value("indices").toList();
+    if (indices.size() < 2) {
+        return;
+    }
+    int beginIndex = indices.at(0).toInt();
+    int endIndex = indices.at(1).toInt();
+    Replacement replacement;
+    replacement.beginOffset = codePointOffsets.value(beginIndex, -1);
+    replacement.endOffset = codePointOffsets.value(endIndex, -1);
+    replacement.originalString = originalString;
+    replacement.replacementString = replacementString;
+    replacements.append(replacement);
+}
+
+}
+
+void TweetTextRenderer::renderTweets(QVariantList &tweets)
+{
+    for (QVariant &tweet : tweets) {
+        QVariantMap tweetMap = tweet.toMap();
+        renderTweet(tweetMap);
+        tweet = tweetMap;
+    }
+}
+
+void TweetTextRenderer::renderTweet(QVariantMap &tweet)
+{
+    if (tweet.contains("retweeted_status")) {
+        QVariantMap retweetedStatus = tweet.value("retweeted_status").toMap();
+        renderTweet(retweetedStatus);
+        tweet.insert("retweeted_status", retweetedStatus);
+    }
+    if (tweet.contains("quoted_status")) {
+        QVariantMap quotedStatus = tweet.value("quoted_status").toMap();
+        renderTweet(quotedStatus);
+        tweet.insert("quoted_status", quotedStatus);
+    }
+    if (!tweet.contains("full_text")) {
+        return;
+    }
+    tweet.insert("rendered_text", renderText(tweet.value("full_text").toString(), tweet.value("entities").toMap(), tweet.value("extended_entities").toMap(), true));
+}
+
+QString TweetTextRenderer::renderText(const QString &text, const QVariantMap &entities, const QVariantMap &extendedEntities, const bool &followEmbeddedTweet)
+{
+    QList<Replacement> replacements;
+    const QVector<int> codePointOffsets = getCodePointOffsets(text);
+
+    // URLs, embedded tweets are shown on their own
+    const QVariantList urls = entities.value("urls").toList();
+    for (const QVariant &url : urls) {
+        QVariantMap urlEntity = url.toMap();
+        QString expandedUrl = urlEntity.value("expanded_url").toString();
+        if (followEmbeddedTweet && isTweetUrl(expandedUrl)) {
+            appendReplacement(replacements, codePointOffsets, urlEntity, urlEntity.value("url").toString(), QString());
+        } else {
+            appendReplacement(replacements, codePointOffsets, urlEntity, urlEntity.value("url").toString(), "<a href=\"" + expandedUrl + "\">" + urlEntity.value("display_url").toString() + "</a>");
+        }
+    }
+    // Media links, media is shown on its own
+    const QVariantList media = extendedEntities.value("media").toList();
+    for (const QVariant &mediaItem : media) {
+        QVariantMap mediaEntity = mediaItem.toMap();
+        appendReplacement(replacements, codePointOffsets, mediaEntity, mediaEntity.value("url").toString(), QString());
+    }
+    // User Mentions
+    const QVariantList userMentions = entities.value("user_mentions").toList();
+    for (const QVariant &userMention : userMentions) {
+        QVariantMap userMentionEntity = userMention.toMap();
+        QString screenName = userMentionEntity.value("screen_name").toString();
+        appendReplacement(replacements, codePointOffsets, userMentionEntity, "@" + screenName, "<a href=\"profile://" + screenName + "\">@" + screenName + "</a>");
+    }
+    // Hashtags
+    const QVariantList hashtags = entities.value("hashtags").toList();
+    for (const QVariant &hashtag : hashtags) {
+        QVariantMap hashtagEntity = hashtag.toMap();
+        QString hashtagText = "#" + hashtagEntity.value("text").toString();
+        appendReplacement(replacements, codePointOffsets, hashtagEntity, hashtagText, "<a href=\"tag://" + hashtagText + "\">" + hashtagText + "</a>");
+    }
+
+    // Replaced from the end, so that the offsets of the remaining replacements stay valid
+    std::stable_sort(replacements.begin(), replacements.end(), [](const Replacement &first, const Replacement &second) {
+        return first.beginOffset > second.beginOffset;
+    });
+    QString renderedText = text;
+    for (const Replacement &replacement : replacements) {
+        if (replacement.beginOffset >= 0 && replacement.endOffset >= replacement.beginOffset &&
+                renderedText.midRef(replacement.beginOffset, replacement.endOffset - replacement.beginOffset).compare(replacement.originalString, Qt::CaseInsensitive) == 0) {
+            renderedText.replace(replacement.beginOffset, replacement.endOffset - replacement.beginOffset, replacement.replacementString);
+        } else {
+            // Sometimes our offsets do not match the offsets by Twitter - trying a failsafe instead
+            qDebug() << "Failsafe replacement used for " + replacement.originalString;
+            int originalOffset = renderedText.indexOf(replacement.originalString);
+            if (originalOffset != -1) {
+                renderedText.replace(originalOffset, replacement.originalString.length(), replacement.replacementString);
+            }
+        }
+    }
+
+    // Line breaks and consecutive whitespace would be collapsed by StyledText
+    renderedText.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+    QString styledText;
+    styledText.reserve(renderedText.size() + renderedText.size() / 8);
+    const int textLength = renderedText.size();
+    for (int i = 0; i < textLength; i++) {
+        const QChar character = renderedText.at(i);
+        if (character == QLatin1Char('\n')) {
+            styledText.append(QLatin1String("<br>"));
+            continue;
+        }
+        if (character.isSpace()) {
+            int whitespaceEnd = i + 1;
+            while (whitespaceEnd < textLength && renderedText.at(whitespaceEnd).isSpace() && renderedText.at(whitespaceEnd) != QLatin1Char('\n')) {
+                whitespaceEnd++;
+            }
+            if (whitespaceEnd - i > 1) {
+                for (int j = i; j < whitespaceEnd; j++) {
+                    styledText.append(QLatin1String("&nbsp;"));
+                }
+                i = whitespaceEnd - 1;
+                continue;
+            }
+        }
+        styledText.append(character);
+    }
+    return styledText;
+}
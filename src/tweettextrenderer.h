@@ -0,0 +1,42 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TWEETTEXTRENDERER_H
+#define TWEETTEXTRENDERER_H
+
+#include <QString>
+#include <QVariantList>
+#include <QVariantMap>
+
+/*
+ * Turns the text of a tweet into the styled text shown by the tweet delegates: entities become
+ * links, media links and links to embedded tweets are removed, line breaks and consecutive spaces
+ * are preserved. Done once when a tweet is received, the result is stored as rendered_text.
+ * Emoji are not replaced here: their images depend on the font size and the emoji setting when
+ * the text is shown, so the delegates still pass rendered_text through EmojiMatcher.
+ */
+class TweetTextRenderer
+{
+public:
+    static void renderTweets(QVariantList &tweets);
+    // Also renders the retweeted and the quoted tweet within the tweet
+    static void renderTweet(QVariantMap &tweet);
+    static QString renderText(const QString &text, const QVariantMap &entities, const QVariantMap &extendedEntities, const bool &followEmbeddedTweet);
+};
+
+#endif // TWEETTEXTRENDERER_H
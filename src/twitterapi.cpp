@@ -21,28 +21,66 @@
 #include "imageresponsehandler.h"
 #include "imagemetadataresponsehandler.h"
 #include "downloadresponsehandler.h"
+#include "linkpreviewfetcher.h"
 #include "tweetconversationhandler.h"
-#include "contentextractor.h"
-#include "QGumboParser/qgumbodocument.h"
-#include "QGumboParser/qgumbonode.h"
+#include "tweetconversationworker.h"
+#include "articlecache.h"
+#include "articleextractionworker.h"
+#include "conversationgraph.h"
+#include "conversationprefetcher.h"
+#include "tweettextrenderer.h"
+#include "mutefilter.h"
 #include <QBuffer>
 #include <QFile>
 #include <QHttpMultiPart>
 #include <QXmlStreamReader>
 #include <QProcess>
 #include <QTextCodec>
+#include <QTimer>
 #include <QRegularExpression>
 #include <QtDBus/QDBusConnection>
 #include <QtDBus/QDBusInterface>
 
 //TwitterApi::TwitterApi(O1Requestor* requestor, QNetworkAccessManager *manager, Wagnis *wagnis, QObject* parent) : QObject(parent) {
-TwitterApi::TwitterApi(O1Requestor* requestor, QNetworkAccessManager *manager, O1Requestor *secretIdentityRequestor, QObject* parent) : QObject(parent) {
+TwitterApi::TwitterApi(O1Requestor* requestor, QSettings *settings, QNetworkAccessManager *manager, O1Requestor *secretIdentityRequestor, QObject* parent) : QObject(parent) {
     this->requestor = requestor;
     this->manager = manager;
     this->secretIdentityRequestor = secretIdentityRequestor;
+    this->openGraphCache = new OpenGraphCache(this);
+    this->linkPreviewFetcher = new LinkPreviewFetcher(this);
+    this->articleCache = new ArticleCache(this);
+    this->conversationGraph = new ConversationGraph(this);
+    this->conversationPrefetcher = new ConversationPrefetcher(requestor, conversationGraph, this);
+    this->muteFilter = new MuteFilter(settings, this);
     //this->wagnis = wagnis;
 }
 
+void TwitterApi::setRequestor(O1Requestor *requestor)
+{
+    qDebug() << "TwitterApi::setRequestor";
+    this->requestor = requestor;
+    this->conversationPrefetcher->setRequestor(requestor);
+    emit accountSwitched();
+}
+
+void TwitterApi::setSecretIdentityRequestor(O1Requestor *secretIdentityRequestor)
+{
+    qDebug() << "TwitterApi::setSecretIdentityRequestor";
+    this->secretIdentityRequestor = secretIdentityRequestor;
+}
+
+void TwitterApi::setDataDirectory(const QString &dataDirectory)
+{
+    qDebug() << "TwitterApi::setDataDirectory";
+    this->conversationGraph->setDataDirectory(dataDirectory);
+}
+
+void TwitterApi::setSettings(QSettings *settings)
+{
+    qDebug() << "TwitterApi::setSettings";
+    this->muteFilter->setSettings(settings);
+}
+
 void TwitterApi::verifyCredentials()
 {
     qDebug() << "TwitterApi::verifyCredentials";
@@ -349,6 +387,10 @@ void TwitterApi::replyToTweetWithImages(const QString &text, const QString &repl
 void TwitterApi::homeTimeline(const QString &maxId)
 {
     qDebug() << "TwitterApi::homeTimeline" << maxId;
+    if (maxId.isEmpty()) {
+        // Each refresh gets a fresh budget for link previews
+        linkPreviewFetcher->resetByteBudget();
+    }
     QUrl url = QUrl(API_STATUSES_HOME_TIMELINE);
     QUrlQuery urlQuery = QUrlQuery();
     urlQuery.addQueryItem("tweet_mode", "extended");
@@ -875,6 +917,7 @@ void TwitterApi::uploadImage(const QString &fileName)
     qDebug() << "TwitterApi::uploadImage" << fileName;
     QUrl url = QUrl(QString(API_MEDIA_UPLOAD));
     QNetworkRequest request(url);
+    request.setAttribute(O1_TIMEOUT_CLASS_ATTRIBUTE, O1TimeoutManager::UploadTimeout);
 
     QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
 
@@ -939,6 +982,7 @@ void TwitterApi::downloadFile(const QString &address, const QString &fileName)
     QUrl url = QUrl(address);
     QNetworkRequest request(url);
     QNetworkReply *reply = manager->get(request);
+    requestor->timeoutManager()->watch(reply, O1TimeoutManager::MediaTimeout);
 
     DownloadResponseHandler *downloadResponseHandler = new DownloadResponseHandler(fileName, this);
     downloadResponseHandler->setParent(reply);
@@ -1136,6 +1180,46 @@ void TwitterApi::listTimeline(const QString &listId, const QString &maxId)
 
 }
 
+void TwitterApi::mergedTimelineSource(const QString &sourceId, const QString &sinceId)
+{
+    qDebug() << "TwitterApi::mergedTimelineSource" << sourceId << sinceId;
+    const bool homeTimeline = (sourceId == MERGED_TIMELINE_HOME_SOURCE);
+    QUrl url = QUrl(homeTimeline ? API_STATUSES_HOME_TIMELINE : API_LISTS_STATUSES);
+    QUrlQuery urlQuery = QUrlQuery();
+    urlQuery.addQueryItem("tweet_mode", "extended");
+    if (homeTimeline) {
+        urlQuery.addQueryItem("exclude_replies", "false");
+    } else {
+        urlQuery.addQueryItem("list_id", sourceId);
+    }
+    if (!sinceId.isEmpty()) {
+        urlQuery.addQueryItem("since_id", sinceId);
+    }
+    urlQuery.addQueryItem("count", "200");
+    urlQuery.addQueryItem("include_ext_alt_text", "true");
+    url.setQuery(urlQuery);
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, O2_MIME_TYPE_XFORM);
+
+    QList<O0RequestParameter> requestParameters = QList<O0RequestParameter>();
+    requestParameters.append(O0RequestParameter(QByteArray("tweet_mode"), QByteArray("extended")));
+    if (homeTimeline) {
+        requestParameters.append(O0RequestParameter(QByteArray("exclude_replies"), QByteArray("false")));
+    } else {
+        requestParameters.append(O0RequestParameter(QByteArray("list_id"), sourceId.toUtf8()));
+    }
+    if (!sinceId.isEmpty()) {
+        requestParameters.append(O0RequestParameter(QByteArray("since_id"), sinceId.toUtf8()));
+    }
+    requestParameters.append(O0RequestParameter(QByteArray("count"), QByteArray("200")));
+    requestParameters.append(O0RequestParameter(QByteArray("include_ext_alt_text"), QByteArray("true")));
+    QNetworkReply *reply = requestor->get(request, requestParameters);
+    reply->setObjectName(sourceId);
+
+    connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(handleMergedTimelineSourceError(QNetworkReply::NetworkError)));
+    connect(reply, SIGNAL(finished()), this, SLOT(handleMergedTimelineSourceFinished()));
+}
+
 void TwitterApi::savedSearches()
 {
     qDebug() << "TwitterApi::savedSearches";
@@ -1185,26 +1269,100 @@ void TwitterApi::destroySavedSearch(const QString &id)
     connect(reply, SIGNAL(finished()), this, SLOT(handleDestroySavedSearchFinished()));
 }
 
-void TwitterApi::getOpenGraph(const QString &address)
+void TwitterApi::getOpenGraph(const QString &address, const int &priority)
 {
-    qDebug() << "TwitterApi::getOpenGraph" << address;
+    qDebug() << "TwitterApi::getOpenGraph" << address << priority;
+
+    QVariantMap openGraphData;
+    OpenGraphCache::LookupResult cacheResult = openGraphCache->lookup(address, openGraphData);
+    if (cacheResult != OpenGraphCache::Miss) {
+        qDebug() << "Open Graph data for " + address + " found in cache";
+        // Delivered asynchronously like a network result, the requester may not listen yet
+        QTimer::singleShot(0, this, [this, address, openGraphData, cacheResult]() {
+            if (cacheResult == OpenGraphCache::Found) {
+                emitOpenGraphSuccessful(address, openGraphData);
+            } else {
+                emit getOpenGraphError(address + " does not contain Open Graph data");
+            }
+        });
+        return;
+    }
+    if (!openGraphCache->addRequester(address)) {
+        qDebug() << "Open Graph data for " + address + " is already being retrieved";
+        linkPreviewFetcher->raisePriority(address, priority);
+        return;
+    }
+
+    linkPreviewFetcher->fetch(address, priority);
+}
+
+void TwitterApi::cancelOpenGraph(const QString &address)
+{
+    qDebug() << "TwitterApi::cancelOpenGraph" << address;
+    if (openGraphCache->removeRequester(address)) {
+        linkPreviewFetcher->cancel(address);
+    }
+}
+
+void TwitterApi::setLinkPreviewByteBudget(const qint64 &byteBudget)
+{
+    qDebug() << "TwitterApi::setLinkPreviewByteBudget" << byteBudget;
+    linkPreviewFetcher->setByteBudget(byteBudget);
+}
+
+void TwitterApi::getArticle(const QString &address)
+{
+    qDebug() << "TwitterApi::getArticle" << address;
+
     QUrl url = QUrl(address);
     QNetworkRequest request(url);
     request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
     request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0 (Wayland; SailfishOS) Piepmatz (Not Firefox/52.0)");
-    request.setRawHeader(QByteArray("Accept"), QByteArray("text/html,application/xhtml+xml"));
-    request.setRawHeader(QByteArray("Accept-Charset"), QByteArray("utf-8"));
-    request.setRawHeader(QByteArray("Connection"), QByteArray("close"));
-    request.setRawHeader(QByteArray("Cache-Control"), QByteArray("max-age=0"));
+
+    QVariantMap article;
+    bool revalidation = articleCache->lookup(address, article);
+    if (revalidation) {
+        qDebug() << "Article " + address + " found in cache";
+        QTimer::singleShot(0, this, [this, article]() {
+            emit getArticleSuccessful(article);
+        });
+        if (!articleCache->needsRevalidation(article)) {
+            return;
+        }
+        // The page is only downloaded and extracted again if it changed in the meantime
+        QByteArray etag = article.value("etag").toByteArray();
+        QByteArray lastModified = article.value("lastModified").toByteArray();
+        if (!etag.isEmpty()) {
+            request.setRawHeader(QByteArray("If-None-Match"), etag);
+        }
+        if (!lastModified.isEmpty()) {
+            request.setRawHeader(QByteArray("If-Modified-Since"), lastModified);
+        }
+    }
+
     QNetworkReply *reply = manager->get(request);
+    reply->setObjectName(address);
+    reply->setProperty("revalidation", revalidation);
 
-    connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(handleGetOpenGraphError(QNetworkReply::NetworkError)));
-    connect(reply, SIGNAL(finished()), this, SLOT(handleGetOpenGraphFinished()));
+    connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(handleGetArticleError(QNetworkReply::NetworkError)));
+    connect(reply, SIGNAL(finished()), this, SLOT(handleGetArticleFinished()));
 }
 
 void TwitterApi::getSingleTweet(const QString &tweetId, const QString &address)
 {
     qDebug() << "TwitterApi::getSingleTweet" << tweetId << address;
+
+    QVariantList conversationTweets;
+    if (conversationGraph->getKnownConversation(tweetId, conversationTweets)) {
+        qDebug() << "Conversation of " + tweetId + " is already known";
+        if (conversationTweets.size() > 1) {
+            QTimer::singleShot(0, this, [this, tweetId, conversationTweets]() {
+                emit tweetConversationReceived(tweetId, conversationTweets);
+            });
+        }
+        return;
+    }
+
     QUrl url = QUrl(address);
     QNetworkRequest request(url);
     request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
@@ -1218,6 +1376,29 @@ void TwitterApi::getSingleTweet(const QString &tweetId, const QString &address)
     connect(reply, SIGNAL(finished()), this, SLOT(handleGetSingleTweetFinished()));
 }
 
+void TwitterApi::prefetchConversation(const QString &tweetId, const int &priority)
+{
+    qDebug() << "TwitterApi::prefetchConversation" << tweetId << priority;
+    conversationPrefetcher->prefetch(tweetId, priority);
+}
+
+void TwitterApi::setDataSaverMode(const bool &dataSaverMode)
+{
+    qDebug() << "TwitterApi::setDataSaverMode" << dataSaverMode;
+    conversationPrefetcher->setDataSaverMode(dataSaverMode);
+}
+
+QStringList TwitterApi::getMuteRules()
+{
+    return muteFilter->getRules();
+}
+
+void TwitterApi::setMuteRules(const QStringList &muteRules)
+{
+    qDebug() << "TwitterApi::setMuteRules" << muteRules.size();
+    muteFilter->setRules(muteRules);
+}
+
 void TwitterApi::getIpInfo()
 {
     qDebug() << "TwitterApi::getIpInfo";
@@ -1298,7 +1479,9 @@ void TwitterApi::handleTweetFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isObject()) {
         QJsonObject responseObject = jsonDocument.object();
-        emit tweetSuccessful(responseObject.toVariantMap());
+        QVariantMap tweet = responseObject.toVariantMap();
+        ingestTweet(tweet);
+        emit tweetSuccessful(tweet);
     } else {
         emit tweetError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1324,7 +1507,9 @@ void TwitterApi::handleHomeTimelineFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit homeTimelineSuccessful(responseArray.toVariantList(), false);
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, true);
+        emit homeTimelineSuccessful(tweets, false);
     } else {
         emit homeTimelineError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1342,7 +1527,9 @@ void TwitterApi::handleHomeTimelineLoadMoreFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit homeTimelineSuccessful(responseArray.toVariantList(), true);
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, true);
+        emit homeTimelineSuccessful(tweets, true);
     } else {
         emit homeTimelineError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1368,7 +1555,9 @@ void TwitterApi::handleMentionsTimelineFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit mentionsTimelineSuccessful(responseArray.toVariantList());
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, true);
+        emit mentionsTimelineSuccessful(tweets);
     } else {
         emit mentionsTimelineError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1394,7 +1583,9 @@ void TwitterApi::handleRetweetTimelineFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit retweetTimelineSuccessful(responseArray.toVariantList());
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, false);
+        emit retweetTimelineSuccessful(tweets);
     } else {
         emit retweetTimelineError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1432,7 +1623,9 @@ void TwitterApi::handleUserTimelineFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit userTimelineSuccessful(responseArray.toVariantList());
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, false);
+        emit userTimelineSuccessful(tweets);
     } else {
         emit userTimelineError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1544,6 +1737,7 @@ void TwitterApi::handleShowStatusFinished()
         qDebug() << "Probably a secret identity response...";
     } else {
         qDebug() << "Standard response...";
+        conversationPrefetcher->updateRateLimit(reply);
     }
     reply->deleteLater();
     if (reply->error() != QNetworkReply::NoError) {
@@ -1553,7 +1747,9 @@ void TwitterApi::handleShowStatusFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isObject()) {
         QJsonObject responseObject = jsonDocument.object();
-        emit showStatusSuccessful(responseObject.toVariantMap());
+        QVariantMap tweet = responseObject.toVariantMap();
+        ingestTweet(tweet);
+        emit showStatusSuccessful(tweet);
     } else {
         emit showStatusError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1680,7 +1876,9 @@ void TwitterApi::handleSearchTweetsFinished()
                 foundStatusIds.append(currentStatusId);
             }
         }
-        emit searchTweetsSuccessful(resultsArray.toVariantList());
+        QVariantList tweets = resultsArray.toVariantList();
+        ingestTweets(tweets, true);
+        emit searchTweetsSuccessful(tweets);
     } else {
         emit searchTweetsError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -1810,7 +2008,9 @@ void TwitterApi::handleFavoritesFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit favoritesSuccessful(responseArray.toVariantList());
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, false);
+        emit favoritesSuccessful(tweets);
     } else {
         emit favoritesError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -2133,7 +2333,9 @@ void TwitterApi::handleListTimelineFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit listTimelineSuccessful(responseArray.toVariantList(), false);
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, true);
+        emit listTimelineSuccessful(tweets, false);
     } else {
         emit listTimelineError("Piepmatz couldn't understand Twitter's response!");
     }
@@ -2151,12 +2353,44 @@ void TwitterApi::handleListTimelineLoadMoreFinished()
     QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
     if (jsonDocument.isArray()) {
         QJsonArray responseArray = jsonDocument.array();
-        emit listTimelineSuccessful(responseArray.toVariantList(), true);
+        QVariantList tweets = responseArray.toVariantList();
+        ingestTweets(tweets, true);
+        emit listTimelineSuccessful(tweets, true);
     } else {
         emit listTimelineError("Piepmatz couldn't understand Twitter's response!");
     }
 }
 
+void TwitterApi::handleMergedTimelineSourceError(QNetworkReply::NetworkError error)
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    qWarning() << "TwitterApi::handleMergedTimelineSourceError:" << (int)error << reply->errorString();
+    QVariantMap parsedErrorResponse = parseErrorResponse(reply->errorString(), reply->readAll());
+    emit mergedTimelineSourceError(reply->objectName(), parsedErrorResponse.value("message").toString());
+}
+
+void TwitterApi::handleMergedTimelineSourceFinished()
+{
+    qDebug() << "TwitterApi::handleMergedTimelineSourceFinished";
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reply->deleteLater();
+    if (reply->error() != QNetworkReply::NoError) {
+        return;
+    }
+
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
+    if (jsonDocument.isArray()) {
+        QJsonArray responseArray = jsonDocument.array();
+        QVariantList tweets = responseArray.toVariantList();
+        // Taken before muting, so that the source moves on even if all its new tweets are muted
+        const QString newestTweetId = tweets.isEmpty() ? QString() : tweets.first().toMap().value("id_str").toString();
+        ingestTweets(tweets, true);
+        emit mergedTimelineSourceSuccessful(reply->objectName(), tweets, newestTweetId);
+    } else {
+        emit mergedTimelineSourceError(reply->objectName(), "Piepmatz couldn't understand Twitter's response!");
+    }
+}
+
 void TwitterApi::handleSavedSearchesError(QNetworkReply::NetworkError error)
 {
     QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
@@ -2235,84 +2469,116 @@ void TwitterApi::handleDestroySavedSearchFinished()
     }
 }
 
-void TwitterApi::handleGetOpenGraphError(QNetworkReply::NetworkError error)
+void TwitterApi::deliverOpenGraph(const QString &address, const QVariantMap &openGraphData)
+{
+    openGraphCache->insert(address, openGraphData);
+    QStringList requesters = openGraphCache->takeRequesters(address);
+    for (const QString &requester : requesters) {
+        emitOpenGraphSuccessful(requester, openGraphData);
+    }
+}
+
+void TwitterApi::deliverOpenGraphError(const QString &address, const QString &errorMessage, const bool &noOpenGraphData)
+{
+    if (noOpenGraphData) {
+        openGraphCache->insertNotFound(address);
+    }
+    QStringList requesters = openGraphCache->takeRequesters(address);
+    for (int i = 0; i < requesters.size(); i++) {
+        emit getOpenGraphError(errorMessage);
+    }
+}
+
+void TwitterApi::ingestTweets(QVariantList &tweets, const MuteFilter *muteFilter, ConversationGraph *conversationGraph)
+{
+    if (muteFilter) {
+        muteFilter->filterTweets(tweets);
+    }
+    TweetTextRenderer::renderTweets(tweets);
+    conversationGraph->addTweets(tweets);
+}
+
+void TwitterApi::ingestTweet(QVariantMap &tweet, ConversationGraph *conversationGraph)
+{
+    TweetTextRenderer::renderTweet(tweet);
+    conversationGraph->addTweet(tweet);
+}
+
+void TwitterApi::ingestTweets(QVariantList &tweets, const bool &applyMutes)
+{
+    ingestTweets(tweets, applyMutes ? muteFilter : nullptr, conversationGraph);
+}
+
+void TwitterApi::ingestTweet(QVariantMap &tweet)
+{
+    ingestTweet(tweet, conversationGraph);
+}
+
+void TwitterApi::emitOpenGraphSuccessful(const QString &address, QVariantMap openGraphData)
+{
+    // Always using request URL to be able to compare results
+    openGraphData.insert("url", address);
+    if (!openGraphData.contains("title")) {
+        openGraphData.insert("title", address);
+    }
+    emit getOpenGraphSuccessful(openGraphData);
+}
+
+void TwitterApi::handleGetArticleError(QNetworkReply::NetworkError error)
 {
     QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
-    qWarning() << "TwitterApi::handleGetOpenGraphFinished:" << (int)error << reply->errorString();
-    QVariantMap parsedErrorResponse = parseErrorResponse(reply->errorString(), reply->readAll());
-    emit getOpenGraphError(parsedErrorResponse.value("message").toString());
+    qWarning() << "TwitterApi::handleGetArticleError:" << (int)error << reply->errorString();
+    // A failed revalidation doesn't matter, the cached article was already delivered
+    if (!reply->property("revalidation").toBool()) {
+        emit getArticleError(reply->errorString());
+    }
 }
 
-void TwitterApi::handleGetOpenGraphFinished()
+void TwitterApi::handleGetArticleFinished()
 {
-    qDebug() << "TwitterApi::handleGetOpenGraphFinished";
+    qDebug() << "TwitterApi::handleGetArticleFinished";
     QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     reply->deleteLater();
     if (reply->error() != QNetworkReply::NoError) {
         return;
     }
 
-    QString requestAddress = reply->request().url().toString();
-
-    QVariant contentTypeHeader = reply->header(QNetworkRequest::ContentTypeHeader);
-    if (!contentTypeHeader.isValid()) {
-        return;
-    }
-    qDebug() << "Open Graph content type header: " << contentTypeHeader.toString();
-    if (contentTypeHeader.toString().indexOf("text/html", 0, Qt::CaseInsensitive) == -1) {
-        qDebug() << requestAddress + " is not HTML, not checking Open Graph data...";
+    QString address = reply->objectName();
+    bool revalidation = reply->property("revalidation").toBool();
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        qDebug() << "Article " + address + " is unchanged";
+        articleCache->touch(address);
         return;
     }
 
-    QString charset = "UTF-8";
-    QRegularExpression charsetRegularExpression("charset\\s*\\=[\\s\\\"\\\']*([^\\s\\\"\\\'\\,>]*)");
-    QRegularExpressionMatchIterator matchIterator = charsetRegularExpression.globalMatch(contentTypeHeader.toString());
-    QStringList availableCharsets;
-    while (matchIterator.hasNext()) {
-        QRegularExpressionMatch nextMatch = matchIterator.next();
-        QString currentCharset = nextMatch.captured(1).toUpper();
-        qDebug() << "Available Open Graph charset: " << currentCharset;
-        availableCharsets.append(currentCharset);
-    }
-    if (availableCharsets.size() > 0 && !availableCharsets.contains("UTF-8")) {
-        // If we haven't received the requested UTF-8, we simply use the last one which we received in the header
-        charset = availableCharsets.last();
+    QString contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+    if (contentType.indexOf("text/html", 0, Qt::CaseInsensitive) == -1) {
+        if (!revalidation) {
+            emit getArticleError(address + " is not HTML, unable to show the article");
+        }
+        return;
     }
-    qDebug() << "Open Graph Charset for " << requestAddress << ": " << charset;
 
-    QByteArray rawDocument = reply->readAll();
-    QTextCodec *codec = QTextCodec::codecForName(charset.toUtf8());
-    QString resultDocument = codec->toUnicode(rawDocument);
-
-    QVariantMap openGraphData;
-    QRegExp urlRegex("\\<meta\\s+property\\=\\\"og\\:url\\\"\\s+content\\=\\\"([^\\\"]+)\\\"");
-    if (urlRegex.indexIn(resultDocument) != -1) {
-        openGraphData.insert("url", urlRegex.cap(1));
-    }
-    QRegExp imageRegex("\\<meta\\s+property\\=\\\"og\\:image\\\"\\s+content\\=\\\"([^\\\"]+)\\\"");
-    if (imageRegex.indexIn(resultDocument) != -1) {
-        openGraphData.insert("image", imageRegex.cap(1));
-    }
-    QRegExp descriptionRegex("\\<meta\\s+property\\=\\\"og\\:description\\\"\\s+content\\=\\\"([^\\\"]+)\\\"");
-    if (descriptionRegex.indexIn(resultDocument) != -1) {
-        openGraphData.insert("description", descriptionRegex.cap(1));
-    }
-    QRegExp titleRegex("\\<meta\\s+property\\=\\\"og\\:title\\\"\\s+content\\=\\\"([^\\\"]+)\\\"");
-    if (titleRegex.indexIn(resultDocument) != -1) {
-        openGraphData.insert("title", titleRegex.cap(1));
-    }
+    ArticleExtractionWorker *extractionWorker = new ArticleExtractionWorker(address, reply->readAll(), contentType, reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"), revalidation, this);
+    connect(extractionWorker, SIGNAL(articleExtracted(QString,QVariantMap,QByteArray,QByteArray,bool)), this, SLOT(handleArticleExtracted(QString,QVariantMap,QByteArray,QByteArray,bool)));
+    connect(extractionWorker, SIGNAL(finished()), extractionWorker, SLOT(deleteLater()));
+    extractionWorker->start();
+}
 
-    if (openGraphData.isEmpty()) {
-        emit getOpenGraphError(requestAddress + " does not contain Open Graph data");
-    } else {
-        // Always using request URL to be able to compare results
-        openGraphData.insert("url", requestAddress);
-        if (!openGraphData.contains("title")) {
-            openGraphData.insert("title", openGraphData.value("url"));
+void TwitterApi::handleArticleExtracted(const QString &address, const QVariantMap &article, const QByteArray &etag, const QByteArray &lastModified, const bool &revalidation)
+{
+    qDebug() << "TwitterApi::handleArticleExtracted" << address;
+    if (article.value("content").toString().isEmpty()) {
+        // The cached article was already delivered and stays in the cache
+        if (!revalidation) {
+            emit getArticleError("Unable to extract an article from " + address);
         }
-        qDebug() << "Open Graph data found for " + requestAddress;
-        emit getOpenGraphSuccessful(openGraphData);
+        return;
     }
+    articleCache->insert(address, article, etag, lastModified);
+    QVariantMap result = article;
+    result.insert("url", address);
+    emit getArticleSuccessful(result);
 }
 
 void TwitterApi::handleGetSingleTweetError(QNetworkReply::NetworkError error)
@@ -2349,40 +2615,28 @@ void TwitterApi::handleGetSingleTweetFinished()
         currentTweetId = tweetIdRegex.cap(1);
     }
 
-    QString resultDocument(reply->readAll());
-    QGumboDocument parsedResult = QGumboDocument::parse(resultDocument);
-    QGumboNode root = parsedResult.rootNode();
-
-    // === DEBUG ===
-    // ContentExtractor contentExtractor(this, &root);
-    // contentExtractor.parse();
-    // === DEBUG ===
-
-
-    QGumboNodes tweetNodes = root.getElementsByClassName("tweet");
-    QVariantList relatedTweets;
-    for (QGumboNode &tweetNode : tweetNodes) {
-        QStringList tweetClassList = tweetNode.classList();
-        if (!tweetClassList.contains("promoted-tweet")) {
-            QString otherTweetId = tweetNode.getAttribute("data-tweet-id");
-            if (!otherTweetId.isEmpty()) {
-                qDebug() << "Found Tweet ID: " << otherTweetId;
-                relatedTweets.append(otherTweetId);
-            }
-        }
-    }
+    TweetConversationWorker *conversationWorker = new TweetConversationWorker(currentTweetId, reply->readAll(), contentTypeHeader.toString(), this);
+    connect(conversationWorker, SIGNAL(conversationParsed(QString,QVariantList)), this, SLOT(handleTweetConversationParsed(QString,QVariantList)));
+    connect(conversationWorker, SIGNAL(finished()), conversationWorker, SLOT(deleteLater()));
+    conversationWorker->start();
+}
 
-    if (!relatedTweets.isEmpty()) {
+void TwitterApi::handleTweetConversationParsed(const QString &tweetId, const QVariantList &relatedTweets)
+{
+    qDebug() << "TwitterApi::handleTweetConversationParsed" << tweetId;
+    if (relatedTweets.size() <= 1) {
+        conversationGraph->setConversationChecked(tweetId);
+    } else {
         qDebug() << "Found other tweets, let's build a conversation!";
-        TweetConversationHandler *conversationHandler = new TweetConversationHandler(this, currentTweetId, relatedTweets, this);
+        TweetConversationHandler *conversationHandler = new TweetConversationHandler(this, conversationGraph, tweetId, relatedTweets, this);
         connect(conversationHandler, SIGNAL(tweetConversationCompleted(QString, QVariantList)), this, SLOT(handleTweetConversationReceived(QString, QVariantList)));
         conversationHandler->buildConversation();
     }
-
 }
 
 void TwitterApi::handleTweetConversationReceived(QString tweetId, QVariantList receivedTweets)
 {
+    conversationGraph->setConversationChecked(tweetId);
     emit tweetConversationReceived(tweetId, receivedTweets);
 }
 
@@ -30,9 +30,18 @@
 #include <QJsonArray>
 #include <QVariantMap>
 #include <QVariantList>
+#include <QStringList>
+#include <QSettings>
 #include "o1requestor.h"
 #include "o0requestparameter.h"
 #include "o0globals.h"
+#include "opengraphcache.h"
+
+class LinkPreviewFetcher;
+class ArticleCache;
+class ConversationGraph;
+class ConversationPrefetcher;
+class MuteFilter;
 //#include "wagnis/wagnis.h"
 
 const char API_ACCOUNT_VERIFY_CREDENTIALS[] = "https://api.twitter.com/1.1/account/verify_credentials.json";
@@ -78,12 +87,23 @@ const char API_SAVED_SEARCHES_DESTROY[] = "https://api.twitter.com/1.1/saved_sea
 
 const char HEADER_NO_RECURSION[] = "X-Piepmatz-No-Recursion";
 
+// Source ID of the home timeline in merged timelines, all other sources are list IDs
+const char MERGED_TIMELINE_HOME_SOURCE[] = "home";
+
 class TwitterApi : public QObject {
 
     Q_OBJECT
 public:
     //TwitterApi(O1Requestor* requestor, QNetworkAccessManager *manager, Wagnis *wagnis, QObject* parent = 0);
-    TwitterApi(O1Requestor* requestor, QNetworkAccessManager *manager, O1Requestor* secretIdentityRequestor = 0, QObject* parent = 0);
+    TwitterApi(O1Requestor* requestor, QSettings *settings, QNetworkAccessManager *manager, O1Requestor* secretIdentityRequestor = 0, QObject* parent = 0);
+
+    // Requests go out for the account of the given requestor from now on
+    void setRequestor(O1Requestor* requestor);
+    void setSecretIdentityRequestor(O1Requestor* secretIdentityRequestor);
+    // Caches which depend on the account are kept in its data directory
+    void setDataDirectory(const QString &dataDirectory);
+    // Settings which depend on the account, e.g. the mute rules, are read from the given ones
+    void setSettings(QSettings *settings);
 
     Q_INVOKABLE void verifyCredentials();
     Q_INVOKABLE void accountSettings();
@@ -127,18 +147,35 @@ public:
     Q_INVOKABLE void listsMemberships();
     Q_INVOKABLE void listMembers(const QString &listId);
     Q_INVOKABLE void listTimeline(const QString &listId, const QString &maxId = QString());
+    Q_INVOKABLE void mergedTimelineSource(const QString &sourceId, const QString &sinceId = QString());
     Q_INVOKABLE void savedSearches();
     Q_INVOKABLE void saveSearch(const QString &query);
     Q_INVOKABLE void destroySavedSearch(const QString &id);
 
-    Q_INVOKABLE void getOpenGraph(const QString &address);
+    Q_INVOKABLE void getOpenGraph(const QString &address, const int &priority = 0);
+    Q_INVOKABLE void cancelOpenGraph(const QString &address);
+    Q_INVOKABLE void setLinkPreviewByteBudget(const qint64 &byteBudget);
+    Q_INVOKABLE void getArticle(const QString &address);
     Q_INVOKABLE void getSingleTweet(const QString &tweetId, const QString &address);
+    Q_INVOKABLE void prefetchConversation(const QString &tweetId, const int &priority = 0);
+    Q_INVOKABLE void setDataSaverMode(const bool &dataSaverMode);
+    Q_INVOKABLE QStringList getMuteRules();
+    Q_INVOKABLE void setMuteRules(const QStringList &muteRules);
     Q_INVOKABLE void getIpInfo();
     Q_INVOKABLE void controlScreenSaver(const bool &enabled);
     Q_INVOKABLE void handleAdditionalInformation(const QString &additionalInformation);
 
     Q_INVOKABLE QVariantMap parseErrorResponse(const QString &errorText, const QByteArray &responseText);
 
+    // Called by OpenGraphResponseHandler, notifies everyone who asked for the address in the meantime
+    void deliverOpenGraph(const QString &address, const QVariantMap &openGraphData);
+    void deliverOpenGraphError(const QString &address, const QString &errorMessage, const bool &noOpenGraphData);
+
+    // Every received tweet passes through here: muted tweets are removed if a filter is given,
+    // the text is rendered and the tweet is added to the conversation graph
+    static void ingestTweets(QVariantList &tweets, const MuteFilter *muteFilter, ConversationGraph *conversationGraph);
+    static void ingestTweet(QVariantMap &tweet, ConversationGraph *conversationGraph);
+
 signals:
     void verifyCredentialsSuccessful(const QVariantMap &result);
     void verifyCredentialsError(const QString &errorMessage);
@@ -216,6 +253,8 @@ signals:
     void listMembersError(const QString &errorMessage);
     void listTimelineSuccessful(const QVariantList &result, const bool incrementalUpdate);
     void listTimelineError(const QString &errorMessage);
+    void mergedTimelineSourceSuccessful(const QString &sourceId, const QVariantList &result, const QString &newestTweetId);
+    void mergedTimelineSourceError(const QString &sourceId, const QString &errorMessage);
     void savedSearchesSuccessful(const QVariantList &result);
     void savedSearchesError(const QString &errorMessage);
     void saveSearchSuccessful(const QVariantMap &result);
@@ -225,16 +264,30 @@ signals:
 
     void getOpenGraphSuccessful(const QVariantMap &result);
     void getOpenGraphError(const QString &errorMessage);
+    void getArticleSuccessful(const QVariantMap &result);
+    void getArticleError(const QString &errorMessage);
     void tweetConversationReceived(const QString &tweetId, const QVariantList &receivedTweets);
     void getIpInfoSuccessful(const QVariantMap &result);
     void getIpInfoError(const QString &errorMessage);
+    void accountSwitched();
 
 private:
     O1Requestor *requestor;
     O1Requestor *secretIdentityRequestor;
     QNetworkAccessManager *manager;
+    OpenGraphCache *openGraphCache;
+    LinkPreviewFetcher *linkPreviewFetcher;
+    ArticleCache *articleCache;
+    ConversationGraph *conversationGraph;
+    ConversationPrefetcher *conversationPrefetcher;
+    MuteFilter *muteFilter;
     //Wagnis *wagnis;
 
+    void emitOpenGraphSuccessful(const QString &address, QVariantMap openGraphData);
+    // Same with the mute rules and the conversation graph of the active account
+    void ingestTweets(QVariantList &tweets, const bool &applyMutes);
+    void ingestTweet(QVariantMap &tweet);
+
 private slots:
     void handleVerifyCredentialsSuccessful();
     void handleVerifyCredentialsError(QNetworkReply::NetworkError error);
@@ -306,6 +359,8 @@ private slots:
     void handleListTimelineError(QNetworkReply::NetworkError error);
     void handleListTimelineFinished();
     void handleListTimelineLoadMoreFinished();
+    void handleMergedTimelineSourceError(QNetworkReply::NetworkError error);
+    void handleMergedTimelineSourceFinished();
     void handleSavedSearchesError(QNetworkReply::NetworkError error);
     void handleSavedSearchesFinished();
     void handleSaveSearchError(QNetworkReply::NetworkError error);
@@ -313,10 +368,12 @@ private slots:
     void handleDestroySavedSearchError(QNetworkReply::NetworkError error);
     void handleDestroySavedSearchFinished();
 
-    void handleGetOpenGraphError(QNetworkReply::NetworkError error);
-    void handleGetOpenGraphFinished();
+    void handleGetArticleError(QNetworkReply::NetworkError error);
+    void handleGetArticleFinished();
+    void handleArticleExtracted(const QString &address, const QVariantMap &article, const QByteArray &etag, const QByteArray &lastModified, const bool &revalidation);
     void handleGetSingleTweetError(QNetworkReply::NetworkError error);
     void handleGetSingleTweetFinished();
+    void handleTweetConversationParsed(const QString &tweetId, const QVariantList &relatedTweets);
     void handleTweetConversationReceived(QString tweetId, QVariantList receivedTweets);
     void handleGetIpInfoError(QNetworkReply::NetworkError error);
     void handleGetIpInfoFinished();
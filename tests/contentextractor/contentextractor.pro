@@ -0,0 +1,15 @@
+include(../tests.pri)
+include(../../src/QGumboParser/QGumboParser.pri)
+
+TARGET = tst_contentextractor
+
+SOURCES += \
+    tst_contentextractor.cpp \
+    $$APP_SOURCES/contentextractor.cpp \
+    $$APP_SOURCES/htmlcharsetdecoder.cpp \
+    $$APP_SOURCES/keywordmatcher.cpp
+
+HEADERS += \
+    $$APP_SOURCES/contentextractor.h \
+    $$APP_SOURCES/htmlcharsetdecoder.h \
+    $$APP_SOURCES/keywordmatcher.h
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "contentextractor.h"
+#include "htmlcharsetdecoder.h"
+
+#include "QGumboParser/qgumbodocument.h"
+#include "QGumboParser/qgumbonode.h"
+
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QtTest>
+
+class TestContentExtractor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void extract_data();
+    void extract();
+
+private:
+    QVariantMap extractArticle(const QByteArray &htmlDocument);
+};
+
+void TestContentExtractor::initTestCase()
+{
+    // The extractor logs every candidate, which would dominate the measurement
+    QLoggingCategory::setFilterRules("*.debug=false");
+}
+
+// Same steps as ArticleExtractionWorker::extractArticle()
+QVariantMap TestContentExtractor::extractArticle(const QByteArray &htmlDocument)
+{
+    HtmlCharsetDecoder charsetDecoder("text/html; charset=utf-8");
+    QByteArray utf8Document = charsetDecoder.decode(htmlDocument);
+    utf8Document.append(charsetDecoder.finish());
+    QGumboDocument parsedResult = QGumboDocument::parse(utf8Document);
+    parsedResult.enableInnerTextCache();
+    QGumboNode root = parsedResult.rootNode();
+
+    ContentExtractor contentExtractor(nullptr, &root);
+    return contentExtractor.parse();
+}
+
+void TestContentExtractor::extract_data()
+{
+    QTest::addColumn<QByteArray>("htmlDocument");
+
+    QDir fixturesDirectory(FIXTURES_DIRECTORY);
+    const QStringList pages = fixturesDirectory.entryList(QStringList("*.html"), QDir::Files, QDir::Name);
+    QVERIFY(!pages.isEmpty());
+    for (const QString &page : pages) {
+        QFile pageFile(fixturesDirectory.filePath(page));
+        QVERIFY(pageFile.open(QIODevice::ReadOnly));
+        QTest::newRow(qPrintable(page)) << pageFile.readAll();
+    }
+}
+
+void TestContentExtractor::extract()
+{
+    QFETCH(QByteArray, htmlDocument);
+
+    QVariantMap article = extractArticle(htmlDocument);
+    QVERIFY(!article.value("title").toString().isEmpty());
+    QVERIFY(!article.value("content").toString().isEmpty());
+
+    QBENCHMARK {
+        extractArticle(htmlDocument);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestContentExtractor)
+
+#include "tst_contentextractor.moc"
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_keywordmatcher
+
+SOURCES += \
+    tst_keywordmatcher.cpp \
+    $$APP_SOURCES/keywordmatcher.cpp
+
+HEADERS += \
+    $$APP_SOURCES/keywordmatcher.h
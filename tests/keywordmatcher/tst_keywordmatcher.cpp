@@ -0,0 +1,200 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "keywordmatcher.h"
+
+#include <QRegularExpression>
+#include <QtTest>
+
+namespace {
+
+const uint POSITIVE = 0x1;
+const uint NEGATIVE = 0x2;
+const uint UNLIKELY_CANDIDATE = 0x4;
+const uint MAYBE_A_CANDIDATE = 0x8;
+
+// Copies of the keyword lists in contentextractor.cpp
+const char * const UNLIKELY_CANDIDATE_KEYWORDS[] = { "-ad-", "ai2html", "banner", "breadcrumbs", "combx", "comment", "community", "cover-wrap", "disqus", "extra", "foot", "gdpr", "header", "legends", "menu", "related", "remark", "replies", "rss", "shoutbox", "sidebar", "skyscraper", "social", "sponsor", "supplemental", "ad-break", "agegate", "pagination", "pager", "popup", "yom-remote" };
+const char * const MAYBE_A_CANDIDATE_KEYWORDS[] = { "and", "article", "body", "column", "main", "shadow" };
+const char * const POSITIVE_KEYWORDS[] = { "article", "body", "content", "entry", "hentry", "h-entry", "main", "page", "pagination", "post", "text", "blog", "story" };
+const char * const NEGATIVE_KEYWORDS[] = { "hidden", " hid ", "banner", "combx", "comment", "com-", "contact", "foot", "footer", "footnote", "gdpr", "masthead", "media", "meta", "outbrain", "promo", "related", "scroll", "share", "shoutbox", "sidebar", "skyscraper", "sponsor", "shopping", "tags", "tool", "widget" };
+
+// The expressions the extractor used before, without the slashes of the JavaScript literals which made them never match
+const QRegularExpression REGEXP_UNLIKELY_CANDIDATES("-ad-|ai2html|banner|breadcrumbs|combx|comment|community|cover-wrap|disqus|extra|foot|gdpr|header|legends|menu|related|remark|replies|rss|shoutbox|sidebar|skyscraper|social|sponsor|supplemental|ad-break|agegate|pagination|pager|popup|yom-remote", QRegularExpression::CaseInsensitiveOption);
+const QRegularExpression REGEXP_OK_MAYBE_ITS_A_CANDIDATE("and|article|body|column|main|shadow", QRegularExpression::CaseInsensitiveOption);
+const QRegularExpression REGEXP_POSITIVE("article|body|content|entry|hentry|h-entry|main|page|pagination|post|text|blog|story", QRegularExpression::CaseInsensitiveOption);
+const QRegularExpression REGEXP_NEGATIVE("hidden|^hid$| hid$| hid |^hid |banner|combx|comment|com-|contact|foot|footer|footnote|gdpr|masthead|media|meta|outbrain|promo|related|scroll|share|shoutbox|sidebar|skyscraper|sponsor|shopping|tags|tool|widget", QRegularExpression::CaseInsensitiveOption);
+
+// Class names and IDs as they are found on news sites and blogs
+const char * const IDENTIFIERS[] = { "site-header", "main-nav", "menu-item", "cookie-banner", "container", "row", "col-main", "article-body story", "post entry-content", "headline", "byline", "author", "ad-slot advertisement", "share-buttons social", "comments", "comment", "comment-meta", "sidebar col-side", "widget", "widget newsletter", "site-footer", "footer-links", "js-hid hid", "Hidden", "PageContent", "wp-block-image size-large", "related-stories", "article__body", "c-entry-content", "l-col__main" };
+
+template<size_t N>
+void addKeywords(KeywordMatcher &keywordMatcher, const char * const (&keywords)[N], const uint &category)
+{
+    for (const char *keyword : keywords) {
+        keywordMatcher.addKeyword(keyword, category);
+    }
+}
+
+uint matchExpressions(const QString &identifier)
+{
+    uint categories = 0;
+    if (REGEXP_POSITIVE.match(identifier).hasMatch()) {
+        categories |= POSITIVE;
+    }
+    if (REGEXP_NEGATIVE.match(identifier).hasMatch()) {
+        categories |= NEGATIVE;
+    }
+    if (REGEXP_UNLIKELY_CANDIDATES.match(identifier).hasMatch()) {
+        categories |= UNLIKELY_CANDIDATE;
+    }
+    if (REGEXP_OK_MAYBE_ITS_A_CANDIDATE.match(identifier).hasMatch()) {
+        categories |= MAYBE_A_CANDIDATE;
+    }
+    return categories;
+}
+
+}
+
+class TestKeywordMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void match_data();
+    void match();
+    void matchWholeWords_data();
+    void matchWholeWords();
+    void matchSameAsExpressions();
+    void benchmarkKeywordMatcher();
+    void benchmarkExpressions();
+
+private:
+    KeywordMatcher extractorMatcher;
+};
+
+void TestKeywordMatcher::initTestCase()
+{
+    addKeywords(extractorMatcher, UNLIKELY_CANDIDATE_KEYWORDS, UNLIKELY_CANDIDATE);
+    addKeywords(extractorMatcher, MAYBE_A_CANDIDATE_KEYWORDS, MAYBE_A_CANDIDATE);
+    addKeywords(extractorMatcher, POSITIVE_KEYWORDS, POSITIVE);
+    addKeywords(extractorMatcher, NEGATIVE_KEYWORDS, NEGATIVE);
+    extractorMatcher.compile();
+}
+
+void TestKeywordMatcher::match_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<uint>("categories");
+
+    QTest::newRow("empty") << QByteArray() << 0u;
+    QTest::newRow("no keyword") << QByteArray("headline") << 0u;
+    QTest::newRow("one category") << QByteArray("story") << POSITIVE;
+    QTest::newRow("several categories") << QByteArray("article") << (POSITIVE | MAYBE_A_CANDIDATE);
+    QTest::newRow("several keywords") << QByteArray("post sidebar") << (POSITIVE | NEGATIVE | UNLIKELY_CANDIDATE);
+    QTest::newRow("within a word") << QByteArray("PageContent") << POSITIVE;
+    QTest::newRow("upper case") << QByteArray("SIDEBAR") << (NEGATIVE | UNLIKELY_CANDIDATE);
+    QTest::newRow("overlapping keywords") << QByteArray("footnote") << (NEGATIVE | UNLIKELY_CANDIDATE);
+    QTest::newRow("keyword at the end") << QByteArray("x-widget") << NEGATIVE;
+    QTest::newRow("non-ASCII") << QByteArray("r\xc3\xa9lated-m\xc3\xa9" "dia") << 0u;
+}
+
+void TestKeywordMatcher::match()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(uint, categories);
+
+    QCOMPARE(extractorMatcher.match(text.constData(), text.length()), categories);
+    QCOMPARE(extractorMatcher.match(QLatin1String(text)), categories);
+}
+
+void TestKeywordMatcher::matchWholeWords_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<bool>("matched");
+
+    // Normalized text as produced by MuteFilter: lower case, words separated by single spaces
+    QTest::newRow("only the word") << QByteArray("spoiler") << true;
+    QTest::newRow("first word") << QByteArray("spoiler ahead") << true;
+    QTest::newRow("last word") << QByteArray("no spoiler") << true;
+    QTest::newRow("middle word") << QByteArray("big spoiler ahead") << true;
+    QTest::newRow("hashtag") << QByteArray("watch this #spoiler") << true;
+    QTest::newRow("upper case") << QByteArray("SPOILER") << true;
+    QTest::newRow("longer word") << QByteArray("spoilers ahead") << false;
+    QTest::newRow("part of a word") << QByteArray("nospoiler") << false;
+    QTest::newRow("mention") << QByteArray("@spoiler") << false;
+    QTest::newRow("phrase") << QByteArray("the season finale was great") << true;
+    QTest::newRow("part of a phrase") << QByteArray("the season was great") << false;
+}
+
+void TestKeywordMatcher::matchWholeWords()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(bool, matched);
+
+    // Keywords as added by MuteFilter::compileRules() for the rules "spoiler" and "Season Finale"
+    KeywordMatcher muteMatcher;
+    muteMatcher.addKeyword(" spoiler ", 0x1);
+    muteMatcher.addKeyword(" #spoiler ", 0x1);
+    muteMatcher.addKeyword(" season finale ", 0x1);
+    muteMatcher.addKeyword(" #season finale ", 0x1);
+    muteMatcher.compile();
+
+    QCOMPARE(muteMatcher.match(text.constData(), text.length()) == 0x1, matched);
+
+    // " hid " of the extractor only matches the whole word as well
+    QCOMPARE(extractorMatcher.match(QLatin1String("hid")) & NEGATIVE, NEGATIVE);
+    QCOMPARE(extractorMatcher.match(QLatin1String("js-x hid")) & NEGATIVE, NEGATIVE);
+    QCOMPARE(extractorMatcher.match(QLatin1String("hide")) & NEGATIVE, 0u);
+    QCOMPARE(extractorMatcher.match(QLatin1String("chid")) & NEGATIVE, 0u);
+}
+
+void TestKeywordMatcher::matchSameAsExpressions()
+{
+    for (const char *identifier : IDENTIFIERS) {
+        QCOMPARE(extractorMatcher.match(QLatin1String(identifier)), matchExpressions(QLatin1String(identifier)));
+    }
+}
+
+void TestKeywordMatcher::benchmarkKeywordMatcher()
+{
+    uint categories = 0;
+    QBENCHMARK {
+        for (const char *identifier : IDENTIFIERS) {
+            categories |= extractorMatcher.match(QLatin1String(identifier));
+        }
+    }
+    QVERIFY(categories != 0);
+}
+
+void TestKeywordMatcher::benchmarkExpressions()
+{
+    uint categories = 0;
+    QBENCHMARK {
+        for (const char *identifier : IDENTIFIERS) {
+            // The extractor had to convert every identifier to a QString first
+            categories |= matchExpressions(QString::fromLatin1(identifier));
+        }
+    }
+    QVERIFY(categories != 0);
+}
+
+QTEST_GUILESS_MAIN(TestKeywordMatcher)
+
+#include "tst_keywordmatcher.moc"
@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+TARGET = tst_mutefilter
+
+SOURCES += \
+    tst_mutefilter.cpp \
+    $$APP_SOURCES/keywordmatcher.cpp \
+    $$APP_SOURCES/mutefilter.cpp
+
+HEADERS += \
+    $$APP_SOURCES/keywordmatcher.h \
+    $$APP_SOURCES/mutefilter.h
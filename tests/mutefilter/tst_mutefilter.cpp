@@ -0,0 +1,105 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "mutefilter.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/*
+ * Filters a page of 200 tweets with 500 mute rules, which should take well below a millisecond
+ * on a phone. Most rules are words and phrases, a few are users and regular expressions.
+ */
+class TestMuteFilter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void filterTweets();
+    void benchmarkFilterTweets();
+
+private:
+    QTemporaryDir settingsDirectory;
+    QVariantList tweets;
+    QStringList rules;
+};
+
+void TestMuteFilter::initTestCase()
+{
+    QLoggingCategory::setFilterRules("*.debug=false");
+    QVERIFY(settingsDirectory.isValid());
+
+    QFile timelineFile(FIXTURES_DIRECTORY "/home-timeline.json");
+    QVERIFY(timelineFile.open(QIODevice::ReadOnly));
+    tweets = QJsonDocument::fromJson(timelineFile.readAll()).toVariant().toList();
+    QCOMPARE(tweets.size(), 200);
+
+    // Only a few of them occur on the page
+    rules << "coffee" << "#FOSS" << "@jolla" << "/\\bwalk(s|ing)?\\b/" << "thanks to everyone";
+    for (int i = 0; rules.size() < 480; i++) {
+        rules << QString("muted%1").arg(i) << QString("some phrase %1").arg(i) << QString("#tag%1").arg(i);
+    }
+    for (int i = 0; rules.size() < 496; i++) {
+        rules << QString("@muteduser%1").arg(i);
+    }
+    for (int i = 0; rules.size() < 500; i++) {
+        rules << QString("/spam[0-9]+x%1/").arg(i);
+    }
+    QCOMPARE(rules.size(), 500);
+}
+
+void TestMuteFilter::filterTweets()
+{
+    MuteFilter muteFilter(settingsDirectory.path() + "/settings.conf");
+    muteFilter.setRules(rules);
+    QCOMPARE(muteFilter.getRules().size(), 500);
+
+    QVariantList filteredTweets = tweets;
+    const int removedTweets = muteFilter.filterTweets(filteredTweets);
+    QVERIFY(removedTweets > 0);
+    QCOMPARE(filteredTweets.size() + removedTweets, tweets.size());
+    for (const QVariant &tweet : filteredTweets) {
+        QVERIFY(!muteFilter.isMuted(tweet.toMap()));
+    }
+
+    // Only whole words are muted
+    QVariantMap tweet;
+    tweet.insert("full_text", "Coffeehouse opening, FOSS meetup tonight");
+    QVERIFY(!muteFilter.isMuted(tweet));
+    tweet.insert("full_text", "Coffee first, then #foss!");
+    QVERIFY(muteFilter.isMuted(tweet));
+}
+
+void TestMuteFilter::benchmarkFilterTweets()
+{
+    MuteFilter muteFilter(settingsDirectory.path() + "/settings.conf");
+    muteFilter.setRules(rules);
+
+    QBENCHMARK {
+        QVariantList filteredTweets = tweets;
+        muteFilter.filterTweets(filteredTweets);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestMuteFilter)
+
+#include "tst_mutefilter.moc"
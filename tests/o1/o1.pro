@@ -0,0 +1,7 @@
+include(../tests.pri)
+include(../../src/o2/o2.pri)
+
+TARGET = tst_o1
+
+SOURCES += \
+    tst_o1.cpp
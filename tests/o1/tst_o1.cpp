@@ -0,0 +1,178 @@
+#include "o1.h"
+#include "o1requestor.h"
+#include "o0globals.h"
+#include "o0settingsstore.h"
+
+#include <QNetworkAccessManager>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/// O0SettingsStore as it was before the decrypted values were cached, every read decrypts again.
+class UncachedSettingsStore: public O0SettingsStore {
+public:
+    UncachedSettingsStore(QSettings *settings, const QString &encryptionKey): O0SettingsStore(settings, encryptionKey) {
+    }
+
+    QString value(const QString &key, const QString &defaultValue = QString()) Q_DECL_OVERRIDE {
+        QString fullKey = groupKey_.isEmpty() ? key : (groupKey_ + '/' + key);
+        if (!settings_->contains(fullKey)) {
+            return defaultValue;
+        }
+        return crypt_.decryptToString(settings_->value(fullKey).toString());
+    }
+};
+
+class TestAuthenticator: public O1 {
+public:
+    using O0BaseAuth::setToken;
+    using O0BaseAuth::setTokenSecret;
+    using O1::signRequest;
+    using O1::requestBase;
+};
+
+class TestRequestor: public O1Requestor {
+public:
+    TestRequestor(QNetworkAccessManager *manager, O1 *authenticator): O1Requestor(manager, authenticator) {
+    }
+
+    using O1Requestor::setup;
+};
+
+class TestO1: public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkSetupWithCachedStore();
+    void benchmarkSetupWithUncachedStore();
+    void signRequestSameAsSign();
+    void benchmarkSignRequest();
+    void benchmarkSign();
+
+private:
+    /// One request to be signed, with everything a signed request of the app contains.
+    struct SignedRequest {
+        QList<O0RequestParameter> oauthParameters;
+        QList<O0RequestParameter> otherParameters;
+        QUrl url;
+        QNetworkAccessManager::Operation operation;
+    };
+
+    QTemporaryDir settingsDirectory;
+    QNetworkAccessManager manager;
+    QNetworkRequest request;
+    QList<O0RequestParameter> signingParameters;
+    QList<SignedRequest> signedRequests;
+
+    void initializeAuthenticator(TestAuthenticator &authenticator, O0SettingsStore *store);
+};
+
+void TestO1::initTestCase() {
+    QVERIFY(settingsDirectory.isValid());
+    QUrl url("https://api.twitter.com/1.1/statuses/home_timeline.json");
+    QUrlQuery urlQuery;
+    urlQuery.addQueryItem("tweet_mode", "extended");
+    urlQuery.addQueryItem("count", "200");
+    url.setQuery(urlQuery);
+    request = QNetworkRequest(url);
+    signingParameters.append(O0RequestParameter("tweet_mode", "extended"));
+    signingParameters.append(O0RequestParameter("count", "200"));
+
+    // 10,000 requests with fresh nonces and timestamps, some with another token or parameters which need to be encoded
+    const QList<QUrl> urls = QList<QUrl>() << QUrl("https://api.twitter.com/1.1/statuses/home_timeline.json")
+                                           << QUrl("https://api.twitter.com/1.1/statuses/update.json")
+                                           << QUrl("https://api.twitter.com/1.1/search/tweets.json")
+                                           << QUrl("https://upload.twitter.com/1.1/media/upload.json");
+    for (int i = 0; i < 10000; i++) {
+        SignedRequest signedRequest;
+        signedRequest.url = urls.at(i % urls.size());
+        signedRequest.operation = (i % 3 == 0) ? QNetworkAccessManager::PostOperation : QNetworkAccessManager::GetOperation;
+        signedRequest.oauthParameters.append(O0RequestParameter(O2_OAUTH_CONSUMER_KEY, "consumer-key"));
+        signedRequest.oauthParameters.append(O0RequestParameter(O2_OAUTH_VERSION, "1.0"));
+        signedRequest.oauthParameters.append(O0RequestParameter(O2_OAUTH_TOKEN, (i % 7 == 0) ? "67890-other-token" : "12345-access-token"));
+        signedRequest.oauthParameters.append(O0RequestParameter(O2_OAUTH_SIGNATURE_METHOD, O2_SIGNATURE_TYPE_HMAC_SHA1));
+        signedRequest.oauthParameters.append(O0RequestParameter(O2_OAUTH_NONCE, O1::nonce()));
+        signedRequest.oauthParameters.append(O0RequestParameter(O2_OAUTH_TIMESTAMP, QByteArray::number(1552384800 + i)));
+        signedRequest.otherParameters.append(O0RequestParameter("tweet_mode", "extended"));
+        if (i % 2 == 0) {
+            signedRequest.otherParameters.append(O0RequestParameter("max_id", QByteArray::number(1105000000000000000LL - i)));
+        }
+        if (i % 5 == 0) {
+            signedRequest.otherParameters.append(O0RequestParameter("status", QString("Caf\u00e9 & \"quotes\" 100% (really!) #%1 \U0001F600").arg(i).toUtf8()));
+        }
+        signedRequests.append(signedRequest);
+    }
+}
+
+void TestO1::initializeAuthenticator(TestAuthenticator &authenticator, O0SettingsStore *store) {
+    authenticator.setStore(store);
+    authenticator.setClientId("consumer-key");
+    authenticator.setClientSecret("consumer-secret");
+    authenticator.setToken("12345-access-token");
+    authenticator.setTokenSecret("access-token-secret");
+}
+
+void TestO1::benchmarkSetupWithCachedStore() {
+    TestAuthenticator authenticator;
+    initializeAuthenticator(authenticator, new O0SettingsStore(new QSettings(settingsDirectory.path() + "/cached.conf", QSettings::IniFormat), "encryption-key"));
+    TestRequestor requestor(&manager, &authenticator);
+
+    QBENCHMARK {
+        QNetworkRequest signedRequest = requestor.setup(request, signingParameters, QNetworkAccessManager::GetOperation);
+        QVERIFY(signedRequest.rawHeader(O2_HTTP_AUTHORIZATION_HEADER).contains("12345-access-token"));
+    }
+}
+
+void TestO1::benchmarkSetupWithUncachedStore() {
+    TestAuthenticator authenticator;
+    initializeAuthenticator(authenticator, new UncachedSettingsStore(new QSettings(settingsDirectory.path() + "/uncached.conf", QSettings::IniFormat), "encryption-key"));
+    TestRequestor requestor(&manager, &authenticator);
+
+    QBENCHMARK {
+        QNetworkRequest signedRequest = requestor.setup(request, signingParameters, QNetworkAccessManager::GetOperation);
+        QVERIFY(signedRequest.rawHeader(O2_HTTP_AUTHORIZATION_HEADER).contains("12345-access-token"));
+    }
+}
+
+void TestO1::signRequestSameAsSign() {
+    TestAuthenticator authenticator;
+    initializeAuthenticator(authenticator, new O0SettingsStore(new QSettings(settingsDirectory.path() + "/signing.conf", QSettings::IniFormat), "encryption-key"));
+
+    for (int i = 0; i < signedRequests.size(); i++) {
+        // The signing key has to follow a changed token secret
+        if (i == signedRequests.size() / 2) {
+            authenticator.setTokenSecret("other secret & more");
+        }
+        const SignedRequest &signedRequest = signedRequests.at(i);
+        QCOMPARE(authenticator.requestBase(signedRequest.oauthParameters, signedRequest.otherParameters, signedRequest.url, signedRequest.operation),
+                 O1::getRequestBase(signedRequest.oauthParameters, signedRequest.otherParameters, signedRequest.url, signedRequest.operation));
+        QCOMPARE(authenticator.signRequest(signedRequest.oauthParameters, signedRequest.otherParameters, signedRequest.url, signedRequest.operation),
+                 O1::sign(signedRequest.oauthParameters, signedRequest.otherParameters, signedRequest.url, signedRequest.operation, authenticator.clientSecret(), authenticator.tokenSecret()));
+    }
+}
+
+void TestO1::benchmarkSignRequest() {
+    TestAuthenticator authenticator;
+    initializeAuthenticator(authenticator, new O0SettingsStore(new QSettings(settingsDirectory.path() + "/signing.conf", QSettings::IniFormat), "encryption-key"));
+
+    QBENCHMARK {
+        for (const SignedRequest &signedRequest : signedRequests) {
+            authenticator.signRequest(signedRequest.oauthParameters, signedRequest.otherParameters, signedRequest.url, signedRequest.operation);
+        }
+    }
+}
+
+void TestO1::benchmarkSign() {
+    const QString consumerSecret("consumer-secret");
+    const QString tokenSecret("access-token-secret");
+
+    QBENCHMARK {
+        for (const SignedRequest &signedRequest : signedRequests) {
+            O1::sign(signedRequest.oauthParameters, signedRequest.otherParameters, signedRequest.url, signedRequest.operation, consumerSecret, tokenSecret);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestO1)
+
+#include "tst_o1.moc"
@@ -0,0 +1,7 @@
+include(../tests.pri)
+include(../../src/QGumboParser/QGumboParser.pri)
+
+TARGET = tst_qgumboarena
+
+SOURCES += \
+    tst_qgumboarena.cpp
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "QGumboParser/qgumbodocument.h"
+#include "QGumboParser/qgumbonode.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtTest>
+
+/*
+ * Parses and destroys each saved page once with the arena used by QGumboDocument
+ * and once with Gumbo's own malloc/free allocator, which frees the tree node by node.
+ */
+class TestQGumboArena : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseAndDestroyWithArena_data();
+    void parseAndDestroyWithArena();
+    void parseAndDestroyWithDefaultAllocator_data();
+    void parseAndDestroyWithDefaultAllocator();
+
+private:
+    void addFixtures();
+};
+
+void TestQGumboArena::addFixtures()
+{
+    QTest::addColumn<QByteArray>("htmlDocument");
+
+    QDir fixturesDirectory(FIXTURES_DIRECTORY);
+    const QStringList pages = fixturesDirectory.entryList(QStringList("*.html"), QDir::Files, QDir::Name);
+    QVERIFY(!pages.isEmpty());
+    for (const QString &page : pages) {
+        QFile pageFile(fixturesDirectory.filePath(page));
+        QVERIFY(pageFile.open(QIODevice::ReadOnly));
+        QTest::newRow(qPrintable(page)) << pageFile.readAll();
+    }
+}
+
+void TestQGumboArena::parseAndDestroyWithArena_data()
+{
+    addFixtures();
+}
+
+void TestQGumboArena::parseAndDestroyWithArena()
+{
+    QFETCH(QByteArray, htmlDocument);
+
+    QBENCHMARK {
+        QGumboDocument document = QGumboDocument::parse(htmlDocument);
+        QVERIFY(document.rootNode().childElementCount() > 0);
+    }
+}
+
+void TestQGumboArena::parseAndDestroyWithDefaultAllocator_data()
+{
+    addFixtures();
+}
+
+void TestQGumboArena::parseAndDestroyWithDefaultAllocator()
+{
+    QFETCH(QByteArray, htmlDocument);
+
+    QBENCHMARK {
+        GumboOutput *output = gumbo_parse_with_options(&kGumboDefaultOptions, htmlDocument.constData(), static_cast<size_t>(htmlDocument.length()));
+        QVERIFY(output);
+        QVERIFY(output->root->v.element.children.length > 0);
+        gumbo_destroy_output(&kGumboDefaultOptions, output);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestQGumboArena)
+
+#include "tst_qgumboarena.moc"
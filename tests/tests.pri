@@ -0,0 +1,11 @@
+QT += testlib
+QT -= gui
+
+CONFIG += c++11 testcase console
+CONFIG -= app_bundle
+
+APP_SOURCES = $$PWD/../src
+INCLUDEPATH += $$APP_SOURCES
+
+# Saved pages and other test data
+DEFINES += FIXTURES_DIRECTORY=\\\"$$PWD/fixtures\\\"
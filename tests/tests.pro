@@ -0,0 +1,13 @@
+# Unit tests and benchmarks, built separately from the application:
+#   qmake tests/tests.pro && make && make check
+# Benchmarks accept the usual QtTest options, e.g. -callgrind or -iterations 100
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    contentextractor \
+    keywordmatcher \
+    mutefilter \
+    o1 \
+    qgumboarena \
+    tweettextrenderer
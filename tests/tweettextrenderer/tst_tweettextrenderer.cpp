@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2017-19 Sebastian J. Wolf
+
+    This file is part of Piepmatz.
+
+    Piepmatz is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Piepmatz is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Piepmatz. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "tweettextrenderer.h"
+
+#include <QFile>
+#include <QJSEngine>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QtTest>
+
+/*
+ * Renders a page of 200 tweets with TweetTextRenderer and with enhanceText() of functions.js,
+ * which the delegates ran for every tweet before. Emoji are replaced when the text is shown
+ * in both cases and are not part of the measurement.
+ */
+class TestTweetTextRenderer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void renderSameAsJavaScript();
+    void benchmarkTweetTextRenderer();
+    void benchmarkJavaScript();
+
+private:
+    QVariantList tweets;
+    QJSEngine engine;
+    QJSValue renderPage;
+
+    QString readFile(const QString &fileName);
+};
+
+QString TestTweetTextRenderer::readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+void TestTweetTextRenderer::initTestCase()
+{
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    tweets = QJsonDocument::fromJson(readFile(FIXTURES_DIRECTORY "/home-timeline.json").toUtf8()).toVariant().toList();
+    QCOMPARE(tweets.size(), 200);
+
+    engine.installExtensions(QJSEngine::TranslationExtension | QJSEngine::ConsoleExtension);
+    // What functions.js expects from the QML context, link previews and embedded tweets are not retrieved here
+    QJSValue result = engine.evaluate("var appWindow = { linkPreviewMode: 'never', isWifi: false };"
+                                      "var twitterApi = { showStatus: function() {}, getOpenGraph: function() {} };"
+                                      "var embeddedTweetId; var referenceUrl;");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+
+    // twitter-text.js is imported as TwitterText, its functions are collected in the object index
+    const QString twitterText = readFile(QML_JS_DIRECTORY "/twitter-text.js");
+    QVERIFY(!twitterText.isEmpty());
+    result = engine.evaluate("var TwitterText = (function() {\n" + twitterText + "\nreturn index;\n})();", "twitter-text.js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+
+    const QString functions = readFile(QML_JS_DIRECTORY "/functions.js");
+    QVERIFY(!functions.isEmpty());
+    result = engine.evaluate(functions, "functions.js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+
+    // Same as TweetText.qml did for every delegate
+    renderPage = engine.evaluate("(function(tweets) {"
+                                 "    var renderedTexts = [];"
+                                 "    for (var i = 0; i < tweets.length; i++) {"
+                                 "        var relevantTweet = getRelevantTweet(tweets[i]);"
+                                 "        renderedTexts.push(enhanceText(relevantTweet.full_text, relevantTweet.entities, relevantTweet.extended_entities));"
+                                 "    }"
+                                 "    return renderedTexts;"
+                                 "})");
+    QVERIFY2(renderPage.isCallable(), qPrintable(renderPage.toString()));
+}
+
+void TestTweetTextRenderer::renderSameAsJavaScript()
+{
+    QVariantList renderedTweets = tweets;
+    TweetTextRenderer::renderTweets(renderedTweets);
+    QJSValue javaScriptTexts = renderPage.call(QJSValueList() << engine.toScriptValue(tweets));
+    QVERIFY2(!javaScriptTexts.isError(), qPrintable(javaScriptTexts.toString()));
+
+    for (int i = 0; i < renderedTweets.size(); i++) {
+        QVariantMap tweet = renderedTweets.at(i).toMap();
+        QVariantMap relevantTweet = tweet.contains("retweeted_status") ? tweet.value("retweeted_status").toMap() : tweet;
+        QCOMPARE(relevantTweet.value("rendered_text").toString(), javaScriptTexts.property(i).toString());
+    }
+}
+
+void TestTweetTextRenderer::benchmarkTweetTextRenderer()
+{
+    QBENCHMARK {
+        QVariantList renderedTweets = tweets;
+        TweetTextRenderer::renderTweets(renderedTweets);
+    }
+}
+
+void TestTweetTextRenderer::benchmarkJavaScript()
+{
+    // Includes handing the tweets to JavaScript, the delegates got them from the models the same way
+    QBENCHMARK {
+        QJSValue javaScriptTexts = renderPage.call(QJSValueList() << engine.toScriptValue(tweets));
+        QVERIFY(!javaScriptTexts.isError());
+    }
+}
+
+QTEST_GUILESS_MAIN(TestTweetTextRenderer)
+
+#include "tst_tweettextrenderer.moc"
@@ -0,0 +1,15 @@
+include(../tests.pri)
+
+QT += qml
+
+TARGET = tst_tweettextrenderer
+
+# The JavaScript rendering of the tweet delegates, for comparison
+DEFINES += QML_JS_DIRECTORY=\\\"$$PWD/../../qml/js\\\"
+
+SOURCES += \
+    tst_tweettextrenderer.cpp \
+    $$APP_SOURCES/tweettextrenderer.cpp
+
+HEADERS += \
+    $$APP_SOURCES/tweettextrenderer.h
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Generates the lookup table of EmojiMatcher from the file names of the bundled emoji images.
+# Usage: generate-emoji-table.sh <output header> <emoji directory>
+
+OUTPUT_FILE="$1"
+EMOJI_DIRECTORY="$2"
+
+{
+    echo "// Generated by generate-emoji-table.sh from qml/js/emoji, do not edit."
+    echo "#ifndef EMOJITABLE_H"
+    echo "#define EMOJITABLE_H"
+    echo ""
+    echo "// The code point sequences of all emoji images, each one terminated by 0"
+    echo "const unsigned int EMOJI_SEQUENCES[] = {"
+    ls "$EMOJI_DIRECTORY" | sed -n 's/\.svg$//p' | sort | sed 's/-/, 0x/g; s/^/    0x/; s/$/, 0,/'
+    echo "};"
+    echo ""
+    echo "#endif // EMOJITABLE_H"
+} > "$OUTPUT_FILE"